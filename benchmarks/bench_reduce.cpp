@@ -0,0 +1,91 @@
+// Reduction throughput and accuracy: qtty::batch::sum against std::accumulate.
+//
+// Usage: bench_reduce [n] [repeats]
+
+#include <qtty/qtty.hpp>
+#include <qtty/reduce.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace qtty;
+
+namespace {
+
+template<typename Fn>
+double best_ms(int repeats, Fn&& fn) {
+    double best = 1e300;
+    for (int r = 0; r < repeats; ++r) {
+        const auto t0 = std::chrono::steady_clock::now();
+        fn();
+        const auto t1 = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(t1 - t0).count());
+    }
+    return best;
+}
+
+void report(const char* name, double ms, double result, long double ref, std::size_t n) {
+    const double gbs = static_cast<double>(n * sizeof(double)) / (ms * 1e6);
+    std::printf("%-26s %10.3f ms %8.2f GB/s   |err| = %.3e\n", name, ms, gbs,
+                static_cast<double>(std::fabs(result - ref)));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    const int repeats = argc > 2 ? std::atoi(argv[2]) : 10;
+
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> mant(1.0, 2.0);
+    std::uniform_int_distribution<int> expo(-30, 30);
+    std::vector<Meter> values(n);
+    std::vector<double> raw(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const double x = std::ldexp(mant(rng), expo(rng));
+        raw[i] = i % 2 == 0 ? x : -x;
+        values[i] = Meter(raw[i]);
+    }
+    long double ref = 0.0L;
+    for (double x : raw) {
+        ref += x;
+    }
+
+    std::printf("n = %zu, best of %d\n", n, repeats);
+
+    volatile double sink = 0.0;
+    double result = 0.0;
+    double ms = best_ms(repeats, [&] { result = std::accumulate(raw.begin(), raw.end(), 0.0); });
+    sink = result;
+    report("std::accumulate", ms, result, ref, n);
+
+    struct Case {
+        const char* name;
+        SumMethod method;
+        unsigned threads;
+    };
+    const Case cases[] = {
+        {"naive (1 thread)", SumMethod::Naive, 1},
+        {"neumaier (1 thread)", SumMethod::Neumaier, 1},
+        {"pairwise (1 thread)", SumMethod::Pairwise, 1},
+        {"reproducible (1 thread)", SumMethod::Reproducible, 1},
+        {"naive (all threads)", SumMethod::Naive, 0},
+        {"neumaier (all threads)", SumMethod::Neumaier, 0},
+        {"reproducible (all threads)", SumMethod::Reproducible, 0},
+    };
+    for (const Case& c : cases) {
+        ReduceOptions opts;
+        opts.method = c.method;
+        opts.threads = c.threads;
+        ms = best_ms(repeats, [&] { result = batch::sum(values.data(), n, opts).value(); });
+        sink = result;
+        report(c.name, ms, result, ref, n);
+    }
+    (void)sink;
+    return 0;
+}
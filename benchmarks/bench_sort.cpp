@@ -0,0 +1,59 @@
+// Sorting throughput: qtty::radix_sort / parallel_radix_sort against
+// std::sort on Quantity::operator<.
+//
+// Usage: bench_sort [n] [repeats]
+
+#include <qtty/qtty.hpp>
+#include <qtty/sort.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace qtty;
+
+namespace {
+
+template<typename Fn>
+double best_ms(int repeats, const std::vector<Meter>& input, Fn&& fn) {
+    double best = 1e300;
+    for (int r = 0; r < repeats; ++r) {
+        std::vector<Meter> v = input;
+        const auto t0 = std::chrono::steady_clock::now();
+        fn(v);
+        const auto t1 = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(t1 - t0).count());
+        if (!std::is_sorted(v.begin(), v.end())) {
+            std::printf("not sorted!\n");
+            std::exit(1);
+        }
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    const int repeats = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    std::mt19937_64 rng(42);
+    std::lognormal_distribution<double> d(3.0, 2.0);
+    std::vector<Meter> input(n);
+    for (auto& x : input) {
+        x = Meter(d(rng));
+    }
+
+    std::printf("n = %zu, best of %d\n", n, repeats);
+    std::printf("%-26s %10.3f ms\n", "std::sort",
+                best_ms(repeats, input, [](std::vector<Meter>& v) { std::sort(v.begin(), v.end()); }));
+    std::printf("%-26s %10.3f ms\n", "radix_sort",
+                best_ms(repeats, input, [](std::vector<Meter>& v) { radix_sort(v.data(), v.size()); }));
+    std::printf("%-26s %10.3f ms\n", "parallel_radix_sort",
+                best_ms(repeats, input,
+                        [](std::vector<Meter>& v) { parallel_radix_sort(v.data(), v.size()); }));
+    return 0;
+}
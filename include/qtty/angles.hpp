@@ -0,0 +1,383 @@
+#pragma once
+
+/**
+ * @file angles.hpp
+ * @brief Angle normalization and trigonometry on typed angular quantities
+ *
+ * Works with any angular unit from units/angular.hpp (Radian, Degree,
+ * HourAngle, Arcsecond, ...):
+ * - wrap_positive: reduce to [0, full turn) in the input unit
+ * - wrap_signed:   reduce to (-half turn, half turn] in the input unit
+ * - sincos/sin/cos: argument reduction by quarter turns in the *input* unit,
+ *   so results are exact at multiples of 90 degrees (sin(180 deg) == 0);
+ *   radian-based units are reduced by pi/2 after an exact conversion
+ * - atan2: takes two quantities of the same unit and returns a Radian
+ *
+ * Every function has an array version in qtty::batch. Both accept an
+ * Accuracy argument:
+ *
+ * | Mode               | sin/cos       | atan2          | wrap                 |
+ * |--------------------|---------------|----------------|----------------------|
+ * | Accuracy::Precise  | <= 2 ulp      | <= 1 ulp       | exact (fmod)         |
+ * | Accuracy::Fast     | <= 4 ulp      | <= 4 ulp       | <= 1 ulp of turn     |
+ *
+ * Precise mode calls libm per element. Fast mode evaluates minimax
+ * polynomials (Cephes coefficients) in branch-free loops that vectorize;
+ * it does not distinguish signed zeros in atan2, and sin/cos bounds hold for
+ * arguments up to 2^20 turns. The ulp bounds are relative to the correctly
+ * rounded result for the exact input angle and are checked in
+ * tests/test_angles.cpp.
+ *
+ * Usage example:
+ * @code
+ * auto sc = sincos(Degree(90.0));          // {1.0, 0.0} exactly
+ * Degree w = wrap_signed(Degree(270.0));   // -90 deg
+ * Radian a = atan2(Meter(1.0), Meter(1.0));
+ *
+ * batch::wrap_positive(ra.data(), ra.data(), n, Accuracy::Fast);
+ * batch::sincos(dec.data(), s.data(), c.data(), n, Accuracy::Fast);
+ * @endcode
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+#include "ffi_core.hpp"
+#include "units/angular.hpp"
+#include "detail/factors.hpp"
+#include "detail/simd.hpp"
+
+namespace qtty {
+
+// Selects between libm-backed kernels and vectorizable approximations.
+enum class Accuracy {
+    Precise,
+    Fast
+};
+
+struct SinCos {
+    double sin;
+    double cos;
+};
+
+namespace detail {
+
+// ============================================================================
+// Raw Kernels
+// ============================================================================
+// Operate on plain doubles so that other kernels (separations, frame
+// rotations) can reuse them on staged buffers.
+
+// Round to nearest integer with SSE2-only arithmetic (valid for |t| < 2^51;
+// larger values are already integral).
+inline double round_nearest_fast(double t) {
+    const double magic = 6755399441055744.0;  // 1.5 * 2^52
+    const double r = (t + magic) - magic;
+    return std::fabs(t) < 2251799813685248.0 ? r : t;
+}
+
+// sin(x), cos(x) for |x| <= pi/4 (Cephes sin.c minimax coefficients)
+inline void sincos_poly(double x, double& s, double& c) {
+    const double z = x * x;
+    const double ps = ((((( 1.58962301576546568060E-10 * z
+                           - 2.50507477628578072866E-8) * z
+                           + 2.75573136213857245213E-6) * z
+                           - 1.98412698295895385996E-4) * z
+                           + 8.33333333332211858878E-3) * z
+                           - 1.66666666666666307295E-1);
+    const double pc = ((((( -1.13585365213876817300E-11 * z
+                           + 2.08757008419747316778E-9) * z
+                           - 2.75573141792967388112E-7) * z
+                           + 2.48015872888517045348E-5) * z
+                           - 1.38888888888730564116E-3) * z
+                           + 4.16666666666665929218E-2);
+    s = x + x * z * ps;
+    c = 1.0 - 0.5 * z + z * z * pc;
+}
+
+// atan(x) for |x| <= tan(pi/8) (Cephes atan.c rational approximation)
+inline double atan_poly(double x) {
+    const double z = x * x;
+    const double p = ((((-8.750608600031904122785E-1 * z
+                        - 1.615753718733365076637E1) * z
+                        - 7.500855792314704667340E1) * z
+                        - 1.228866684490136173410E2) * z
+                        - 6.485021904942025371773E1);
+    const double q = (((((z + 2.485846490142306297962E1) * z
+                        + 1.650270098316988542046E2) * z
+                        + 4.328810604912902668951E2) * z
+                        + 4.853903996359136964868E2) * z
+                        + 1.945506571482613964425E2);
+    return x + x * z * p / q;
+}
+
+// Splits x / per_rad into hi + lo with hi = fl(x / per_rad). lo is zero
+// when per_rad is 1. The remainder x - hi * per_rad is exact: with hardware
+// FMA it is one fused operation; otherwise Dekker's product keeps it
+// vectorizable. (Dekker's splitting must not run on FMA targets, where the
+// compiler may contract its steps and lose the error term.)
+inline void split_radians(double x, double per_rad, double& hi, double& lo) {
+    hi = x / per_rad;
+#if defined(__FMA__) || defined(FP_FAST_FMA)
+    lo = std::fma(-hi, per_rad, x) / per_rad;
+#else
+    const double splitter = 134217729.0;  // 2^27 + 1
+    const double p = hi * per_rad;
+    const double th = splitter * hi;
+    const double h1 = th - (th - hi);
+    const double h2 = hi - h1;
+    const double tc = splitter * per_rad;
+    const double c1 = tc - (tc - per_rad);
+    const double c2 = per_rad - c1;
+    const double err = ((h1 * c1 - p) + h1 * c2 + h2 * c1) + h2 * c2;
+    lo = ((x - p) - err) / per_rad;
+#endif
+    lo = std::fabs(lo) <= std::fabs(hi) ? lo : 0.0;  // overflow near DBL_MAX
+}
+
+// sin/cos of angles given in a unit with `per_turn` units per full turn.
+// When the turn is a whole number of units (degrees, arcseconds, hours, ...)
+// the quarter-turn reduction happens in that unit and is exact. Otherwise
+// (radians, milliradians) a quarter turn is not representable, so the angle
+// is converted to radians as a double-word hi + lo and reduced by pi/2 with
+// libm (Precise) or a three-part Cody-Waite constant (Fast).
+inline void sincos_kernel(const double* x, double* s, double* c, std::size_t n,
+                          double per_turn, Accuracy accuracy) {
+    if (per_turn != std::floor(per_turn)) {
+        // Snap units defined as an integer count per radian (1 for Radian,
+        // 1000 for Milliradian) so the conversion is exact.
+        double per_rad = per_turn / kTwoPi;
+        const double nearest = std::nearbyint(per_rad);
+        per_rad = std::fabs(per_rad - nearest) <= 1e-12 * per_rad ? nearest : per_rad;
+        if (accuracy == Accuracy::Precise) {
+            for (std::size_t i = 0; i < n; ++i) {
+                double hi, lo;
+                split_radians(x[i], per_rad, hi, lo);
+                const double sr = std::sin(hi);
+                const double cr = std::cos(hi);
+                s[i] = sr + lo * cr;
+                c[i] = cr - lo * sr;
+            }
+            return;
+        }
+        // Cephes DP1..DP3 scaled to pi/2; k * kPio2a is exact for k < 2^27
+        const double kPio2a = 1.57079625129699707031E0;
+        const double kPio2b = 7.54978941586159635335E-8;
+        const double kPio2c = 5.39030285815811905290E-15;
+        const double inv_pio2 = 2.0 / kPi;
+        QTTY_SIMD_LOOP
+        for (std::size_t i = 0; i < n; ++i) {
+            double hi, lo;
+            split_radians(x[i], per_rad, hi, lo);
+            const double k = round_nearest_fast(hi * inv_pio2);
+            const double r = (((hi - k * kPio2a) - k * kPio2b) - k * kPio2c) + lo;
+            const double q = k - 4.0 * std::floor(k * 0.25);
+            double sr, cr;
+            sincos_poly(r, sr, cr);
+            const bool odd = q == 1.0 || q == 3.0;
+            const double sa = odd ? cr : sr;
+            const double ca = odd ? sr : cr;
+            s[i] = q >= 2.0 ? -sa : sa;
+            c[i] = (q == 1.0 || q == 2.0) ? -ca : ca;
+        }
+        return;
+    }
+
+    const double quarter = per_turn * 0.25;
+    const double inv_quarter = 4.0 / per_turn;
+    const double to_rad = kTwoPi / per_turn;
+    if (accuracy == Accuracy::Precise) {
+        for (std::size_t i = 0; i < n; ++i) {
+            // Non-finite input: k = 0 keeps the quadrant cast defined and
+            // lets the NaN/inf reach libm through r
+            const double k = std::isfinite(x[i]) ? std::nearbyint(x[i] * inv_quarter) : 0.0;
+            const double r = std::fma(-k, quarter, x[i]) * to_rad;
+            const double q = k - 4.0 * std::floor(k * 0.25);
+            const double sr = std::sin(r);
+            const double cr = std::cos(r);
+            const int quadrant = static_cast<int>(q) & 3;
+            const double sv[4] = {sr, cr, -sr, -cr};
+            const double cv[4] = {cr, -sr, -cr, sr};
+            s[i] = sv[quadrant];
+            c[i] = cv[quadrant];
+        }
+        return;
+    }
+    QTTY_SIMD_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        const double k = round_nearest_fast(x[i] * inv_quarter);
+        const double r = (x[i] - k * quarter) * to_rad;
+        const double q = k - 4.0 * std::floor(k * 0.25);
+        double sr, cr;
+        sincos_poly(r, sr, cr);
+        const bool odd = q == 1.0 || q == 3.0;
+        const double sa = odd ? cr : sr;
+        const double ca = odd ? sr : cr;
+        s[i] = q >= 2.0 ? -sa : sa;
+        c[i] = (q == 1.0 || q == 2.0) ? -ca : ca;
+    }
+}
+
+inline void atan2_kernel(const double* y, const double* x, double* out, std::size_t n,
+                         Accuracy accuracy) {
+    if (accuracy == Accuracy::Precise) {
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = std::atan2(y[i], x[i]);
+        }
+        return;
+    }
+    const double tan_pi_8 = 0.41421356237309504880;
+    constexpr double kInf = std::numeric_limits<double>::infinity();
+    QTTY_SIMD_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        const double ax = std::fabs(x[i]);
+        const double ay = std::fabs(y[i]);
+        const bool swap = ay > ax;
+        const double num = swap ? ax : ay;
+        const double den = swap ? ay : ax;
+        // Both infinite: the ratio is taken as 1, as in std::atan2
+        const bool both_inf = ax == kInf && ay == kInf;
+        const double t = both_inf ? 1.0 : den > 0.0 ? num / den : 0.0;
+        // Second reduction: atan(t) = pi/4 + atan((t - 1) / (t + 1))
+        const bool upper = t > tan_pi_8;
+        const double u = upper ? (t - 1.0) / (t + 1.0) : t;
+        double r = atan_poly(u) + (upper ? 0.25 * kPi : 0.0);
+        r = swap ? 0.5 * kPi - r : r;
+        r = x[i] < 0.0 ? kPi - r : r;
+        r = y[i] < 0.0 ? -r : r;
+        out[i] = x[i] != x[i] || y[i] != y[i] ? x[i] + y[i] : r;  // NaN propagates
+    }
+}
+
+// Reduce to [0, per_turn)
+inline void wrap_positive_kernel(const double* x, double* out, std::size_t n,
+                                 double per_turn, Accuracy accuracy) {
+    if (accuracy == Accuracy::Precise) {
+        for (std::size_t i = 0; i < n; ++i) {
+            double r = std::fmod(x[i], per_turn);
+            r = r < 0.0 ? r + per_turn : r;
+            out[i] = r >= per_turn ? 0.0 : r;
+        }
+        return;
+    }
+    const double inv = 1.0 / per_turn;
+    QTTY_SIMD_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        double r = x[i] - per_turn * std::floor(x[i] * inv);
+        r = r < 0.0 ? r + per_turn : r;
+        out[i] = r >= per_turn ? r - per_turn : r;
+    }
+}
+
+// Reduce to (-per_turn / 2, per_turn / 2]
+inline void wrap_signed_kernel(const double* x, double* out, std::size_t n,
+                               double per_turn, Accuracy accuracy) {
+    const double half = 0.5 * per_turn;
+    if (accuracy == Accuracy::Precise) {
+        for (std::size_t i = 0; i < n; ++i) {
+            const double r = std::remainder(x[i], per_turn);
+            out[i] = r == -half ? half : r;
+        }
+        return;
+    }
+    const double inv = 1.0 / per_turn;
+    QTTY_SIMD_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        double r = x[i] - per_turn * std::ceil(x[i] * inv - 0.5);
+        r = r <= -half ? r + per_turn : r;
+        out[i] = r > half ? r - per_turn : r;
+    }
+}
+
+} // namespace detail
+
+// ============================================================================
+// Scalar Functions
+// ============================================================================
+
+template<typename AngleTag>
+Quantity<AngleTag> wrap_positive(const Quantity<AngleTag>& a,
+                                 Accuracy accuracy = Accuracy::Precise) {
+    double r;
+    const double v = a.value();
+    detail::wrap_positive_kernel(&v, &r, 1, detail::units_per_turn<AngleTag>(), accuracy);
+    return Quantity<AngleTag>(r);
+}
+
+template<typename AngleTag>
+Quantity<AngleTag> wrap_signed(const Quantity<AngleTag>& a,
+                               Accuracy accuracy = Accuracy::Precise) {
+    double r;
+    const double v = a.value();
+    detail::wrap_signed_kernel(&v, &r, 1, detail::units_per_turn<AngleTag>(), accuracy);
+    return Quantity<AngleTag>(r);
+}
+
+template<typename AngleTag>
+SinCos sincos(const Quantity<AngleTag>& a, Accuracy accuracy = Accuracy::Precise) {
+    SinCos sc;
+    const double v = a.value();
+    detail::sincos_kernel(&v, &sc.sin, &sc.cos, 1, detail::units_per_turn<AngleTag>(),
+                          accuracy);
+    return sc;
+}
+
+template<typename AngleTag>
+double sin(const Quantity<AngleTag>& a, Accuracy accuracy = Accuracy::Precise) {
+    return sincos(a, accuracy).sin;
+}
+
+template<typename AngleTag>
+double cos(const Quantity<AngleTag>& a, Accuracy accuracy = Accuracy::Precise) {
+    return sincos(a, accuracy).cos;
+}
+
+// Angle of the point (x, y); both coordinates must share a unit
+template<typename UnitTag>
+Radian atan2(const Quantity<UnitTag>& y, const Quantity<UnitTag>& x,
+             Accuracy accuracy = Accuracy::Precise) {
+    double r;
+    const double yv = y.value();
+    const double xv = x.value();
+    detail::atan2_kernel(&yv, &xv, &r, 1, accuracy);
+    return Radian(r);
+}
+
+// ============================================================================
+// Batch Variants
+// ============================================================================
+// Arrays of n elements; outputs may alias inputs of the same type.
+
+namespace batch {
+
+template<typename AngleTag>
+void wrap_positive(const Quantity<AngleTag>* in, Quantity<AngleTag>* out, std::size_t n,
+                   Accuracy accuracy = Accuracy::Precise) {
+    detail::wrap_positive_kernel(detail::raw(in), detail::raw(out), n,
+                                 detail::units_per_turn<AngleTag>(), accuracy);
+}
+
+template<typename AngleTag>
+void wrap_signed(const Quantity<AngleTag>* in, Quantity<AngleTag>* out, std::size_t n,
+                 Accuracy accuracy = Accuracy::Precise) {
+    detail::wrap_signed_kernel(detail::raw(in), detail::raw(out), n,
+                               detail::units_per_turn<AngleTag>(), accuracy);
+}
+
+template<typename AngleTag>
+void sincos(const Quantity<AngleTag>* in, double* sin_out, double* cos_out, std::size_t n,
+            Accuracy accuracy = Accuracy::Precise) {
+    detail::sincos_kernel(detail::raw(in), sin_out, cos_out, n,
+                          detail::units_per_turn<AngleTag>(), accuracy);
+}
+
+template<typename UnitTag>
+void atan2(const Quantity<UnitTag>* y, const Quantity<UnitTag>* x, Radian* out, std::size_t n,
+           Accuracy accuracy = Accuracy::Precise) {
+    detail::atan2_kernel(detail::raw(y), detail::raw(x), detail::raw(out), n, accuracy);
+}
+
+} // namespace batch
+
+} // namespace qtty
@@ -0,0 +1,448 @@
+#pragma once
+
+/**
+ * @file cbor.hpp
+ * @brief CBOR (RFC 8949) encoding of quantities and quantity arrays
+ *
+ * The binary counterpart of serialization.hpp, with the same layout:
+ *
+ *     to_cbor_value(q)        float64                        (like to_json_value)
+ *     to_cbor(q)              {"value": float64, "unit_id": uint}   (like to_json)
+ *     to_cbor_array(p, n)     {"unit_id": uint, "values": 86(bytes)}
+ *
+ * Arrays use the RFC 8746 typed-array tag 86 (float64, little-endian). The
+ * values are one byte string, so writing and reading them is a block copy
+ * on little-endian hosts, and the encoding is 8 bytes per value plus about
+ * 20 bytes per array. The unit comes first so a decoder knows the
+ * conversion factor before it reaches the values.
+ *
+ * The decoders mirror from_json_value / from_json:
+ * - from_cbor_value<Unit>() reads a number already in Unit.
+ * - from_cbor<Unit>() / from_cbor_array<Unit>() read the unit_id and
+ *   convert to Unit. One factor is used per array, applied while the values
+ *   are decoded when "unit_id" precedes them (or in a second pass over the
+ *   result when it follows them).
+ * Decoders accept any definite-length encoding another CBOR library may
+ * produce:
+ * - keys in any order, and unknown keys are skipped (repeated keys throw);
+ * - half, single or double floats, and integers;
+ * - tag 86, tag 82 (float64, big-endian) or a plain array of numbers for
+ *   "values".
+ * Malformed or truncated input throws std::invalid_argument. Indefinite
+ * lengths are rejected. Unknown units and dimension mismatches throw the
+ * usual InvalidUnitError / IncompatibleDimensionsError.
+ *
+ * Usage example:
+ * @code
+ * std::vector<std::uint8_t> one = serialization::to_cbor(Meter(42.0));
+ * Kilometer km = serialization::from_cbor<Kilometer>(one.data(), one.size());
+ *
+ * std::vector<std::uint8_t> blob = serialization::to_cbor_array(d.data(), d.size());
+ * std::vector<Kilometer> all = serialization::from_cbor_array<Kilometer>(blob.data(), blob.size());
+ * @endcode
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ffi_core.hpp"
+#include "detail/bytes.hpp"
+#include "detail/factors.hpp"
+#include "detail/simd.hpp"
+
+namespace qtty {
+
+namespace detail {
+
+// Major types (high 3 bits of the initial byte)
+inline constexpr std::uint8_t kCborUint = 0;
+inline constexpr std::uint8_t kCborNegInt = 1;
+inline constexpr std::uint8_t kCborBytes = 2;
+inline constexpr std::uint8_t kCborText = 3;
+inline constexpr std::uint8_t kCborArray = 4;
+inline constexpr std::uint8_t kCborMap = 5;
+inline constexpr std::uint8_t kCborTag = 6;
+inline constexpr std::uint8_t kCborSimple = 7;
+
+// RFC 8746 typed arrays
+inline constexpr std::uint64_t kCborTagF64BE = 82;
+inline constexpr std::uint64_t kCborTagF64LE = 86;
+
+inline constexpr int kCborMaxDepth = 16;
+
+// Initial byte plus the shortest big-endian argument
+inline void cbor_head(std::vector<std::uint8_t>& out, std::uint8_t major, std::uint64_t arg) {
+    const std::uint8_t m = static_cast<std::uint8_t>(major << 5);
+    int bytes;
+    if (arg < 24) {
+        out.push_back(static_cast<std::uint8_t>(m | arg));
+        return;
+    } else if (arg <= 0xFF) {
+        out.push_back(m | 24);
+        bytes = 1;
+    } else if (arg <= 0xFFFF) {
+        out.push_back(m | 25);
+        bytes = 2;
+    } else if (arg <= 0xFFFFFFFFu) {
+        out.push_back(m | 26);
+        bytes = 4;
+    } else {
+        out.push_back(m | 27);
+        bytes = 8;
+    }
+    for (int i = bytes - 1; i >= 0; --i) {
+        out.push_back(static_cast<std::uint8_t>(arg >> (8 * i)));
+    }
+}
+
+inline void cbor_text(std::vector<std::uint8_t>& out, std::string_view s) {
+    cbor_head(out, kCborText, s.size());
+    out.insert(out.end(), s.begin(), s.end());
+}
+
+inline void cbor_f64(std::vector<std::uint8_t>& out, double v) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &v, sizeof bits);
+    out.push_back(static_cast<std::uint8_t>((kCborSimple << 5) | 27));
+    for (int i = 7; i >= 0; --i) {
+        out.push_back(static_cast<std::uint8_t>(bits >> (8 * i)));
+    }
+}
+
+inline double half_to_double(std::uint16_t h) {
+    const int exp = (h >> 10) & 0x1F;
+    const double mant = h & 0x3FF;
+    double v;
+    if (exp == 0) {
+        v = std::ldexp(mant, -24);
+    } else if (exp != 31) {
+        v = std::ldexp(mant + 1024, exp - 25);
+    } else {
+        v = mant == 0 ? std::numeric_limits<double>::infinity() : std::numeric_limits<double>::quiet_NaN();
+    }
+    return (h & 0x8000) ? -v : v;
+}
+
+// Pull parser over one CBOR data item
+class CborReader {
+public:
+    CborReader(const std::uint8_t* data, std::size_t size) : in_(data, size) {}
+
+    struct Head {
+        std::uint8_t major;
+        std::uint8_t info;  // low 5 bits of the initial byte
+        std::uint64_t arg;
+    };
+
+    Head head() {
+        const std::uint8_t b = in_.u8();
+        Head h{static_cast<std::uint8_t>(b >> 5), static_cast<std::uint8_t>(b & 0x1F), 0};
+        if (h.info < 24) {
+            h.arg = h.info;
+        } else if (h.info <= 27) {
+            const int bytes = 1 << (h.info - 24);
+            const std::uint8_t* p = in_.bytes(static_cast<std::size_t>(bytes));
+            for (int i = 0; i < bytes; ++i) {
+                h.arg = (h.arg << 8) | p[i];
+            }
+        } else if (h.info == 31) {
+            throw std::invalid_argument("Indefinite-length CBOR items are not supported");
+        } else {
+            throw std::invalid_argument("Malformed CBOR");
+        }
+        return h;
+    }
+
+    // Any CBOR number (integer or float) as a double
+    double number() {
+        return number(head());
+    }
+
+    double number(const Head& h) {
+        switch (h.major) {
+            case kCborUint:
+                return static_cast<double>(h.arg);
+            case kCborNegInt:
+                return -1.0 - static_cast<double>(h.arg);
+            case kCborSimple:
+                if (h.info == 25) {
+                    return half_to_double(static_cast<std::uint16_t>(h.arg));
+                }
+                if (h.info == 26) {
+                    const std::uint32_t bits = static_cast<std::uint32_t>(h.arg);
+                    float f;
+                    std::memcpy(&f, &bits, sizeof f);
+                    return f;
+                }
+                if (h.info == 27) {
+                    double d;
+                    std::memcpy(&d, &h.arg, sizeof d);
+                    return d;
+                }
+                break;
+            default:
+                break;
+        }
+        throw std::invalid_argument("Expected a CBOR number");
+    }
+
+    std::uint64_t uint() {
+        const Head h = head();
+        if (h.major != kCborUint) {
+            throw std::invalid_argument("Expected a CBOR unsigned integer");
+        }
+        return h.arg;
+    }
+
+    std::string_view text(const Head& h) {
+        if (h.major != kCborText) {
+            throw std::invalid_argument("Expected a CBOR text key");
+        }
+        return std::string_view(reinterpret_cast<const char*>(bytes(h.arg)), static_cast<std::size_t>(h.arg));
+    }
+
+    const std::uint8_t* bytes(std::uint64_t n) {
+        if (n > in_.remaining()) {
+            throw std::invalid_argument("Truncated binary data");
+        }
+        return in_.bytes(static_cast<std::size_t>(n));
+    }
+
+    // Skips one complete item whose head has been read
+    void skip(const Head& h, int depth = 0) {
+        if (depth > kCborMaxDepth) {
+            throw std::invalid_argument("CBOR nesting too deep");
+        }
+        switch (h.major) {
+            case kCborBytes:
+            case kCborText:
+                bytes(h.arg);
+                break;
+            case kCborArray:
+                for (std::uint64_t i = 0; i < h.arg; ++i) {
+                    skip(head(), depth + 1);
+                }
+                break;
+            case kCborMap:
+                for (std::uint64_t i = 0; i < 2 * h.arg; ++i) {
+                    skip(head(), depth + 1);
+                }
+                break;
+            case kCborTag:
+                skip(head(), depth + 1);
+                break;
+            default:
+                break;  // integers and simple values carry no payload
+        }
+    }
+
+    std::size_t remaining() const {
+        return in_.remaining();
+    }
+
+private:
+    ByteReader in_;
+};
+
+inline void cbor_expect_end(const CborReader& r) {
+    if (r.remaining() != 0) {
+        throw std::invalid_argument("Trailing bytes after CBOR item");
+    }
+}
+
+// Reads the "values" entry (tag 86, tag 82 or array of numbers) into
+// `out`, multiplying each value by `f` as it is decoded
+template<typename UnitTag>
+void cbor_read_values(CborReader& r, std::vector<Quantity<UnitTag>>& out, double f) {
+    CborReader::Head h = r.head();
+    if (h.major == kCborTag) {
+        const std::uint64_t tag = h.arg;
+        if (tag != kCborTagF64LE && tag != kCborTagF64BE) {
+            throw std::invalid_argument("Unsupported CBOR typed-array tag");
+        }
+        h = r.head();
+        if (h.major != kCborBytes || h.arg % 8 != 0) {
+            throw std::invalid_argument("Malformed CBOR float64 typed array");
+        }
+        const std::uint8_t* p = r.bytes(h.arg);
+        const std::size_t n = static_cast<std::size_t>(h.arg / 8);
+        out.resize(n);
+        double* o = raw(out.data());
+        if (tag == kCborTagF64LE) {
+            for (std::size_t i = 0; i < n; ++i) {
+                o[i] = load_f64_le(p + 8 * i) * f;
+            }
+        } else {
+            for (std::size_t i = 0; i < n; ++i) {
+                std::uint64_t bits = 0;
+                for (int b = 0; b < 8; ++b) {
+                    bits = (bits << 8) | p[8 * i + static_cast<std::size_t>(b)];
+                }
+                double v;
+                std::memcpy(&v, &bits, sizeof v);
+                o[i] = v * f;
+            }
+        }
+        return;
+    }
+    if (h.major != kCborArray) {
+        throw std::invalid_argument("Expected a CBOR array of values");
+    }
+    if (h.arg > r.remaining()) {
+        throw std::invalid_argument("Truncated binary data");
+    }
+    out.resize(static_cast<std::size_t>(h.arg));
+    double* o = raw(out.data());
+    for (std::size_t i = 0; i < out.size(); ++i) {
+        o[i] = r.number() * f;
+    }
+}
+
+// Reads a two-field map {<value_key>: ..., "unit_id": uint}, calling
+// on_value(reader, unit) for the value entry, where unit points at the
+// unit_id if it came first and is null otherwise; returns the unit
+template<typename OnValue>
+UnitId cbor_read_map(CborReader& r, std::string_view value_key, OnValue&& on_value) {
+    const CborReader::Head m = r.head();
+    if (m.major != kCborMap) {
+        throw std::invalid_argument("Expected a CBOR map");
+    }
+    bool have_value = false;
+    bool have_unit = false;
+    UnitId unit{};
+    for (std::uint64_t i = 0; i < m.arg; ++i) {
+        const std::string_view key = r.text(r.head());
+        if ((key == value_key && have_value) || (key == "unit_id" && have_unit)) {
+            throw std::invalid_argument("Repeated \"" + std::string(key) + "\" in CBOR quantity");
+        }
+        if (key == value_key) {
+            on_value(r, have_unit ? &unit : nullptr);
+            have_value = true;
+        } else if (key == "unit_id") {
+            const std::uint64_t id = r.uint();
+            if (id > 0xFFFFFFFFu) {
+                throw std::invalid_argument("CBOR unit_id out of range");
+            }
+            unit = static_cast<UnitId>(id);
+            have_unit = true;
+        } else {
+            r.skip(r.head());
+        }
+    }
+    if (!have_value || !have_unit) {
+        throw std::invalid_argument("CBOR quantity needs \"" + std::string(value_key) + "\" and \"unit_id\"");
+    }
+    return unit;
+}
+
+} // namespace detail
+
+namespace serialization {
+
+// ============================================================================
+// Encoding
+// ============================================================================
+
+template<typename UnitTag>
+std::vector<std::uint8_t> to_cbor_value(const Quantity<UnitTag>& q) {
+    std::vector<std::uint8_t> out;
+    detail::cbor_f64(out, q.value());
+    return out;
+}
+
+template<typename UnitTag>
+std::vector<std::uint8_t> to_cbor(const Quantity<UnitTag>& q) {
+    std::vector<std::uint8_t> out;
+    detail::cbor_head(out, detail::kCborMap, 2);
+    detail::cbor_text(out, "value");
+    detail::cbor_f64(out, q.value());
+    detail::cbor_text(out, "unit_id");
+    detail::cbor_head(out, detail::kCborUint, static_cast<std::uint32_t>(UnitTraits<UnitTag>::unit_id()));
+    return out;
+}
+
+template<typename UnitTag>
+std::vector<std::uint8_t> to_cbor_array(const Quantity<UnitTag>* values, std::size_t n) {
+    std::vector<std::uint8_t> out;
+    out.reserve(32 + 8 * n);
+    detail::cbor_head(out, detail::kCborMap, 2);
+    detail::cbor_text(out, "unit_id");
+    detail::cbor_head(out, detail::kCborUint, static_cast<std::uint32_t>(UnitTraits<UnitTag>::unit_id()));
+    detail::cbor_text(out, "values");
+    detail::cbor_head(out, detail::kCborTag, detail::kCborTagF64LE);
+    detail::cbor_head(out, detail::kCborBytes, 8 * static_cast<std::uint64_t>(n));
+    const std::size_t at = out.size();
+    out.resize(at + 8 * n);
+    const double* v = detail::raw(values);
+    for (std::size_t i = 0; i < n; ++i) {
+        detail::store_f64_le(out.data() + at + 8 * i, v[i]);
+    }
+    return out;
+}
+
+// ============================================================================
+// Decoding
+// ============================================================================
+
+// A bare CBOR number, taken to be in T's unit
+template<typename T>
+Quantity<typename ExtractTag<T>::type> from_cbor_value(const std::uint8_t* data, std::size_t size) {
+    detail::CborReader r(data, size);
+    const double v = r.number();
+    detail::cbor_expect_end(r);
+    return Quantity<typename ExtractTag<T>::type>(v);
+}
+
+// {"value", "unit_id"}, converted to T
+template<typename T>
+Quantity<typename ExtractTag<T>::type> from_cbor(const std::uint8_t* data, std::size_t size) {
+    using UnitTag = typename ExtractTag<T>::type;
+    detail::CborReader r(data, size);
+    double v = 0.0;
+    const UnitId unit = detail::cbor_read_map(r, "value", [&](detail::CborReader& in, const UnitId*) { v = in.number(); });
+    detail::cbor_expect_end(r);
+    return Quantity<UnitTag>(v * detail::runtime_conversion_factor(unit, UnitTraits<UnitTag>::unit_id()));
+}
+
+// {"values", "unit_id"}, converted to T with one factor
+template<typename T>
+std::vector<Quantity<typename ExtractTag<T>::type>> from_cbor_array(const std::uint8_t* data,
+                                                                    std::size_t size) {
+    using UnitTag = typename ExtractTag<T>::type;
+    const UnitId target = UnitTraits<UnitTag>::unit_id();
+    detail::CborReader r(data, size);
+    std::vector<Quantity<UnitTag>> out;
+    bool converted = false;
+    const UnitId unit = detail::cbor_read_map(r, "values", [&](detail::CborReader& in, const UnitId* known) {
+        // With the unit already known, convert while decoding
+        const double f = known ? detail::runtime_conversion_factor(*known, target) : 1.0;
+        detail::cbor_read_values(in, out, f);
+        converted = known != nullptr;
+    });
+    detail::cbor_expect_end(r);
+    if (converted) {
+        return out;
+    }
+
+    // "unit_id" followed the values: convert in place
+    const double f = detail::runtime_conversion_factor(unit, target);
+    if (f != 1.0) {
+        const std::size_t n = out.size();
+        double* o = detail::raw(out.data());
+        QTTY_SIMD_LOOP
+        for (std::size_t i = 0; i < n; ++i) {
+            o[i] *= f;
+        }
+    }
+    return out;
+}
+
+} // namespace serialization
+} // namespace qtty
@@ -0,0 +1,83 @@
+#pragma once
+
+/**
+ * @file convert.hpp
+ * @brief Bulk unit conversion of quantity arrays
+ *
+ * Quantity::to<>() makes two FFI calls per value. Every unit exposed by
+ * qtty-ffi is a pure scale of its dimension's base unit, so converting an
+ * array only needs the factor once (conversion_factor, cached per unit
+ * pair). After that it is a single vectorized multiply.
+ *
+ * batch::convert_fanout() writes one source array into several target
+ * units in a single pass. The input is walked in cache-sized blocks and
+ * each block is scaled into every output while it is still in L1, so the
+ * source is read from memory once instead of once per target. The target
+ * set is a template parameter pack: the dimension check is a static_assert
+ * and the factors are resolved once per call.
+ *
+ * Usage example:
+ * @code
+ * std::vector<Meter> m(n);
+ * std::vector<Kilometer> km(n);
+ * batch::convert(m.data(), km.data(), n);
+ *
+ * std::vector<Mile> mi(n);
+ * std::vector<NauticalMile> nmi(n);
+ * batch::convert_fanout(m.data(), n, km.data(), mi.data(), nmi.data());
+ * @endcode
+ */
+
+#include <algorithm>
+#include <cstddef>
+
+#include "ffi_core.hpp"
+#include "detail/factors.hpp"
+#include "detail/simd.hpp"
+
+namespace qtty {
+
+namespace detail {
+
+inline void scale_kernel(const double* in, double* out, std::size_t n, double factor) {
+    QTTY_SIMD_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = in[i] * factor;
+    }
+}
+
+// 2048 doubles = 16 KiB: fits L1 alongside the output write streams
+inline constexpr std::size_t kFanoutBlock = 2048;
+
+} // namespace detail
+
+namespace batch {
+
+// out[i] = in[i].to<TargetTag>(); `out` may alias `in`
+template<typename SourceTag, typename TargetTag>
+void convert(const Quantity<SourceTag>* in, Quantity<TargetTag>* out, std::size_t n) {
+    detail::scale_kernel(detail::raw(in), detail::raw(out), n,
+                         conversion_factor<SourceTag, TargetTag>());
+}
+
+// outs[k][i] = in[i] converted to the k-th output's unit, reading `in`
+// once. Outputs must not alias `in` or each other.
+template<typename SourceTag, typename... TargetTags>
+void convert_fanout(const Quantity<SourceTag>* in, std::size_t n, Quantity<TargetTags>*... outs) {
+    static_assert(sizeof...(TargetTags) > 0, "convert_fanout needs at least one output");
+    static_assert(((detail::dimension_code<SourceTag>() == detail::dimension_code<TargetTags>()) && ...),
+                  "convert_fanout targets must share the source dimension");
+    const double factors[] = {conversion_factor<SourceTag, TargetTags>()...};
+    double* targets[] = {detail::raw(outs)...};
+    const double* x = detail::raw(in);
+    for (std::size_t base = 0; base < n; base += detail::kFanoutBlock) {
+        const std::size_t m = std::min(detail::kFanoutBlock, n - base);
+        for (std::size_t k = 0; k < sizeof...(TargetTags); ++k) {
+            detail::scale_kernel(x + base, targets[k] + base, m, factors[k]);
+        }
+    }
+}
+
+} // namespace batch
+
+} // namespace qtty
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+// ============================================================================
+// Little-Endian Byte Encoding
+// ============================================================================
+// Binary formats in qtty (sketches, histograms, wire frames) are defined as
+// little-endian regardless of the host. Values are written and read byte by
+// byte, so the helpers are alignment-agnostic and endian-independent; on
+// little-endian hosts the compiler folds them into plain loads and stores.
+
+namespace qtty {
+namespace detail {
+
+inline void put_u8(std::vector<std::uint8_t>& out, std::uint8_t v) {
+    out.push_back(v);
+}
+
+inline void put_u16(std::vector<std::uint8_t>& out, std::uint16_t v) {
+    out.push_back(static_cast<std::uint8_t>(v));
+    out.push_back(static_cast<std::uint8_t>(v >> 8));
+}
+
+inline void put_u32(std::vector<std::uint8_t>& out, std::uint32_t v) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<std::uint8_t>(v >> (8 * i)));
+    }
+}
+
+inline void put_u64(std::vector<std::uint8_t>& out, std::uint64_t v) {
+    for (int i = 0; i < 8; ++i) {
+        out.push_back(static_cast<std::uint8_t>(v >> (8 * i)));
+    }
+}
+
+inline void put_f64(std::vector<std::uint8_t>& out, double v) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &v, sizeof bits);
+    put_u64(out, bits);
+}
+
+// Unsigned LEB128: 7 bits per byte, high bit set on all but the last byte
+inline void put_varint(std::vector<std::uint8_t>& out, std::uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(v));
+}
+
+inline std::uint64_t load_le(const std::uint8_t* p, int bytes) {
+    std::uint64_t v = 0;
+    for (int i = 0; i < bytes; ++i) {
+        v |= static_cast<std::uint64_t>(p[i]) << (8 * i);
+    }
+    return v;
+}
+
+inline double load_f64_le(const std::uint8_t* p) {
+    const std::uint64_t bits = load_le(p, 8);
+    double v;
+    std::memcpy(&v, &bits, sizeof v);
+    return v;
+}
+
+inline void store_le(std::uint8_t* p, std::uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        p[i] = static_cast<std::uint8_t>(v >> (8 * i));
+    }
+}
+
+inline void store_f64_le(std::uint8_t* p, double v) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &v, sizeof bits);
+    store_le(p, bits, 8);
+}
+
+// Sequential reader over a byte buffer; throws std::invalid_argument when
+// a read runs past the end.
+class ByteReader {
+public:
+    ByteReader(const std::uint8_t* data, std::size_t size) : p_(data), end_(data + size) {}
+
+    std::uint8_t u8() {
+        return static_cast<std::uint8_t>(load_le(take(1), 1));
+    }
+
+    std::uint16_t u16() {
+        return static_cast<std::uint16_t>(load_le(take(2), 2));
+    }
+
+    std::uint32_t u32() {
+        return static_cast<std::uint32_t>(load_le(take(4), 4));
+    }
+
+    std::uint64_t u64() {
+        return load_le(take(8), 8);
+    }
+
+    double f64() {
+        return load_f64_le(take(8));
+    }
+
+    std::uint64_t varint() {
+        std::uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            const std::uint8_t b = u8();
+            if (shift == 63 && (b & 0x7E) != 0) {
+                throw std::invalid_argument("Malformed varint");
+            }
+            v |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+            if ((b & 0x80) == 0) {
+                return v;
+            }
+        }
+        throw std::invalid_argument("Malformed varint");
+    }
+
+    const std::uint8_t* bytes(std::size_t n) {
+        return take(n);
+    }
+
+    std::size_t remaining() const {
+        return static_cast<std::size_t>(end_ - p_);
+    }
+
+private:
+    const std::uint8_t* p_;
+    const std::uint8_t* end_;
+
+    const std::uint8_t* take(std::size_t n) {
+        if (remaining() < n) {
+            throw std::invalid_argument("Truncated binary data");
+        }
+        const std::uint8_t* at = p_;
+        p_ += n;
+        return at;
+    }
+};
+
+} // namespace detail
+} // namespace qtty
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "../ffi_core.hpp"
+#include "../units/angular.hpp"
+#include "../units/time.hpp"
+
+// ============================================================================
+// Compile-Time Unit Scales
+// ============================================================================
+// conversion_factor<From, To>() asks the FFI layer for a scale at run time.
+// Kernels that reduce angles modulo a full turn need that period *exactly*
+// (360 for degrees, not 2*pi / (pi/180)), so the angular tags generated from
+// qtty_ffi.h get their per-turn counts here as exact constants. Time tags
+// with a fixed length in SI seconds are listed the same way, so rate kernels
+// can fold angle and time scales together. Units without a specialization
+// fall back to the FFI factor.
+
+namespace qtty {
+namespace detail {
+
+inline constexpr double kPi = 3.141592653589793238462643383279502884;
+inline constexpr double kTwoPi = 2.0 * kPi;
+
+// Dimension code of a unit, following the qtty_ffi.h discriminant ranges
+// (1 = length, 2 = time, 3 = angle, 4 = mass, 5 = power).
+template<typename UnitTag>
+constexpr int dimension_code() {
+    return static_cast<int>(UnitTraits<UnitTag>::unit_id()) / 10000;
+}
+
+template<typename UnitTag>
+constexpr bool is_angle_unit() {
+    return dimension_code<UnitTag>() == 3;
+}
+
+template<typename UnitTag>
+constexpr bool is_time_unit() {
+    return dimension_code<UnitTag>() == 2;
+}
+
+template<typename UnitTag>
+struct AngleUnitsPerTurn {
+    static constexpr bool known = false;
+};
+
+#define QTTY_DETAIL_UNITS_PER_TURN(TAG, VALUE)          \
+    template<> struct AngleUnitsPerTurn<TAG> {          \
+        static constexpr bool known = true;             \
+        static constexpr double value = VALUE;          \
+    }
+
+QTTY_DETAIL_UNITS_PER_TURN(RadianTag, kTwoPi);
+QTTY_DETAIL_UNITS_PER_TURN(MilliradianTag, 1000.0 * kTwoPi);
+QTTY_DETAIL_UNITS_PER_TURN(DegreeTag, 360.0);
+QTTY_DETAIL_UNITS_PER_TURN(ArcminuteTag, 21600.0);
+QTTY_DETAIL_UNITS_PER_TURN(ArcsecondTag, 1296000.0);
+QTTY_DETAIL_UNITS_PER_TURN(MilliArcsecondTag, 1296000000.0);
+QTTY_DETAIL_UNITS_PER_TURN(MicroArcsecondTag, 1296000000000.0);
+QTTY_DETAIL_UNITS_PER_TURN(GradianTag, 400.0);
+QTTY_DETAIL_UNITS_PER_TURN(TurnTag, 1.0);
+QTTY_DETAIL_UNITS_PER_TURN(HourAngleTag, 24.0);
+
+#undef QTTY_DETAIL_UNITS_PER_TURN
+
+// Length of a full turn expressed in AngleTag
+template<typename AngleTag>
+double units_per_turn() {
+    static_assert(is_angle_unit<AngleTag>(), "Expected an angular unit");
+    if constexpr (AngleUnitsPerTurn<AngleTag>::known) {
+        return AngleUnitsPerTurn<AngleTag>::value;
+    } else {
+        return conversion_factor<TurnTag, AngleTag>();
+    }
+}
+
+// Radians per one AngleTag
+template<typename AngleTag>
+double radians_per_unit() {
+    static_assert(is_angle_unit<AngleTag>(), "Expected an angular unit");
+    if constexpr (AngleUnitsPerTurn<AngleTag>::known) {
+        return kTwoPi / AngleUnitsPerTurn<AngleTag>::value;
+    } else {
+        return conversion_factor<AngleTag, RadianTag>();
+    }
+}
+
+template<typename UnitTag>
+struct TimeUnitSeconds {
+    static constexpr bool known = false;
+};
+
+#define QTTY_DETAIL_TIME_UNIT_SECONDS(TAG, VALUE)       \
+    template<> struct TimeUnitSeconds<TAG> {            \
+        static constexpr bool known = true;             \
+        static constexpr double value = VALUE;          \
+    }
+
+QTTY_DETAIL_TIME_UNIT_SECONDS(NanosecondTag, 1e-9);
+QTTY_DETAIL_TIME_UNIT_SECONDS(MicrosecondTag, 1e-6);
+QTTY_DETAIL_TIME_UNIT_SECONDS(MillisecondTag, 1e-3);
+QTTY_DETAIL_TIME_UNIT_SECONDS(SecondTag, 1.0);
+QTTY_DETAIL_TIME_UNIT_SECONDS(MinuteTag, 60.0);
+QTTY_DETAIL_TIME_UNIT_SECONDS(HourTag, 3600.0);
+QTTY_DETAIL_TIME_UNIT_SECONDS(DayTag, 86400.0);
+QTTY_DETAIL_TIME_UNIT_SECONDS(WeekTag, 604800.0);
+QTTY_DETAIL_TIME_UNIT_SECONDS(JulianYearTag, 31557600.0);
+QTTY_DETAIL_TIME_UNIT_SECONDS(JulianCenturyTag, 3155760000.0);
+
+#undef QTTY_DETAIL_TIME_UNIT_SECONDS
+
+// SI seconds per one TimeTag
+template<typename TimeTag>
+double seconds_per_unit() {
+    static_assert(is_time_unit<TimeTag>(), "Expected a time unit");
+    if constexpr (TimeUnitSeconds<TimeTag>::known) {
+        return TimeUnitSeconds<TimeTag>::value;
+    } else {
+        return conversion_factor<TimeTag, SecondTag>();
+    }
+}
+
+// Factor from one unit to another when the units are only known at run time
+// (e.g. a unit id read from serialized data). Throws like Quantity::to<>().
+inline double runtime_conversion_factor(UnitId from, UnitId to) {
+    if (from == to) {
+        return 1.0;
+    }
+    qtty_quantity_t src{};
+    qtty_quantity_t dst{};
+    check_status(qtty_quantity_make(1.0, from, &src), "Creating source quantity");
+    check_status(qtty_quantity_convert(src, to, &dst), "Converting units");
+    return dst.value;
+}
+
+} // namespace detail
+} // namespace qtty
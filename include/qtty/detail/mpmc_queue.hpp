@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+// ============================================================================
+// Bounded Lock-Free Queue
+// ============================================================================
+// Dmitry Vyukov's bounded multi-producer / multi-consumer array queue. Each
+// cell carries a sequence number that tells producers and consumers whether
+// it is free, full, or still being written. Both ends claim slots with one
+// CAS and never block, so a full or empty queue is reported as failure
+// rather than waited on. The head and tail counters live on separate cache
+// lines so producers and consumers do not false-share.
+
+namespace qtty {
+namespace detail {
+
+inline constexpr std::size_t kCacheLine = 64;
+
+inline std::size_t round_up_pow2(std::size_t n) {
+    std::size_t p = 1;
+    while (p < n) {
+        p <<= 1;
+    }
+    return p;
+}
+
+template<typename T>
+class MpmcQueue {
+public:
+    // Capacity is rounded up to a power of two (at least 2)
+    explicit MpmcQueue(std::size_t capacity)
+        : mask_(round_up_pow2(capacity < 2 ? 2 : capacity) - 1), cells_(new Cell[mask_ + 1]) {
+        for (std::size_t i = 0; i <= mask_; ++i) {
+            cells_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    std::size_t capacity() const noexcept {
+        return mask_ + 1;
+    }
+
+    // Moves from `v` only on success
+    bool try_push(T& v) {
+        std::size_t pos = tail_.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            const std::size_t seq = cell->seq.load(std::memory_order_acquire);
+            const auto dif = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+            if (dif == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (dif < 0) {
+                return false;
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(v);
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T& out) {
+        std::size_t pos = head_.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            const std::size_t seq = cell->seq.load(std::memory_order_acquire);
+            const auto dif = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+            if (dif == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (dif < 0) {
+                return false;
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+        out = std::move(cell->value);
+        cell->seq.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> seq;
+        T value;
+    };
+
+    alignas(kCacheLine) std::atomic<std::size_t> head_{0};
+    alignas(kCacheLine) std::atomic<std::size_t> tail_{0};
+    alignas(kCacheLine) std::size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+};
+
+} // namespace detail
+} // namespace qtty
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+// Data-Parallel Loops
+// ============================================================================
+// Minimal fork-join helper used by the array kernels. The range [0, n) is
+// split into one contiguous chunk per worker; the calling thread processes
+// the first chunk itself. Small inputs never spawn threads.
+
+namespace qtty {
+namespace detail {
+
+// Below this many elements per worker, thread start-up dominates the work.
+inline constexpr std::size_t kMinItemsPerThread = 16384;
+
+// Number of workers to use for n items. `requested` == 0 means one per
+// hardware thread.
+inline unsigned worker_count(std::size_t n, unsigned requested,
+                             std::size_t min_per_thread = kMinItemsPerThread) {
+    unsigned hw = requested != 0 ? requested : std::thread::hardware_concurrency();
+    if (hw == 0) {
+        hw = 1;
+    }
+    const std::size_t by_size = std::max<std::size_t>(1, n / std::max<std::size_t>(1, min_per_thread));
+    return static_cast<unsigned>(std::min<std::size_t>(hw, by_size));
+}
+
+// Calls fn(begin, end) for disjoint chunks covering [0, n). The first
+// exception thrown by any chunk is rethrown after all workers have joined.
+template<typename Fn>
+void parallel_for(std::size_t n, unsigned threads, Fn&& fn,
+                  std::size_t min_per_thread = kMinItemsPerThread) {
+    const unsigned workers = worker_count(n, threads, min_per_thread);
+    if (workers <= 1) {
+        if (n > 0) {
+            fn(std::size_t{0}, n);
+        }
+        return;
+    }
+
+    const std::size_t chunk = (n + workers - 1) / workers;
+    std::vector<std::exception_ptr> errors(workers);
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    for (unsigned w = 1; w < workers; ++w) {
+        const std::size_t begin = std::min(n, w * chunk);
+        const std::size_t end = std::min(n, begin + chunk);
+        pool.emplace_back([&fn, &errors, w, begin, end]() {
+            try {
+                if (begin < end) {
+                    fn(begin, end);
+                }
+            } catch (...) {
+                errors[w] = std::current_exception();
+            }
+        });
+    }
+    try {
+        fn(std::size_t{0}, std::min(n, chunk));
+    } catch (...) {
+        errors[0] = std::current_exception();
+    }
+    for (auto& t : pool) {
+        t.join();
+    }
+    for (auto& e : errors) {
+        if (e) {
+            std::rethrow_exception(e);
+        }
+    }
+}
+
+} // namespace detail
+} // namespace qtty
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+#include "../ffi_core.hpp"
+
+// ============================================================================
+// Vectorization Helpers
+// ============================================================================
+// The array kernels in qtty are written as flat, branch-free loops over raw
+// doubles so that the compiler can vectorize them for whatever instruction
+// set the consumer builds with (-msse4.2, -mavx2, -march=native, ...). No
+// intrinsics are used; the library stays header-only and portable.
+//
+// QTTY_SIMD_LOOP tells the compiler that iterations of the following loop
+// are independent. Kernels annotated with it only ever read and write
+// element i in iteration i, so in-place use (out == in) stays valid.
+
+#if defined(__clang__)
+#define QTTY_SIMD_LOOP _Pragma("clang loop vectorize(enable) interleave(enable)")
+#elif defined(__GNUC__)
+#define QTTY_SIMD_LOOP _Pragma("GCC ivdep")
+#elif defined(_MSC_VER)
+#define QTTY_SIMD_LOOP __pragma(loop(ivdep))
+#else
+#define QTTY_SIMD_LOOP
+#endif
+
+namespace qtty {
+namespace detail {
+
+// Quantity<Tag> holds exactly one double, so an array of quantities can be
+// walked as an array of doubles by the kernels. The layout guarantees that
+// make this valid are checked for every tag that goes through raw().
+template<typename UnitTag>
+constexpr bool check_quantity_layout() {
+    using Q = Quantity<UnitTag>;
+    static_assert(std::is_standard_layout<Q>::value, "Quantity must be standard-layout");
+    static_assert(std::is_trivially_copyable<Q>::value, "Quantity must be trivially copyable");
+    static_assert(sizeof(Q) == sizeof(double), "Quantity must be exactly one double");
+    static_assert(alignof(Q) == alignof(double), "Quantity must be aligned like double");
+    return true;
+}
+
+template<typename UnitTag>
+inline const double* raw(const Quantity<UnitTag>* p) {
+    static_assert(check_quantity_layout<UnitTag>(), "");
+    return reinterpret_cast<const double*>(p);
+}
+
+template<typename UnitTag>
+inline double* raw(Quantity<UnitTag>* p) {
+    static_assert(check_quantity_layout<UnitTag>(), "");
+    return reinterpret_cast<double*>(p);
+}
+
+} // namespace detail
+} // namespace qtty
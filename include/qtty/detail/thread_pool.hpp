@@ -0,0 +1,155 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "mpmc_queue.hpp"
+
+// ============================================================================
+// Work-Stealing Thread Pool
+// ============================================================================
+// Each worker owns a task deque. A worker pushes and pops at the back of
+// its own deque, so related work stays on the same core with warm caches.
+// An idle worker steals from the front of the other deques. Tasks submitted
+// from outside the pool are spread round-robin. Each deque has its own
+// small mutex, so contention only happens when a worker is stealing.
+//
+// run_one() lets any thread (e.g. one blocked on a full queue) run a
+// pending task instead of waiting. Tasks must not throw.
+
+namespace qtty {
+namespace detail {
+
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit WorkStealingPool(unsigned threads) {
+        const unsigned n = threads == 0 ? 1 : threads;
+        for (unsigned i = 0; i < n; ++i) {
+            lanes_.push_back(std::make_unique<Lane>());
+        }
+        for (unsigned i = 0; i < n; ++i) {
+            threads_.emplace_back([this, i] { worker(i); });
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_m_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto& t : threads_) {
+            t.join();
+        }
+    }
+
+    unsigned size() const noexcept {
+        return static_cast<unsigned>(lanes_.size());
+    }
+
+    void submit(Task task) {
+        const unsigned lane = self() == this ? self_lane()
+                                             : next_.fetch_add(1, std::memory_order_relaxed) % size();
+        {
+            std::lock_guard<std::mutex> lock(lanes_[lane]->m);
+            lanes_[lane]->tasks.push_back(std::move(task));
+            pending_.fetch_add(1, std::memory_order_release);
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleep_m_);
+        }
+        wake_.notify_one();
+    }
+
+    // Runs one pending task on the calling thread; false if none was found
+    bool run_one() {
+        Task task;
+        if (!take(self() == this ? self_lane() : 0, task)) {
+            return false;
+        }
+        task();
+        return true;
+    }
+
+private:
+    struct alignas(kCacheLine) Lane {
+        std::mutex m;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Lane>> lanes_;
+    std::vector<std::thread> threads_;
+    std::atomic<std::size_t> pending_{0};
+    std::atomic<unsigned> next_{0};
+    std::mutex sleep_m_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+
+    static WorkStealingPool*& self() {
+        static thread_local WorkStealingPool* pool = nullptr;
+        return pool;
+    }
+
+    static unsigned& self_lane() {
+        static thread_local unsigned lane = 0;
+        return lane;
+    }
+
+    // Own lane from the back, then the others from the front
+    bool take(unsigned lane, Task& out) {
+        if (pending_.load(std::memory_order_acquire) == 0) {
+            return false;
+        }
+        const unsigned n = size();
+        for (unsigned k = 0; k < n; ++k) {
+            Lane& l = *lanes_[(lane + k) % n];
+            std::lock_guard<std::mutex> lock(l.m);
+            if (l.tasks.empty()) {
+                continue;
+            }
+            if (k == 0) {
+                out = std::move(l.tasks.back());
+                l.tasks.pop_back();
+            } else {
+                out = std::move(l.tasks.front());
+                l.tasks.pop_front();
+            }
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    void worker(unsigned lane) {
+        self() = this;
+        self_lane() = lane;
+        Task task;
+        for (;;) {
+            if (take(lane, task)) {
+                task();
+                task = nullptr;
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_m_);
+            wake_.wait(lock, [&] { return stop_ || pending_.load(std::memory_order_acquire) != 0; });
+            if (stop_ && pending_.load(std::memory_order_acquire) == 0) {
+                return;
+            }
+        }
+    }
+};
+
+} // namespace detail
+} // namespace qtty
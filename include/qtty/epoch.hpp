@@ -0,0 +1,281 @@
+#pragma once
+
+/**
+ * @file epoch.hpp
+ * @brief Absolute instants (Julian Date, MJD, TAI seconds) with sub-nanosecond resolution
+ *
+ * An Epoch stores a Julian Date as two doubles:
+ * - an integral day number, and
+ * - a fraction of a day in [0, 1).
+ *
+ * The fraction resolves ~10 picoseconds at any date, unlike a single double
+ * JD, which resolves only ~40 microseconds today.
+ *
+ * The time scale (TT, TAI, UTC, TDB, ...) is not tracked. All epochs in one
+ * computation must share a scale, and from_tai_seconds() is only a
+ * convenience for TAI-based counters.
+ *
+ * Arithmetic with durations accepts any time Quantity:
+ * - Units that are whole numbers of days (Day, Week, JulianCentury) are
+ *   applied in days.
+ * - Other units, including JulianYear (365.25 days), are applied in
+ *   seconds and split into whole days plus the remaining seconds.
+ *
+ * The product is split exactly (fma), so offsets lose nothing beyond the
+ * fraction's own resolution. Differences come back as any time unit, or
+ * split exactly into whole days plus remaining seconds.
+ *
+ * Usage example:
+ * @code
+ * Epoch t0 = Epoch::from_mjd(60000.0);
+ * Epoch t1 = t0 + Second(0.25) + Day(3.0);
+ * Second dt = t1 - t0;                           // 259200.25 s
+ * JulianCentury T = t1.julian_centuries();       // since J2000.0
+ *
+ * batch::difference(times.data(), t0, offsets.data(), n);
+ * @endcode
+ */
+
+#include <cmath>
+#include <cstddef>
+
+#include "ffi_core.hpp"
+#include "units/time.hpp"
+#include "detail/factors.hpp"
+#include "detail/parallel.hpp"
+#include "detail/simd.hpp"
+
+namespace qtty {
+
+namespace detail {
+
+inline constexpr double kSecondsPerDay = 86400.0;
+inline constexpr double kJdJ2000 = 2451545.0;
+inline constexpr double kJdTaiZero = 2436204.5;  // 1958-01-01T00:00:00 TAI
+
+// Exact split of `value` TimeTag into whole days plus a remainder in days
+template<typename TimeTag>
+void split_days(double value, double& days, double& fraction) {
+    const double f = seconds_per_unit<TimeTag>();
+    if (std::fmod(f, kSecondsPerDay) == 0.0) {
+        const double k = f / kSecondsPerDay;
+        const double hi = value * k;
+        const double lo = std::fma(value, k, -hi);
+        days = std::floor(hi);
+        fraction = (hi - days) + lo;
+    } else {
+        const double hi = value * f;
+        const double lo = std::fma(value, f, -hi);
+        days = std::floor(hi / kSecondsPerDay);
+        fraction = (std::fma(-days, kSecondsPerDay, hi) + lo) / kSecondsPerDay;
+    }
+}
+
+// (days + fraction) in TimeTag is (days * scale + fraction * scale) / divisor
+struct DayScale {
+    double scale;
+    double divisor;
+};
+
+template<typename TimeTag>
+DayScale day_scale() {
+    const double f = seconds_per_unit<TimeTag>();
+    if (std::fmod(f, kSecondsPerDay) == 0.0) {
+        return {1.0, f / kSecondsPerDay};
+    }
+    return {kSecondsPerDay, f};
+}
+
+} // namespace detail
+
+class Epoch {
+public:
+    // Julian Date 0
+    Epoch() = default;
+
+    // Two-part Julian Date; the split between the parts is arbitrary
+    static Epoch from_jd(double jd1, double jd2 = 0.0) {
+        const double d1 = std::floor(jd1);
+        const double d2 = std::floor(jd2);
+        return Epoch(d1 + d2, (jd1 - d1) + (jd2 - d2));
+    }
+
+    static Epoch from_mjd(double mjd) {
+        const double d = std::floor(mjd);
+        return Epoch(d + 2400000.0, (mjd - d) + 0.5);
+    }
+
+    // Seconds since 1958-01-01T00:00:00 TAI
+    static Epoch from_tai_seconds(double seconds) {
+        return from_jd(detail::kJdTaiZero) + Second(seconds);
+    }
+
+    static Epoch j2000() {
+        return from_jd(detail::kJdJ2000);
+    }
+
+    // Integral part of the Julian Date
+    double jd_day() const {
+        return day_;
+    }
+
+    // Fraction of the day in [0, 1)
+    double jd_fraction() const {
+        return fraction_;
+    }
+
+    // Single-double forms; these round to the precision of one double
+    double jd() const {
+        return day_ + fraction_;
+    }
+
+    double mjd() const {
+        return (day_ - 2400000.0) + (fraction_ - 0.5);
+    }
+
+    double tai_seconds() const {
+        return since<SecondTag>(from_jd(detail::kJdTaiZero)).value();
+    }
+
+    // Julian centuries since J2000.0
+    JulianCentury julian_centuries() const {
+        return since<JulianCenturyTag>(j2000());
+    }
+
+    // Elapsed time from `origin` to this epoch
+    template<typename TimeTag = SecondTag>
+    Quantity<TimeTag> since(const Epoch& origin) const {
+        const detail::DayScale u = detail::day_scale<TimeTag>();
+        return Quantity<TimeTag>(((day_ - origin.day_) * u.scale +
+                                  (fraction_ - origin.fraction_) * u.scale) / u.divisor);
+    }
+
+    template<typename TimeTag>
+    Epoch& operator+=(const Quantity<TimeTag>& dt) {
+        double days, fraction;
+        detail::split_days<TimeTag>(dt.value(), days, fraction);
+        day_ += days;
+        fraction_ += fraction;
+        normalize();
+        return *this;
+    }
+
+    template<typename TimeTag>
+    Epoch& operator-=(const Quantity<TimeTag>& dt) {
+        return *this += -dt;
+    }
+
+    template<typename TimeTag>
+    Epoch operator+(const Quantity<TimeTag>& dt) const {
+        Epoch r = *this;
+        r += dt;
+        return r;
+    }
+
+    template<typename TimeTag>
+    Epoch operator-(const Quantity<TimeTag>& dt) const {
+        Epoch r = *this;
+        r -= dt;
+        return r;
+    }
+
+    Second operator-(const Epoch& other) const {
+        return since<SecondTag>(other);
+    }
+
+    bool operator==(const Epoch& other) const {
+        return day_ == other.day_ && fraction_ == other.fraction_;
+    }
+
+    bool operator!=(const Epoch& other) const {
+        return !(*this == other);
+    }
+
+    bool operator<(const Epoch& other) const {
+        return day_ < other.day_ || (day_ == other.day_ && fraction_ < other.fraction_);
+    }
+
+    bool operator>(const Epoch& other) const {
+        return other < *this;
+    }
+
+    bool operator<=(const Epoch& other) const {
+        return !(other < *this);
+    }
+
+    bool operator>=(const Epoch& other) const {
+        return !(*this < other);
+    }
+
+private:
+    double day_ = 0.0;
+    double fraction_ = 0.0;
+
+    Epoch(double day, double fraction) : day_(day), fraction_(fraction) {
+        normalize();
+    }
+
+    void normalize() {
+        const double w = std::floor(fraction_);
+        day_ += w;
+        fraction_ -= w;
+        // fraction_ - w can round up to exactly 1 for tiny negative inputs
+        if (fraction_ >= 1.0) {
+            fraction_ -= 1.0;
+            day_ += 1.0;
+        }
+    }
+};
+
+// Exact difference a - b as whole days plus seconds in (-86400, 86400)
+struct EpochDifference {
+    Day days;
+    Second seconds;
+};
+
+inline EpochDifference split_difference(const Epoch& a, const Epoch& b) {
+    return {Day(a.jd_day() - b.jd_day()),
+            Second((a.jd_fraction() - b.jd_fraction()) * detail::kSecondsPerDay)};
+}
+
+// ============================================================================
+// Batch Differences
+// ============================================================================
+
+namespace batch {
+
+// out[i] = a[i] - b[i]
+template<typename TimeTag>
+void difference(const Epoch* a, const Epoch* b, Quantity<TimeTag>* out, std::size_t n,
+                unsigned threads = 0) {
+    const detail::DayScale u = detail::day_scale<TimeTag>();
+    double* o = detail::raw(out);
+    detail::parallel_for(n, threads, [&](std::size_t begin, std::size_t end) {
+        QTTY_SIMD_LOOP
+        for (std::size_t i = begin; i < end; ++i) {
+            o[i] = ((a[i].jd_day() - b[i].jd_day()) * u.scale +
+                    (a[i].jd_fraction() - b[i].jd_fraction()) * u.scale) / u.divisor;
+        }
+    });
+}
+
+// out[i] = a[i] - origin
+template<typename TimeTag>
+void difference(const Epoch* a, const Epoch& origin, Quantity<TimeTag>* out, std::size_t n,
+                unsigned threads = 0) {
+    const detail::DayScale u = detail::day_scale<TimeTag>();
+    const double d0 = origin.jd_day();
+    const double f0 = origin.jd_fraction();
+    double* o = detail::raw(out);
+    detail::parallel_for(n, threads, [&](std::size_t begin, std::size_t end) {
+        QTTY_SIMD_LOOP
+        for (std::size_t i = begin; i < end; ++i) {
+            o[i] = ((a[i].jd_day() - d0) * u.scale + (a[i].jd_fraction() - f0) * u.scale) /
+                   u.divisor;
+        }
+    });
+}
+
+} // namespace batch
+
+} // namespace qtty
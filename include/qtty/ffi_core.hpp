@@ -267,4 +267,28 @@ public:
     }
 };
 
+// ============================================================================
+// Conversion Factors
+// ============================================================================
+// Every unit exposed by qtty-ffi is a pure scale of its dimension's base
+// unit, so converting N values only needs one FFI round-trip to obtain the
+// factor. Array kernels use this instead of calling .to<>() per element.
+//
+// The factor is cached per (From, To) pair after the first successful call.
+// Throws IncompatibleDimensionsError for units of different dimensions.
+
+// Factor f such that a value v in FromType equals v * f in ToType
+template<typename FromType, typename ToType>
+double conversion_factor() {
+    using FromTag = typename ExtractTag<FromType>::type;
+    using ToTag = typename ExtractTag<ToType>::type;
+    if constexpr (std::is_same<FromTag, ToTag>::value) {
+        return 1.0;
+    } else {
+        static const double factor =
+            Quantity<FromTag>(1.0).template to<ToTag>().value();
+        return factor;
+    }
+}
+
 } // namespace qtty
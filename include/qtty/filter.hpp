@@ -0,0 +1,266 @@
+#pragma once
+
+/**
+ * @file filter.hpp
+ * @brief Bitmask predicates, selection vectors and compress / gather
+ *
+ * The predicates in batch:: test every element of a quantity array and write
+ * one bit per element into a mask of mask_words(n) 64-bit words. Bit i of
+ * the mask is bit (i % 64) of word i / 64. Bits past n in the last word are
+ * always zero.
+ *
+ * Predicates:
+ * - less, less_equal, greater, greater_equal: compare with a threshold;
+ * - between: lo <= v <= hi;
+ * - is_nan, is_finite.
+ * Thresholds may be in any unit of the same dimension. They are converted
+ * into the array's unit once, so the loop is a plain double comparison.
+ * Each 64-element word is built by a flat loop that the compiler turns
+ * into vector compares plus a movemask-style reduction. Comparisons with
+ * NaN are false, as with Quantity::operator<.
+ *
+ * Masks combine word by word with mask_and / mask_or / mask_not, and
+ * mask_count() counts the set bits. To materialize matching rows:
+ * - selection_from_mask() turns a mask into ascending row indices;
+ * - compress() copies the selected elements of any column contiguously;
+ * - gather() copies the rows of a selection vector, e.g. from another
+ *   column of the same table.
+ *
+ * Usage example:
+ * @code
+ * std::vector<std::uint64_t> near(mask_words(n)), bright(mask_words(n));
+ * batch::less(dist.data(), n, Kiloparsec(1.0), near.data());   // dist in Parsec
+ * batch::greater(flux.data(), n, Milliwatt(5.0), bright.data());
+ * batch::mask_and(near.data(), bright.data(), near.data(), n);
+ *
+ * std::vector<std::uint32_t> rows(batch::mask_count(near.data(), n));
+ * batch::selection_from_mask(near.data(), n, rows.data());
+ * batch::gather(flux.data(), rows.data(), rows.size(), picked.data());
+ * @endcode
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "ffi_core.hpp"
+#include "detail/simd.hpp"
+
+namespace qtty {
+
+// Number of 64-bit words in a mask over n elements
+inline constexpr std::size_t mask_words(std::size_t n) {
+    return (n + 63) / 64;
+}
+
+namespace detail {
+
+inline int popcount64(std::uint64_t w) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(w);
+#else
+    int c = 0;
+    for (; w != 0; w &= w - 1) {
+        ++c;
+    }
+    return c;
+#endif
+}
+
+inline int ctz64(std::uint64_t w) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(w);
+#else
+    int c = 0;
+    for (; (w & 1) == 0; w >>= 1) {
+        ++c;
+    }
+    return c;
+#endif
+}
+
+// mask bit i = pred(x[i]) for i in [0, n)
+template<typename Pred>
+void mask_kernel(const double* x, std::size_t n, std::uint64_t* mask, Pred pred) {
+    const std::size_t full = n / 64;
+    for (std::size_t w = 0; w < full; ++w) {
+        const double* block = x + w * 64;
+        std::uint64_t bits = 0;
+        QTTY_SIMD_LOOP
+        for (std::size_t j = 0; j < 64; ++j) {
+            bits |= static_cast<std::uint64_t>(pred(block[j]) ? 1 : 0) << j;
+        }
+        mask[w] = bits;
+    }
+    const std::size_t tail = n - full * 64;
+    if (tail != 0) {
+        const double* block = x + full * 64;
+        std::uint64_t bits = 0;
+        for (std::size_t j = 0; j < tail; ++j) {
+            bits |= static_cast<std::uint64_t>(pred(block[j]) ? 1 : 0) << j;
+        }
+        mask[full] = bits;
+    }
+}
+
+template<typename UnitTag, typename ThresholdTag>
+double threshold_in(const Quantity<ThresholdTag>& t) {
+    return t.value() * conversion_factor<ThresholdTag, UnitTag>();
+}
+
+} // namespace detail
+
+namespace batch {
+
+// ============================================================================
+// Predicates
+// ============================================================================
+
+template<typename UnitTag, typename ThresholdTag>
+void less(const Quantity<UnitTag>* values, std::size_t n, const Quantity<ThresholdTag>& threshold,
+          std::uint64_t* mask) {
+    const double t = detail::threshold_in<UnitTag>(threshold);
+    detail::mask_kernel(detail::raw(values), n, mask, [t](double v) { return v < t; });
+}
+
+template<typename UnitTag, typename ThresholdTag>
+void less_equal(const Quantity<UnitTag>* values, std::size_t n,
+                const Quantity<ThresholdTag>& threshold, std::uint64_t* mask) {
+    const double t = detail::threshold_in<UnitTag>(threshold);
+    detail::mask_kernel(detail::raw(values), n, mask, [t](double v) { return v <= t; });
+}
+
+template<typename UnitTag, typename ThresholdTag>
+void greater(const Quantity<UnitTag>* values, std::size_t n,
+             const Quantity<ThresholdTag>& threshold, std::uint64_t* mask) {
+    const double t = detail::threshold_in<UnitTag>(threshold);
+    detail::mask_kernel(detail::raw(values), n, mask, [t](double v) { return v > t; });
+}
+
+template<typename UnitTag, typename ThresholdTag>
+void greater_equal(const Quantity<UnitTag>* values, std::size_t n,
+                   const Quantity<ThresholdTag>& threshold, std::uint64_t* mask) {
+    const double t = detail::threshold_in<UnitTag>(threshold);
+    detail::mask_kernel(detail::raw(values), n, mask, [t](double v) { return v >= t; });
+}
+
+// lo <= v <= hi; lo and hi may be in different units
+template<typename UnitTag, typename LoTag, typename HiTag>
+void between(const Quantity<UnitTag>* values, std::size_t n, const Quantity<LoTag>& lo,
+             const Quantity<HiTag>& hi, std::uint64_t* mask) {
+    const double a = detail::threshold_in<UnitTag>(lo);
+    const double b = detail::threshold_in<UnitTag>(hi);
+    detail::mask_kernel(detail::raw(values), n, mask, [a, b](double v) { return v >= a && v <= b; });
+}
+
+template<typename UnitTag>
+void is_nan(const Quantity<UnitTag>* values, std::size_t n, std::uint64_t* mask) {
+    detail::mask_kernel(detail::raw(values), n, mask, [](double v) { return v != v; });
+}
+
+template<typename UnitTag>
+void is_finite(const Quantity<UnitTag>* values, std::size_t n, std::uint64_t* mask) {
+    // inf - inf and NaN - NaN are NaN
+    detail::mask_kernel(detail::raw(values), n, mask, [](double v) { return v - v == 0.0; });
+}
+
+// ============================================================================
+// Mask Algebra
+// ============================================================================
+// `out` may alias either input.
+
+inline void mask_and(const std::uint64_t* a, const std::uint64_t* b, std::uint64_t* out,
+                     std::size_t n) {
+    const std::size_t words = mask_words(n);
+    QTTY_SIMD_LOOP
+    for (std::size_t w = 0; w < words; ++w) {
+        out[w] = a[w] & b[w];
+    }
+}
+
+inline void mask_or(const std::uint64_t* a, const std::uint64_t* b, std::uint64_t* out,
+                    std::size_t n) {
+    const std::size_t words = mask_words(n);
+    QTTY_SIMD_LOOP
+    for (std::size_t w = 0; w < words; ++w) {
+        out[w] = a[w] | b[w];
+    }
+}
+
+// Complement over [0, n); the bits past n stay zero
+inline void mask_not(const std::uint64_t* a, std::uint64_t* out, std::size_t n) {
+    const std::size_t words = mask_words(n);
+    QTTY_SIMD_LOOP
+    for (std::size_t w = 0; w < words; ++w) {
+        out[w] = ~a[w];
+    }
+    if (n % 64 != 0) {
+        out[words - 1] &= (std::uint64_t{1} << (n % 64)) - 1;
+    }
+}
+
+inline std::size_t mask_count(const std::uint64_t* mask, std::size_t n) {
+    const std::size_t words = mask_words(n);
+    std::size_t count = 0;
+    for (std::size_t w = 0; w < words; ++w) {
+        count += static_cast<std::size_t>(detail::popcount64(mask[w]));
+    }
+    return count;
+}
+
+// ============================================================================
+// Materialization
+// ============================================================================
+
+// Ascending indices of the set bits (n must fit in 32 bits); `sel` needs
+// mask_count() slots. Returns the number written.
+inline std::size_t selection_from_mask(const std::uint64_t* mask, std::size_t n,
+                                       std::uint32_t* sel) {
+    const std::size_t words = mask_words(n);
+    std::size_t m = 0;
+    for (std::size_t w = 0; w < words; ++w) {
+        std::uint64_t bits = mask[w];
+        const std::uint32_t base = static_cast<std::uint32_t>(w * 64);
+        while (bits != 0) {
+            sel[m++] = base + static_cast<std::uint32_t>(detail::ctz64(bits));
+            bits &= bits - 1;
+        }
+    }
+    return m;
+}
+
+// Copies the elements of column[0, n) whose bit is set into out, in order.
+// `out` needs mask_count() slots. Returns the number written.
+template<typename T>
+std::size_t compress(const T* column, const std::uint64_t* mask, std::size_t n, T* out) {
+    const std::size_t words = mask_words(n);
+    std::size_t m = 0;
+    for (std::size_t w = 0; w < words; ++w) {
+        std::uint64_t bits = mask[w];
+        const T* block = column + w * 64;
+        if (bits == ~std::uint64_t{0}) {
+            for (std::size_t j = 0; j < 64; ++j) {
+                out[m + j] = block[j];
+            }
+            m += 64;
+            continue;
+        }
+        while (bits != 0) {
+            out[m++] = block[detail::ctz64(bits)];
+            bits &= bits - 1;
+        }
+    }
+    return m;
+}
+
+// out[k] = column[sel[k]] for k in [0, m)
+template<typename T>
+void gather(const T* column, const std::uint32_t* sel, std::size_t m, T* out) {
+    for (std::size_t k = 0; k < m; ++k) {
+        out[k] = column[sel[k]];
+    }
+}
+
+} // namespace batch
+
+} // namespace qtty
@@ -0,0 +1,241 @@
+#pragma once
+
+/**
+ * @file frames.hpp
+ * @brief Rotations of sky positions between equatorial, ecliptic and galactic frames
+ *
+ * Frames:
+ * - Frame::Equatorial: ICRS / J2000 mean equator and equinox
+ * - Frame::Ecliptic:   J2000 mean ecliptic (IAU 2006 obliquity, 84381.406")
+ * - Frame::Galactic:   IAU galactic coordinates (Hipparcos ICRS->galactic matrix)
+ *
+ * A FrameRotation holds the 3x3 matrix for one (from, to) pair. The nine
+ * possible rotations are built once, on first use, and shared afterwards.
+ * Positions are (longitude, latitude) in any angular unit; output
+ * longitudes are wrapped to [0, full turn) and latitudes lie in
+ * [-quarter turn, quarter turn].
+ *
+ * The batch version stages sin/cos tables per block through the angles.hpp
+ * kernels, rotates the unit vectors, and converts back with atan2, so
+ * Accuracy::Fast vectorizes end to end. Arrays are split across threads.
+ *
+ * Usage example:
+ * @code
+ * const FrameRotation& eq_to_gal = FrameRotation::between(Frame::Equatorial, Frame::Galactic);
+ * SkyCoord<DegreeTag> g = eq_to_gal.apply(Degree(266.40510), Degree(-28.936175));
+ *
+ * batch::transform(eq_to_gal, ra.data(), dec.data(), l.data(), b.data(), n);
+ * @endcode
+ */
+
+#include <cmath>
+#include <cstddef>
+
+#include "ffi_core.hpp"
+#include "units/angular.hpp"
+#include "angles.hpp"
+#include "detail/factors.hpp"
+#include "detail/parallel.hpp"
+#include "detail/simd.hpp"
+
+namespace qtty {
+
+enum class Frame {
+    Equatorial = 0,
+    Ecliptic = 1,
+    Galactic = 2
+};
+
+template<typename AngleTag>
+struct SkyCoord {
+    Quantity<AngleTag> lon;
+    Quantity<AngleTag> lat;
+};
+
+struct FrameTransformOptions {
+    Accuracy accuracy = Accuracy::Precise;
+    unsigned threads = 0;  // 0 = one per hardware thread
+};
+
+namespace detail {
+struct FrameTable;
+} // namespace detail
+
+class FrameRotation {
+public:
+    using Matrix = double[3][3];
+
+    // Shared rotation taking positions in `from` to positions in `to`
+    static const FrameRotation& between(Frame from, Frame to);
+
+    const Matrix& matrix() const {
+        return m_;
+    }
+
+    // Rotate a single position; the result uses the input unit
+    template<typename AngleTag>
+    SkyCoord<AngleTag> apply(const Quantity<AngleTag>& lon, const Quantity<AngleTag>& lat,
+                             Accuracy accuracy = Accuracy::Precise) const {
+        SkyCoord<AngleTag> out;
+        const double l = lon.value();
+        const double b = lat.value();
+        rotate<AngleTag, AngleTag>(&l, &b, detail::raw(&out.lon), detail::raw(&out.lat), 1,
+                                   accuracy);
+        return out;
+    }
+
+    // Raw kernel: n positions from InTag arrays into OutTag arrays
+    template<typename InTag, typename OutTag>
+    void rotate(const double* lon, const double* lat, double* lon_out, double* lat_out,
+                std::size_t n, Accuracy accuracy) const;
+
+private:
+    Matrix m_ = {};
+
+    static FrameRotation from_matrix(const Matrix& m) {
+        FrameRotation r;
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                r.m_[i][j] = m[i][j];
+            }
+        }
+        return r;
+    }
+
+    // a * b
+    static FrameRotation compose(const FrameRotation& a, const FrameRotation& b) {
+        Matrix m;
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                m[i][j] = a.m_[i][0] * b.m_[0][j] + a.m_[i][1] * b.m_[1][j] +
+                          a.m_[i][2] * b.m_[2][j];
+            }
+        }
+        return from_matrix(m);
+    }
+
+    FrameRotation transposed() const {
+        Matrix m;
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                m[i][j] = m_[j][i];
+            }
+        }
+        return from_matrix(m);
+    }
+
+    friend struct detail::FrameTable;
+};
+
+namespace detail {
+
+// The nine rotations between frames, built once on first use
+struct FrameTable {
+    FrameRotation rotations[3][3];
+
+    FrameTable() {
+        using Matrix = FrameRotation::Matrix;
+        const Matrix identity = {{1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, 1.0}};
+        const double eps = 84381.406 / 3600.0 * kPi / 180.0;
+        const Matrix eq_to_ecl = {{1.0, 0.0, 0.0},
+                                  {0.0, std::cos(eps), std::sin(eps)},
+                                  {0.0, -std::sin(eps), std::cos(eps)}};
+        const Matrix eq_to_gal = {{-0.0548755604162154, -0.8734370902348850, -0.4838350155487132},
+                                  {+0.4941094278755837, -0.4448296299600112, +0.7469822444972189},
+                                  {-0.8676661490190047, -0.1980763734312015, +0.4559837761750669}};
+
+        const FrameRotation ecl = FrameRotation::from_matrix(eq_to_ecl);
+        const FrameRotation gal = FrameRotation::from_matrix(eq_to_gal);
+        const int eq = static_cast<int>(Frame::Equatorial);
+        const int ec = static_cast<int>(Frame::Ecliptic);
+        const int ga = static_cast<int>(Frame::Galactic);
+        for (int f = 0; f < 3; ++f) {
+            rotations[f][f] = FrameRotation::from_matrix(identity);
+        }
+        rotations[eq][ec] = ecl;
+        rotations[ec][eq] = ecl.transposed();
+        rotations[eq][ga] = gal;
+        rotations[ga][eq] = gal.transposed();
+        rotations[ec][ga] = FrameRotation::compose(gal, ecl.transposed());
+        rotations[ga][ec] = rotations[ec][ga].transposed();
+    }
+};
+
+} // namespace detail
+
+inline const FrameRotation& FrameRotation::between(Frame from, Frame to) {
+    static const detail::FrameTable table;
+    return table.rotations[static_cast<int>(from)][static_cast<int>(to)];
+}
+
+template<typename InTag, typename OutTag>
+void FrameRotation::rotate(const double* lon, const double* lat, double* lon_out,
+                           double* lat_out, std::size_t n, Accuracy accuracy) const {
+    constexpr std::size_t kBlock = 256;
+    const double per_turn = detail::units_per_turn<InTag>();
+    const double out_scale = 1.0 / detail::radians_per_unit<OutTag>();
+    const double turn_out = detail::units_per_turn<OutTag>();
+    double sl[kBlock], cl[kBlock], sb[kBlock], cb[kBlock];
+    double x[kBlock], y[kBlock], z[kBlock], rho[kBlock];
+    double lon_rad[kBlock], lat_rad[kBlock];
+
+    for (std::size_t base = 0; base < n; base += kBlock) {
+        const std::size_t m = std::min(kBlock, n - base);
+        detail::sincos_kernel(lon + base, sl, cl, m, per_turn, accuracy);
+        detail::sincos_kernel(lat + base, sb, cb, m, per_turn, accuracy);
+        QTTY_SIMD_LOOP
+        for (std::size_t i = 0; i < m; ++i) {
+            const double vx = cb[i] * cl[i];
+            const double vy = cb[i] * sl[i];
+            const double vz = sb[i];
+            x[i] = m_[0][0] * vx + m_[0][1] * vy + m_[0][2] * vz;
+            y[i] = m_[1][0] * vx + m_[1][1] * vy + m_[1][2] * vz;
+            z[i] = m_[2][0] * vx + m_[2][1] * vy + m_[2][2] * vz;
+            rho[i] = std::sqrt(x[i] * x[i] + y[i] * y[i]);
+        }
+        detail::atan2_kernel(y, x, lon_rad, m, accuracy);
+        detail::atan2_kernel(z, rho, lat_rad, m, accuracy);
+        double* lo = lon_out + base;
+        double* la = lat_out + base;
+        QTTY_SIMD_LOOP
+        for (std::size_t i = 0; i < m; ++i) {
+            const double l = lon_rad[i] < 0.0 ? lon_rad[i] + detail::kTwoPi : lon_rad[i];
+            lo[i] = l * out_scale;
+            la[i] = lat_rad[i] * out_scale;
+        }
+        // Rounding in the scale can land exactly on a full turn
+        for (std::size_t i = 0; i < m; ++i) {
+            lo[i] = lo[i] >= turn_out ? 0.0 : lo[i];
+        }
+    }
+}
+
+namespace batch {
+
+// Rotate n positions; outputs may alias inputs when the units match
+template<typename InTag, typename OutTag>
+void transform(const FrameRotation& rotation,
+               const Quantity<InTag>* lon, const Quantity<InTag>* lat,
+               Quantity<OutTag>* lon_out, Quantity<OutTag>* lat_out, std::size_t n,
+               const FrameTransformOptions& opts = FrameTransformOptions()) {
+    const double* l = detail::raw(lon);
+    const double* b = detail::raw(lat);
+    double* lo = detail::raw(lon_out);
+    double* la = detail::raw(lat_out);
+    detail::parallel_for(n, opts.threads, [&](std::size_t begin, std::size_t end) {
+        rotation.rotate<InTag, OutTag>(l + begin, b + begin, lo + begin, la + begin,
+                                       end - begin, opts.accuracy);
+    });
+}
+
+template<typename InTag, typename OutTag>
+void transform(Frame from, Frame to,
+               const Quantity<InTag>* lon, const Quantity<InTag>* lat,
+               Quantity<OutTag>* lon_out, Quantity<OutTag>* lat_out, std::size_t n,
+               const FrameTransformOptions& opts = FrameTransformOptions()) {
+    transform(FrameRotation::between(from, to), lon, lat, lon_out, lat_out, n, opts);
+}
+
+} // namespace batch
+
+} // namespace qtty
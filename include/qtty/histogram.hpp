@@ -0,0 +1,405 @@
+#pragma once
+
+/**
+ * @file histogram.hpp
+ * @brief Fixed-edge histograms with typed bin edges
+ *
+ * Histogram<Q> counts values into half-open bins [edge(i), edge(i + 1)).
+ * There are three ways to lay out the edges:
+ * - linear(lo, hi, bins): equal widths.
+ * - logarithmic(lo, hi, bins): equal ratios; lo must be positive.
+ * - custom(edges, n): any strictly increasing edges.
+ *
+ * Values below the first edge go to underflow(). Values at or above the
+ * last edge go to overflow(). NaN values go to nan_count(). Non-positive
+ * values land in underflow() for logarithmic bins.
+ *
+ * fill() accepts any unit of Q's dimension. The conversion factor is
+ * resolved once per call and applied in the binning loop. Binning runs in
+ * blocks:
+ * 1. A flat vectorizable loop rescales each value and computes its slot.
+ *    Linear and log bins use the closed-form index; custom edges use a
+ *    branchless binary search.
+ * 2. A scalar pass corrects closed-form slots that rounding put one bin
+ *    off, then increments the counts.
+ * Bin membership is therefore exact with respect to edge().
+ *
+ * merge() adds the counts of a histogram with identical edges, so
+ * per-thread shards combine into one. batch::fill() does exactly that.
+ *
+ * serialize() writes a compact little-endian byte string. Counts are
+ * LEB128 varints, so sparse histograms stay small:
+ *
+ *     "QHST" | version u8 | unit_id u32 | binning u8 | bins u32 |
+ *     edges (lo, hi for linear/log; bins + 1 f64 for custom) |
+ *     varint counts: underflow, bins..., overflow, nan
+ *
+ * Usage example:
+ * @code
+ * auto h = Histogram<Milliwatt>::logarithmic(Milliwatt(1e-3), Milliwatt(1e3), 60);
+ * h.fill(readings_in_watts.data(), readings_in_watts.size());  // Watt input
+ * std::uint64_t n = h.count(10);
+ * Milliwatt lower = h.lower(10);
+ *
+ * std::vector<std::uint8_t> bytes = h.serialize();
+ * total.merge(Histogram<Milliwatt>::deserialize(bytes.data(), bytes.size()));
+ * @endcode
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "ffi_core.hpp"
+#include "detail/bytes.hpp"
+#include "detail/factors.hpp"
+#include "detail/parallel.hpp"
+#include "detail/simd.hpp"
+
+namespace qtty {
+
+enum class Binning : std::uint8_t {
+    Linear = 0,
+    Logarithmic = 1,
+    Custom = 2
+};
+
+namespace detail {
+
+inline constexpr std::size_t kHistogramBlock = 1024;
+
+// Number of edges <= v (branchless upper bound over m >= 1 sorted edges)
+inline std::size_t edges_at_or_below(const double* edges, std::size_t m, double v) {
+    const double* base = edges;
+    std::size_t len = m;
+    while (len > 1) {
+        const std::size_t half = len / 2;
+        base = base[half] <= v ? base + half : base;
+        len -= half;
+    }
+    return static_cast<std::size_t>(base - edges) + (*base <= v ? 1 : 0);
+}
+
+} // namespace detail
+
+template<typename Q>
+class Histogram {
+public:
+    using unit_tag = typename Q::unit_tag;
+
+    static constexpr std::uint8_t kFormatVersion = 1;
+
+    static Histogram linear(const Q& lo, const Q& hi, std::size_t bins) {
+        check_range(lo.value(), hi.value(), bins);
+        Histogram h(Binning::Linear, bins);
+        const double a = lo.value();
+        const double b = hi.value();
+        for (std::size_t i = 0; i < bins; ++i) {
+            h.edges_[i] = a + (b - a) * (static_cast<double>(i) / static_cast<double>(bins));
+        }
+        h.edges_[bins] = b;
+        h.scale_ = static_cast<double>(bins) / (b - a);
+        h.offset_ = -a * h.scale_;
+        return h;
+    }
+
+    static Histogram logarithmic(const Q& lo, const Q& hi, std::size_t bins) {
+        check_range(lo.value(), hi.value(), bins);
+        if (!(lo.value() > 0.0)) {
+            throw std::invalid_argument("Logarithmic histogram needs a positive lower edge");
+        }
+        Histogram h(Binning::Logarithmic, bins);
+        const double la = std::log(lo.value());
+        const double lb = std::log(hi.value());
+        h.edges_[0] = lo.value();
+        for (std::size_t i = 1; i < bins; ++i) {
+            h.edges_[i] = std::exp(la + (lb - la) * (static_cast<double>(i) / static_cast<double>(bins)));
+        }
+        h.edges_[bins] = hi.value();
+        h.scale_ = static_cast<double>(bins) / (lb - la);
+        h.offset_ = -la * h.scale_;
+        return h;
+    }
+
+    // n >= 2 finite, strictly increasing edges
+    static Histogram custom(const Q* edges, std::size_t n) {
+        if (n < 2) {
+            throw std::invalid_argument("Histogram needs at least two edges");
+        }
+        Histogram h(Binning::Custom, n - 1);
+        for (std::size_t i = 0; i < n; ++i) {
+            const double e = edges[i].value();
+            if (!std::isfinite(e) || (i > 0 && !(e > h.edges_[i - 1]))) {
+                throw std::invalid_argument("Histogram edges must be finite and strictly increasing");
+            }
+            h.edges_[i] = e;
+        }
+        return h;
+    }
+
+    Binning binning() const {
+        return binning_;
+    }
+
+    std::size_t bins() const {
+        return edges_.size() - 1;
+    }
+
+    // Edge i in [0, bins()]
+    Q edge(std::size_t i) const {
+        return Q(edges_.at(i));
+    }
+
+    Q lower(std::size_t bin) const {
+        return edge(bin);
+    }
+
+    Q upper(std::size_t bin) const {
+        return edge(bin + 1);
+    }
+
+    std::uint64_t count(std::size_t bin) const {
+        if (bin >= bins()) {
+            throw std::out_of_range("Histogram bin out of range");
+        }
+        return counts_[bin + 1];
+    }
+
+    std::uint64_t underflow() const {
+        return counts_[0];
+    }
+
+    std::uint64_t overflow() const {
+        return counts_[bins() + 1];
+    }
+
+    std::uint64_t nan_count() const {
+        return counts_[bins() + 2];
+    }
+
+    // All filled values, including underflow, overflow and NaN
+    std::uint64_t total() const {
+        std::uint64_t t = 0;
+        for (std::uint64_t c : counts_) {
+            t += c;
+        }
+        return t;
+    }
+
+    void clear() {
+        std::fill(counts_.begin(), counts_.end(), 0);
+    }
+
+    template<typename Tag>
+    void fill(const Quantity<Tag>& x) {
+        fill(&x, 1);
+    }
+
+    template<typename Tag>
+    void fill(const Quantity<Tag>* values, std::size_t n) {
+        const double f = conversion_factor<Tag, unit_tag>();
+        const double* x = detail::raw(values);
+        double v[detail::kHistogramBlock];
+        std::uint32_t slot[detail::kHistogramBlock];
+        for (std::size_t base = 0; base < n; base += detail::kHistogramBlock) {
+            const std::size_t m = std::min(detail::kHistogramBlock, n - base);
+            compute_slots(x + base, f, v, slot, m);
+            for (std::size_t i = 0; i < m; ++i) {
+                ++counts_[slot[i]];
+            }
+        }
+    }
+
+    // Add the counts of a histogram with identical edges
+    void merge(const Histogram& other) {
+        if (other.binning_ != binning_ || other.edges_ != edges_) {
+            throw std::invalid_argument("Histogram merge requires identical edges");
+        }
+        for (std::size_t i = 0; i < counts_.size(); ++i) {
+            counts_[i] += other.counts_[i];
+        }
+    }
+
+    std::vector<std::uint8_t> serialize() const {
+        std::vector<std::uint8_t> out;
+        out.reserve(32 + 8 * edges_.size() + counts_.size());
+        for (char c : {'Q', 'H', 'S', 'T'}) {
+            detail::put_u8(out, static_cast<std::uint8_t>(c));
+        }
+        detail::put_u8(out, kFormatVersion);
+        detail::put_u32(out, static_cast<std::uint32_t>(UnitTraits<unit_tag>::unit_id()));
+        detail::put_u8(out, static_cast<std::uint8_t>(binning_));
+        detail::put_u32(out, static_cast<std::uint32_t>(bins()));
+        if (binning_ == Binning::Custom) {
+            for (double e : edges_) {
+                detail::put_f64(out, e);
+            }
+        } else {
+            detail::put_f64(out, edges_.front());
+            detail::put_f64(out, edges_.back());
+        }
+        for (std::uint64_t c : counts_) {
+            detail::put_varint(out, c);
+        }
+        return out;
+    }
+
+    // Throws std::invalid_argument on malformed input and the usual
+    // conversion errors when the stored unit does not match Q's dimension.
+    // Edges are rescaled into Q's unit.
+    static Histogram deserialize(const std::uint8_t* data, std::size_t size) {
+        detail::ByteReader in(data, size);
+        const std::uint8_t* magic = in.bytes(4);
+        if (magic[0] != 'Q' || magic[1] != 'H' || magic[2] != 'S' || magic[3] != 'T') {
+            throw std::invalid_argument("Not a histogram");
+        }
+        if (in.u8() != kFormatVersion) {
+            throw std::invalid_argument("Unsupported histogram version");
+        }
+        const UnitId unit = static_cast<UnitId>(in.u32());
+        const double f = detail::runtime_conversion_factor(unit, UnitTraits<unit_tag>::unit_id());
+        const std::uint8_t kind = in.u8();
+        const std::uint32_t bins = in.u32();
+        if (bins == 0) {
+            throw std::invalid_argument("Invalid histogram bin count");
+        }
+
+        Histogram h(Binning::Custom, 1);
+        if (kind == static_cast<std::uint8_t>(Binning::Custom)) {
+            if (bins >= in.remaining() / 8) {
+                throw std::invalid_argument("Truncated binary data");
+            }
+            std::vector<Q> edges(static_cast<std::size_t>(bins) + 1);
+            for (auto& e : edges) {
+                e = Q(in.f64() * f);
+            }
+            h = custom(edges.data(), edges.size());
+        } else if (kind == static_cast<std::uint8_t>(Binning::Linear) ||
+                   kind == static_cast<std::uint8_t>(Binning::Logarithmic)) {
+            const Q lo(in.f64() * f);
+            const Q hi(in.f64() * f);
+            // Each of the bins + 3 counts takes at least one varint byte;
+            // check before allocating edges and counts for an untrusted size
+            if (static_cast<std::size_t>(bins) + 3 > in.remaining()) {
+                throw std::invalid_argument("Truncated binary data");
+            }
+            h = kind == static_cast<std::uint8_t>(Binning::Linear) ? linear(lo, hi, bins)
+                                                                   : logarithmic(lo, hi, bins);
+        } else {
+            throw std::invalid_argument("Unknown histogram binning");
+        }
+        for (std::uint64_t& c : h.counts_) {
+            c = in.varint();
+        }
+        if (in.remaining() != 0) {
+            throw std::invalid_argument("Trailing bytes after histogram");
+        }
+        return h;
+    }
+
+private:
+    Binning binning_;
+    std::vector<double> edges_;          // bins + 1
+    std::vector<std::uint64_t> counts_;  // underflow, bins..., overflow, nan
+    double scale_ = 0.0;                 // closed-form index: g(v) * scale_ + offset_
+    double offset_ = 0.0;
+
+    Histogram(Binning binning, std::size_t bins)
+        : binning_(binning), edges_(bins + 1), counts_(bins + 3, 0) {}
+
+    static void check_range(double lo, double hi, std::size_t bins) {
+        if (bins == 0 || bins > std::numeric_limits<std::uint32_t>::max() - 3) {
+            throw std::invalid_argument("Invalid histogram bin count");
+        }
+        if (!std::isfinite(lo) || !std::isfinite(hi) || !(lo < hi)) {
+            throw std::invalid_argument("Histogram range must be finite with lo < hi");
+        }
+    }
+
+    // Slot s holds values with exactly s edges <= v: 0 is underflow,
+    // 1..bins the bins, bins + 1 overflow; NaN goes to bins + 2.
+    void compute_slots(const double* x, double f, double* v, std::uint32_t* slot,
+                       std::size_t m) const {
+        const std::size_t nb = bins();
+        const double top = static_cast<double>(nb);
+        const double* e = edges_.data();
+        const double a = scale_;
+        const double b = offset_;
+        const std::uint32_t nan_slot = static_cast<std::uint32_t>(nb + 2);
+
+        if (binning_ == Binning::Custom) {
+            QTTY_SIMD_LOOP
+            for (std::size_t i = 0; i < m; ++i) {
+                v[i] = x[i] * f;
+            }
+            for (std::size_t i = 0; i < m; ++i) {
+                const std::uint32_t s = static_cast<std::uint32_t>(
+                    detail::edges_at_or_below(e, nb + 1, v[i]));
+                slot[i] = v[i] == v[i] ? s : nan_slot;
+            }
+            return;
+        }
+
+        const bool is_log = binning_ == Binning::Logarithmic;
+        QTTY_SIMD_LOOP
+        for (std::size_t i = 0; i < m; ++i) {
+            const double vi = x[i] * f;
+            v[i] = vi;
+            double pos = (is_log ? std::log(vi > 0.0 ? vi : 1.0) : vi) * a + b;
+            // Clamp to [-1, bins]; NaN and non-positive log input fall to -1
+            // and NaN is flagged below
+            pos = pos >= -1.0 && !(is_log && !(vi > 0.0)) ? pos : -1.0;
+            pos = pos <= top ? pos : top;
+            const std::uint32_t s = static_cast<std::uint32_t>(static_cast<std::int64_t>(std::floor(pos)) + 1);
+            slot[i] = vi == vi ? s : nan_slot;
+        }
+        // Exact membership against the stored edges
+        for (std::size_t i = 0; i < m; ++i) {
+            std::uint32_t s = slot[i];
+            if (s == nan_slot) {
+                continue;
+            }
+            while (s > 0 && v[i] < e[s - 1]) {
+                --s;
+            }
+            while (s <= nb && v[i] >= e[s]) {
+                ++s;
+            }
+            slot[i] = s;
+        }
+    }
+};
+
+namespace batch {
+
+// Fill `hist` from values[0, n) with one shard per thread, merged in order
+template<typename Q, typename Tag>
+void fill(Histogram<Q>& hist, const Quantity<Tag>* values, std::size_t n, unsigned threads = 0) {
+    const unsigned workers = detail::worker_count(n, threads);
+    if (workers <= 1) {
+        hist.fill(values, n);
+        return;
+    }
+    Histogram<Q> empty = hist;
+    empty.clear();
+    std::vector<Histogram<Q>> shards(workers, empty);
+    const std::size_t chunk = (n + workers - 1) / workers;
+    detail::parallel_for(workers, workers, [&](std::size_t wb, std::size_t we) {
+        for (std::size_t w = wb; w < we; ++w) {
+            const std::size_t begin = std::min(n, w * chunk);
+            const std::size_t end = std::min(n, begin + chunk);
+            shards[w].fill(values + begin, end - begin);
+        }
+    }, 1);
+    for (const auto& s : shards) {
+        hist.merge(s);
+    }
+}
+
+} // namespace batch
+
+} // namespace qtty
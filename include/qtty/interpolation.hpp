@@ -0,0 +1,360 @@
+#pragma once
+
+/**
+ * @file interpolation.hpp
+ * @brief Lookup tables with typed axes and linear / cubic interpolation
+ *
+ * LookupTable<X, Y> maps an X quantity to a Y quantity, e.g. a calibration
+ * curve from Second to Watt. Two kinds of grid are supported:
+ * - uniform(first, last, ys, n): evenly spaced knots; the segment index
+ *   comes directly from the position.
+ * - from_points(xs, ys, n): any strictly increasing knots; the segment is
+ *   found with a branchless binary search.
+ *
+ * Linear interpolation and natural cubic splines (zero second derivative at
+ * both ends) share one representation. Each segment stores a cubic in its
+ * local coordinate t in [0, 1], so evaluation is a segment lookup plus a
+ * Horner step. Outside the knots the table either clamps to the end values
+ * (Extrapolation::Clamp) or returns NaN (Extrapolation::Nan). NaN input
+ * always gives NaN.
+ *
+ * for_unit<XTag, YTag>() binds the table to a query and result unit. The
+ * unit conversion is folded into the grid once, at bind time:
+ * - uniform grids get a rescaled position scale and offset;
+ * - non-uniform grids get knots and inverse widths in the query unit;
+ * - the result scale is one multiply.
+ * The evaluator's eval() is then a flat loop over raw doubles with no
+ * per-element conversion. A LookupEvaluator shares the table's immutable
+ * coefficients, so it stays valid when the table is moved or destroyed.
+ *
+ * Usage example:
+ * @code
+ * auto curve = LookupTable<Second, Watt>::from_points(t.data(), p.data(), t.size(),
+ *                                                     Interpolation::Cubic);
+ * Watt w = curve(Millisecond(250.0));
+ *
+ * auto in_ms = curve.for_unit<MillisecondTag, MilliwattTag>();
+ * in_ms.eval(samples.data(), power_mw.data(), samples.size());
+ * @endcode
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ffi_core.hpp"
+#include "detail/simd.hpp"
+
+namespace qtty {
+
+enum class Interpolation {
+    Linear,
+    Cubic  // natural cubic spline
+};
+
+enum class Extrapolation {
+    Clamp,  // hold the end values
+    Nan
+};
+
+namespace detail {
+
+// Segment j: y(t) = a[j] + t * (b[j] + t * (c[j] + t * d[j])), t in [0, 1]
+struct InterpSegments {
+    std::vector<double> a, b, c, d;
+};
+
+// Grid bound to one query unit
+struct InterpGrid {
+    bool uniform = true;
+    double scale = 0.0;         // uniform: position = x * scale + offset
+    double offset = 0.0;
+    std::vector<double> knots;  // non-uniform
+    std::vector<double> inv_h;
+};
+
+inline InterpSegments build_segments(const std::vector<double>& x, const std::vector<double>& y,
+                                     Interpolation method) {
+    const std::size_t n = y.size();
+    const std::size_t segs = n - 1;
+    InterpSegments s;
+    s.a.assign(y.begin(), y.end() - 1);
+    s.b.resize(segs);
+    s.c.assign(segs, 0.0);
+    s.d.assign(segs, 0.0);
+    for (std::size_t j = 0; j < segs; ++j) {
+        s.b[j] = y[j + 1] - y[j];
+    }
+    if (method == Interpolation::Linear || n < 3) {
+        return s;
+    }
+
+    // Second derivatives M of the natural spline (Thomas algorithm)
+    std::vector<double> m(n, 0.0), cp(n, 0.0), dp(n, 0.0);
+    for (std::size_t i = 1; i + 1 < n; ++i) {
+        const double h0 = x[i] - x[i - 1];
+        const double h1 = x[i + 1] - x[i];
+        const double rhs = 6.0 * ((y[i + 1] - y[i]) / h1 - (y[i] - y[i - 1]) / h0);
+        const double diag = 2.0 * (h0 + h1) - h0 * cp[i - 1];
+        cp[i] = h1 / diag;
+        dp[i] = (rhs - h0 * dp[i - 1]) / diag;
+    }
+    for (std::size_t i = n - 2; i >= 1; --i) {
+        m[i] = dp[i] - cp[i] * m[i + 1];
+    }
+    for (std::size_t j = 0; j < segs; ++j) {
+        const double h2 = (x[j + 1] - x[j]) * (x[j + 1] - x[j]);
+        s.b[j] -= h2 * (2.0 * m[j] + m[j + 1]) / 6.0;
+        s.c[j] = h2 * m[j] / 2.0;
+        s.d[j] = h2 * (m[j + 1] - m[j]) / 6.0;
+    }
+    return s;
+}
+
+inline void interp_kernel(const InterpGrid& g, const InterpSegments& s, Extrapolation ext,
+                          double out_scale, const double* x, double* y, std::size_t n) {
+    const std::size_t segs = s.a.size();
+    const double last = static_cast<double>(segs);
+    const double* a = s.a.data();
+    const double* b = s.b.data();
+    const double* c = s.c.data();
+    const double* d = s.d.data();
+    const bool nan_outside = ext == Extrapolation::Nan;
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+
+    if (g.uniform) {
+        const double scale = g.scale;
+        const double offset = g.offset;
+        QTTY_SIMD_LOOP
+        for (std::size_t k = 0; k < n; ++k) {
+            const double pos = x[k] * scale + offset;
+            const bool outside = !(pos >= 0.0 && pos <= last);
+            double p = pos > 0.0 ? pos : 0.0;
+            p = p < last ? p : last;
+            std::size_t j = static_cast<std::size_t>(p);
+            j = j < segs - 1 ? j : segs - 1;
+            const double t = p - static_cast<double>(j);
+            const double v = (a[j] + t * (b[j] + t * (c[j] + t * d[j]))) * out_scale;
+            y[k] = (x[k] != x[k] || (nan_outside && outside)) ? nan : v;
+        }
+        return;
+    }
+
+    const double* knots = g.knots.data();
+    const double* inv_h = g.inv_h.data();
+    const double lo = knots[0];
+    const double hi = knots[segs];
+    for (std::size_t k = 0; k < n; ++k) {
+        const double xk = x[k];
+        // Branchless search for the last knot <= xk among knots[0, segs)
+        const double* base = knots;
+        std::size_t len = segs;
+        while (len > 1) {
+            const std::size_t half = len / 2;
+            base = base[half] <= xk ? base + half : base;
+            len -= half;
+        }
+        const std::size_t j = static_cast<std::size_t>(base - knots);
+        double t = (xk - knots[j]) * inv_h[j];
+        t = t > 0.0 ? t : 0.0;
+        t = t < 1.0 ? t : 1.0;
+        const double v = (a[j] + t * (b[j] + t * (c[j] + t * d[j]))) * out_scale;
+        const bool outside = !(xk >= lo && xk <= hi);
+        y[k] = (xk != xk || (nan_outside && outside)) ? nan : v;
+    }
+}
+
+} // namespace detail
+
+template<typename XTag, typename YTag>
+class LookupEvaluator;
+
+template<typename X, typename Y>
+class LookupTable {
+public:
+    using x_tag = typename X::unit_tag;
+    using y_tag = typename Y::unit_tag;
+
+    // n values at evenly spaced knots from `first` to `last`
+    static LookupTable uniform(const X& first, const X& last, const Y* ys, std::size_t n,
+                               Interpolation method = Interpolation::Linear,
+                               Extrapolation ext = Extrapolation::Clamp) {
+        check_count(n);
+        const double x0 = first.value();
+        const double x1 = last.value();
+        if (!std::isfinite(x0) || !std::isfinite(x1) || !(x0 < x1)) {
+            throw std::invalid_argument("Lookup table range must be finite with first < last");
+        }
+        std::vector<double> x(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            x[i] = x0 + (x1 - x0) * (static_cast<double>(i) / static_cast<double>(n - 1));
+        }
+        x[n - 1] = x1;
+        LookupTable t(std::move(x), ys, n, method, ext);
+        t.grid_.uniform = true;
+        t.grid_.scale = static_cast<double>(n - 1) / (x1 - x0);
+        t.grid_.offset = -x0 * t.grid_.scale;
+        return t;
+    }
+
+    // Knots xs must be finite and strictly increasing
+    static LookupTable from_points(const X* xs, const Y* ys, std::size_t n,
+                                   Interpolation method = Interpolation::Linear,
+                                   Extrapolation ext = Extrapolation::Clamp) {
+        check_count(n);
+        std::vector<double> x(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            x[i] = xs[i].value();
+            if (!std::isfinite(x[i]) || (i > 0 && !(x[i] > x[i - 1]))) {
+                throw std::invalid_argument("Lookup table knots must be finite and strictly increasing");
+            }
+        }
+        LookupTable t(std::move(x), ys, n, method, ext);
+        t.grid_.uniform = false;
+        t.grid_.knots = t.x_;
+        t.grid_.inv_h.resize(n - 1);
+        for (std::size_t j = 0; j + 1 < n; ++j) {
+            t.grid_.inv_h[j] = 1.0 / (t.x_[j + 1] - t.x_[j]);
+        }
+        return t;
+    }
+
+    std::size_t size() const {
+        return x_.size();
+    }
+
+    bool is_uniform() const {
+        return grid_.uniform;
+    }
+
+    Interpolation interpolation() const {
+        return method_;
+    }
+
+    Extrapolation extrapolation() const {
+        return ext_;
+    }
+
+    X knot(std::size_t i) const {
+        return X(x_.at(i));
+    }
+
+    Y value(std::size_t i) const {
+        return Y(y_.at(i));
+    }
+
+    template<typename Tag>
+    Y operator()(const Quantity<Tag>& x) const {
+        Y out;
+        eval(&x, &out, 1);
+        return out;
+    }
+
+    // out[i] = table(xs[i]) for any X-compatible input unit
+    template<typename Tag>
+    void eval(const Quantity<Tag>* xs, Y* out, std::size_t n) const {
+        if constexpr (std::is_same<Tag, x_tag>::value) {
+            detail::interp_kernel(grid_, *seg_, ext_, 1.0, detail::raw(xs), detail::raw(out), n);
+        } else if (grid_.uniform) {
+            for_unit<Tag, y_tag>().eval(xs, out, n);
+        } else {
+            // Avoid copying the knots for a one-off call: rescale the input
+            const double f = conversion_factor<Tag, x_tag>();
+            const double* x = detail::raw(xs);
+            double* y = detail::raw(out);
+            double buf[kEvalBlock];
+            for (std::size_t base = 0; base < n; base += kEvalBlock) {
+                const std::size_t m = std::min(kEvalBlock, n - base);
+                QTTY_SIMD_LOOP
+                for (std::size_t i = 0; i < m; ++i) {
+                    buf[i] = x[base + i] * f;
+                }
+                detail::interp_kernel(grid_, *seg_, ext_, 1.0, buf, y + base, m);
+            }
+        }
+    }
+
+    // Evaluator with the unit conversions folded into the grid
+    template<typename QueryTag, typename ResultTag = y_tag>
+    LookupEvaluator<QueryTag, ResultTag> for_unit() const {
+        const double f = conversion_factor<QueryTag, x_tag>();
+        const double g = conversion_factor<y_tag, ResultTag>();
+        detail::InterpGrid bound;
+        bound.uniform = grid_.uniform;
+        if (grid_.uniform) {
+            bound.scale = grid_.scale * f;
+            bound.offset = grid_.offset;
+        } else {
+            bound.knots.resize(grid_.knots.size());
+            bound.inv_h.resize(grid_.inv_h.size());
+            for (std::size_t i = 0; i < grid_.knots.size(); ++i) {
+                bound.knots[i] = grid_.knots[i] / f;
+            }
+            for (std::size_t j = 0; j < grid_.inv_h.size(); ++j) {
+                bound.inv_h[j] = grid_.inv_h[j] * f;
+            }
+        }
+        return LookupEvaluator<QueryTag, ResultTag>(std::move(bound), seg_, ext_, g);
+    }
+
+private:
+    static constexpr std::size_t kEvalBlock = 256;
+
+    std::vector<double> x_;
+    std::vector<double> y_;
+    Interpolation method_;
+    Extrapolation ext_;
+    detail::InterpGrid grid_;
+    std::shared_ptr<const detail::InterpSegments> seg_;  // shared with evaluators
+
+    LookupTable(std::vector<double> x, const Y* ys, std::size_t n, Interpolation method,
+                Extrapolation ext)
+        : x_(std::move(x)), y_(n), method_(method), ext_(ext) {
+        for (std::size_t i = 0; i < n; ++i) {
+            y_[i] = ys[i].value();
+        }
+        seg_ = std::make_shared<const detail::InterpSegments>(
+            detail::build_segments(x_, y_, method));
+    }
+
+    static void check_count(std::size_t n) {
+        if (n < 2) {
+            throw std::invalid_argument("Lookup table needs at least two points");
+        }
+    }
+};
+
+template<typename XTag, typename YTag>
+class LookupEvaluator {
+public:
+    Quantity<YTag> operator()(const Quantity<XTag>& x) const {
+        Quantity<YTag> out;
+        eval(&x, &out, 1);
+        return out;
+    }
+
+    void eval(const Quantity<XTag>* xs, Quantity<YTag>* out, std::size_t n) const {
+        detail::interp_kernel(grid_, *seg_, ext_, out_scale_, detail::raw(xs), detail::raw(out), n);
+    }
+
+private:
+    template<typename, typename>
+    friend class LookupTable;
+
+    detail::InterpGrid grid_;
+    std::shared_ptr<const detail::InterpSegments> seg_;
+    Extrapolation ext_;
+    double out_scale_;
+
+    LookupEvaluator(detail::InterpGrid grid, std::shared_ptr<const detail::InterpSegments> seg,
+                    Extrapolation ext, double out_scale)
+        : grid_(std::move(grid)), seg_(std::move(seg)), ext_(ext), out_scale_(out_scale) {}
+};
+
+} // namespace qtty
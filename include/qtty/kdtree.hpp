@@ -0,0 +1,316 @@
+#pragma once
+
+/**
+ * @file kdtree.hpp
+ * @brief Implicit-layout k-d tree over unit-typed 3D positions
+ *
+ * KdTree<Q> indexes positions given as a Vec3Array<Q> (for example
+ * Vec3Array<Meter>). The tree is implicit and stores no child pointers:
+ * - points are reordered so that node i of a complete binary tree (children
+ *   2i+1 and 2i+2) owns a contiguous range;
+ * - every split is at the range midpoint;
+ * - the only per-node data is the split axis (one byte, the axis of widest
+ *   spread) and the split coordinate.
+ *
+ * Leaves hold at most `leaf_size` points. Coordinates are stored as three
+ * columns in tree order, so a leaf scan reads contiguous memory.
+ *
+ * Queries take positions and radii in any unit of the same dimension. The
+ * radius is converted to the tree's unit once per query and the query
+ * point's three components once; the indexed data is never converted.
+ *
+ * Builds proceed level by level, with the nodes of each level partitioned
+ * in parallel. The batch:: queries split the query set across threads.
+ *
+ * Usage example:
+ * @code
+ * KdTree<Meter> tree = KdTree<Meter>::build(positions);
+ * std::vector<std::uint32_t> near = tree.radius_search(probe, Kilometer(1.5));
+ * KdTree<Meter>::Match m = tree.nearest(probe);   // m.index, m.distance
+ *
+ * batch::nearest(tree, probes, index.data(), distance.data());
+ * @endcode
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "ffi_core.hpp"
+#include "vec3.hpp"
+#include "detail/parallel.hpp"
+#include "detail/simd.hpp"
+
+namespace qtty {
+
+struct KdTreeOptions {
+    std::size_t leaf_size = 16;  // maximum points per leaf
+    unsigned threads = 0;        // 0 = one per hardware thread
+};
+
+template<typename Q>
+class KdTree {
+public:
+    using unit_tag = typename Q::unit_tag;
+
+    struct Match {
+        std::uint32_t index;
+        Q distance;
+    };
+
+    KdTree() = default;
+
+    static KdTree build(const Vec3Array<Q>& points, const KdTreeOptions& opts = KdTreeOptions());
+
+    std::size_t size() const {
+        return ids_.size();
+    }
+
+    // Indices of points within `radius` of `center`, in tree order
+    template<typename CenterTag, typename RadiusTag>
+    void radius_search(const Vec3<Quantity<CenterTag>>& center, const Quantity<RadiusTag>& radius,
+                       std::vector<std::uint32_t>& out) const {
+        const Query q = make_query(center);
+        const double r = radius.value() * conversion_factor<RadiusTag, unit_tag>();
+        if (ids_.empty() || r < 0.0) {
+            return;
+        }
+        radius_rec(q, r * r, 0, 0, 0, ids_.size(), out);
+    }
+
+    template<typename CenterTag, typename RadiusTag>
+    std::vector<std::uint32_t> radius_search(const Vec3<Quantity<CenterTag>>& center,
+                                             const Quantity<RadiusTag>& radius) const {
+        std::vector<std::uint32_t> out;
+        radius_search(center, radius, out);
+        return out;
+    }
+
+    // Closest point; throws std::out_of_range on an empty tree
+    template<typename CenterTag>
+    Match nearest(const Vec3<Quantity<CenterTag>>& center) const {
+        if (ids_.empty()) {
+            throw std::out_of_range("KdTree::nearest on an empty tree");
+        }
+        const Query q = make_query(center);
+        double best_d2 = std::numeric_limits<double>::infinity();
+        std::size_t best = 0;
+        nearest_rec(q, 0, 0, 0, ids_.size(), best_d2, best);
+        return {ids_[best], Q(std::sqrt(best_d2))};
+    }
+
+private:
+    struct Query {
+        double p[3];
+    };
+
+    int depth_ = 0;                      // depth of the leaf level
+    std::vector<std::uint8_t> axis_;     // split axis per internal node (heap order)
+    std::vector<double> split_;          // split coordinate per internal node
+    std::vector<double> coords_[3];      // reordered coordinates, tree unit
+    std::vector<std::uint32_t> ids_;     // input index per reordered point
+
+    template<typename CenterTag>
+    static Query make_query(const Vec3<Quantity<CenterTag>>& c) {
+        const double f = conversion_factor<CenterTag, unit_tag>();
+        return {{c.x.value() * f, c.y.value() * f, c.z.value() * f}};
+    }
+
+    double dist2(const Query& q, std::size_t i) const {
+        const double dx = coords_[0][i] - q.p[0];
+        const double dy = coords_[1][i] - q.p[1];
+        const double dz = coords_[2][i] - q.p[2];
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    void radius_rec(const Query& q, double r2, std::size_t node, int level,
+                    std::size_t lo, std::size_t hi, std::vector<std::uint32_t>& out) const {
+        if (lo == hi) {
+            return;
+        }
+        if (level == depth_) {
+            const double* x = coords_[0].data();
+            const double* y = coords_[1].data();
+            const double* z = coords_[2].data();
+            for (std::size_t i = lo; i < hi; ++i) {
+                const double dx = x[i] - q.p[0];
+                const double dy = y[i] - q.p[1];
+                const double dz = z[i] - q.p[2];
+                if (dx * dx + dy * dy + dz * dz <= r2) {
+                    out.push_back(ids_[i]);
+                }
+            }
+            return;
+        }
+        const std::size_t mid = lo + (hi - lo) / 2;
+        const int a = axis_[node];
+        const double diff = q.p[a] - split_[node];
+        // Left holds coordinates <= split, right holds coordinates >= split
+        if (diff <= 0.0 || diff * diff <= r2) {
+            radius_rec(q, r2, 2 * node + 1, level + 1, lo, mid, out);
+        }
+        if (diff >= 0.0 || diff * diff <= r2) {
+            radius_rec(q, r2, 2 * node + 2, level + 1, mid, hi, out);
+        }
+    }
+
+    void nearest_rec(const Query& q, std::size_t node, int level, std::size_t lo,
+                     std::size_t hi, double& best_d2, std::size_t& best) const {
+        if (lo == hi) {
+            return;
+        }
+        if (level == depth_) {
+            for (std::size_t i = lo; i < hi; ++i) {
+                const double d2 = dist2(q, i);
+                if (d2 < best_d2 || (d2 == best_d2 && ids_[i] < ids_[best])) {
+                    best_d2 = d2;
+                    best = i;
+                }
+            }
+            return;
+        }
+        const std::size_t mid = lo + (hi - lo) / 2;
+        const int a = axis_[node];
+        const double diff = q.p[a] - split_[node];
+        if (diff < 0.0) {
+            nearest_rec(q, 2 * node + 1, level + 1, lo, mid, best_d2, best);
+            if (diff * diff <= best_d2) {
+                nearest_rec(q, 2 * node + 2, level + 1, mid, hi, best_d2, best);
+            }
+        } else {
+            nearest_rec(q, 2 * node + 2, level + 1, mid, hi, best_d2, best);
+            if (diff * diff <= best_d2) {
+                nearest_rec(q, 2 * node + 1, level + 1, lo, mid, best_d2, best);
+            }
+        }
+    }
+};
+
+template<typename Q>
+KdTree<Q> KdTree<Q>::build(const Vec3Array<Q>& points, const KdTreeOptions& opts) {
+    const std::size_t n = points.size();
+    if (n > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::invalid_argument("KdTree supports at most 2^32 - 1 points");
+    }
+    const std::size_t leaf = std::max<std::size_t>(1, opts.leaf_size);
+
+    KdTree tree;
+    // Midpoint splits leave ranges of at most ceil(n / 2^depth) points
+    while (((n + (std::size_t{1} << tree.depth_) - 1) >> tree.depth_) > leaf) {
+        ++tree.depth_;
+    }
+    tree.axis_.assign((std::size_t{1} << tree.depth_) - 1, 0);
+    tree.split_.assign(tree.axis_.size(), 0.0);
+
+    const double* src[3] = {detail::raw(points.x()), detail::raw(points.y()),
+                            detail::raw(points.z())};
+    std::vector<std::uint32_t> perm(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        perm[i] = static_cast<std::uint32_t>(i);
+    }
+
+    for (int level = 0; level < tree.depth_; ++level) {
+        const std::size_t first = (std::size_t{1} << level) - 1;
+        const std::size_t count = std::size_t{1} << level;
+        detail::parallel_for(count, opts.threads, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t k = begin; k < end; ++k) {
+                // Range of node k on this level under repeated midpoint splits
+                std::size_t lo = 0, hi = n;
+                for (int b = level - 1; b >= 0; --b) {
+                    const std::size_t mid = lo + (hi - lo) / 2;
+                    if ((k >> b) & 1) {
+                        lo = mid;
+                    } else {
+                        hi = mid;
+                    }
+                }
+                if (hi - lo < 2) {
+                    // At most one point, always in the right child
+                    tree.split_[first + k] = -std::numeric_limits<double>::infinity();
+                    continue;
+                }
+                double lo_c[3], hi_c[3];
+                for (int a = 0; a < 3; ++a) {
+                    lo_c[a] = std::numeric_limits<double>::infinity();
+                    hi_c[a] = -std::numeric_limits<double>::infinity();
+                }
+                for (std::size_t i = lo; i < hi; ++i) {
+                    for (int a = 0; a < 3; ++a) {
+                        const double v = src[a][perm[i]];
+                        lo_c[a] = std::min(lo_c[a], v);
+                        hi_c[a] = std::max(hi_c[a], v);
+                    }
+                }
+                int axis = 0;
+                for (int a = 1; a < 3; ++a) {
+                    if (hi_c[a] - lo_c[a] > hi_c[axis] - lo_c[axis]) {
+                        axis = a;
+                    }
+                }
+                tree.axis_[first + k] = static_cast<std::uint8_t>(axis);
+                const double* c = src[axis];
+                const std::size_t mid = lo + (hi - lo) / 2;
+                std::nth_element(perm.begin() + lo, perm.begin() + mid, perm.begin() + hi,
+                                 [c](std::uint32_t p, std::uint32_t q) { return c[p] < c[q]; });
+                // Deeper levels reorder the range, so keep the value itself
+                tree.split_[first + k] = c[perm[mid]];
+            }
+        }, 1);
+    }
+
+    for (int a = 0; a < 3; ++a) {
+        tree.coords_[a].resize(n);
+    }
+    tree.ids_ = std::move(perm);
+    detail::parallel_for(n, opts.threads, [&](std::size_t begin, std::size_t end) {
+        for (int a = 0; a < 3; ++a) {
+            double* dst = tree.coords_[a].data();
+            for (std::size_t i = begin; i < end; ++i) {
+                dst[i] = src[a][tree.ids_[i]];
+            }
+        }
+    });
+    return tree;
+}
+
+// ============================================================================
+// Batch Queries
+// ============================================================================
+
+namespace batch {
+
+// index[i], distance[i] = nearest point to queries[i]
+template<typename Q, typename QueryQ, typename DistTag>
+void nearest(const KdTree<Q>& tree, const Vec3Array<QueryQ>& queries, std::uint32_t* index,
+             Quantity<DistTag>* distance, unsigned threads = 0) {
+    const double f = conversion_factor<typename Q::unit_tag, DistTag>();
+    detail::parallel_for(queries.size(), threads, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            const typename KdTree<Q>::Match m = tree.nearest(queries[i]);
+            index[i] = m.index;
+            distance[i] = Quantity<DistTag>(m.distance.value() * f);
+        }
+    }, 256);
+}
+
+// out[i] = indices of points within `radius` of queries[i]
+template<typename Q, typename QueryQ, typename RadiusTag>
+void radius_search(const KdTree<Q>& tree, const Vec3Array<QueryQ>& queries,
+                   const Quantity<RadiusTag>& radius,
+                   std::vector<std::vector<std::uint32_t>>& out, unsigned threads = 0) {
+    out.resize(queries.size());
+    detail::parallel_for(queries.size(), threads, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            out[i].clear();
+            tree.radius_search(queries[i], radius, out[i]);
+        }
+    }, 256);
+}
+
+} // namespace batch
+
+} // namespace qtty
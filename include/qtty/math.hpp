@@ -0,0 +1,511 @@
+#pragma once
+
+/**
+ * @file math.hpp
+ * @brief Dimension-correct math functions for quantities
+ *
+ * Free functions operating on Quantity<Tag> that keep the unit in the type
+ * system instead of unwrapping to double:
+ * - pow<N>, square, cube, sqrt, cbrt, root<N> with tracked unit exponents
+ * - hypot, fma, min, max, clamp, lerp
+ * - floor/ceil/round/trunc in the quantity's own unit, and rounding to a
+ *   multiple of a step or of another unit (floor_to<Minute>(seconds))
+ *
+ * qtty::batch has array counterparts that run a vectorizable kernel over
+ * contiguous quantities for pow<N>, square, sqrt, cbrt, hypot, fma, min,
+ * max, clamp, lerp and floor_to/ceil_to/round_to. cube, root<N>, abs and
+ * floor/ceil/round/trunc are scalar only.
+ *
+ * Usage example:
+ * @code
+ * Meter dx(3.0), dy(4.0), dz(12.0);
+ * Meter d = hypot(dx, dy, dz);            // 13 m
+ * auto area = square(d);                  // Quantity<PowTag<MeterTag, 2>>
+ * Meter side = sqrt(area);                // back to Meter
+ * Second t = floor_to<Minute>(Second(125.0));  // 120 s
+ * @endcode
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+
+#include "ffi_core.hpp"
+#include "units/velocity.hpp"
+#include "detail/simd.hpp"
+
+namespace qtty {
+
+// ============================================================================
+// Unit Exponents
+// ============================================================================
+// PowTag<BaseTag, N> encodes a unit raised to an integer power (m^2, s^3).
+// Like CompoundTag, it has no FFI unit id: such quantities cannot be
+// converted with .to<>(), but they carry the dimension through arithmetic so
+// that sqrt(square(x)) has the type of x again.
+//
+// Exponents are normalized: pow<2>(pow<3>(x)) is PowTag<Tag, 6>, and an
+// exponent of 1 collapses back to the plain tag.
+
+template<typename BaseTag, int Exponent>
+struct PowTag {};
+
+namespace detail {
+
+template<typename Tag>
+struct PowBase {
+    using base = Tag;
+    static constexpr int exponent = 1;
+};
+
+template<typename Tag, int M>
+struct PowBase<PowTag<Tag, M>> {
+    using base = Tag;
+    static constexpr int exponent = M;
+};
+
+template<typename Tag, int Exponent>
+using make_pow_tag = typename std::conditional<
+    Exponent == 1, Tag, PowTag<Tag, Exponent>>::type;
+
+// Tag^N
+template<typename Tag, int N>
+struct PowOf {
+    static constexpr int exponent = PowBase<Tag>::exponent * N;
+    static_assert(exponent != 0, "Zero unit exponent does not produce a quantity");
+    using type = make_pow_tag<typename PowBase<Tag>::base, exponent>;
+};
+
+// Tag^(1/N); only defined when the exponent divides evenly
+template<typename Tag, int N>
+struct RootOf {
+    static_assert(N > 0, "Root degree must be positive");
+    static_assert(PowBase<Tag>::exponent % N == 0,
+                  "Unit exponent is not divisible by the root degree "
+                  "(e.g. sqrt of a plain length has no unit)");
+    using type = make_pow_tag<typename PowBase<Tag>::base,
+                              PowBase<Tag>::exponent / N>;
+};
+
+} // namespace detail
+
+// Quantity type of Q raised to the N-th power
+template<typename Q, int N>
+using PowQuantity = Quantity<typename detail::PowOf<typename Q::unit_tag, N>::type>;
+
+// Quantity type of the N-th root of Q
+template<typename Q, int N>
+using RootQuantity = Quantity<typename detail::RootOf<typename Q::unit_tag, N>::type>;
+
+template<typename Q>
+using Squared = PowQuantity<Q, 2>;
+
+template<typename Q>
+using Cubed = PowQuantity<Q, 3>;
+
+// ============================================================================
+// Powers and Roots
+// ============================================================================
+
+template<int N, typename UnitTag>
+PowQuantity<Quantity<UnitTag>, N> pow(const Quantity<UnitTag>& q) {
+    return PowQuantity<Quantity<UnitTag>, N>(std::pow(q.value(), N));
+}
+
+template<typename UnitTag>
+Squared<Quantity<UnitTag>> square(const Quantity<UnitTag>& q) {
+    return Squared<Quantity<UnitTag>>(q.value() * q.value());
+}
+
+template<typename UnitTag>
+Cubed<Quantity<UnitTag>> cube(const Quantity<UnitTag>& q) {
+    return Cubed<Quantity<UnitTag>>(q.value() * q.value() * q.value());
+}
+
+template<typename UnitTag>
+RootQuantity<Quantity<UnitTag>, 2> sqrt(const Quantity<UnitTag>& q) {
+    return RootQuantity<Quantity<UnitTag>, 2>(std::sqrt(q.value()));
+}
+
+template<typename UnitTag>
+RootQuantity<Quantity<UnitTag>, 3> cbrt(const Quantity<UnitTag>& q) {
+    return RootQuantity<Quantity<UnitTag>, 3>(std::cbrt(q.value()));
+}
+
+template<int N, typename UnitTag>
+RootQuantity<Quantity<UnitTag>, N> root(const Quantity<UnitTag>& q) {
+    if constexpr (N == 2) {
+        return sqrt(q);
+    } else if constexpr (N == 3) {
+        return cbrt(q);
+    } else {
+        return RootQuantity<Quantity<UnitTag>, N>(std::pow(q.value(), 1.0 / N));
+    }
+}
+
+// ============================================================================
+// Hypot and Fused Multiply-Add
+// ============================================================================
+// hypot avoids intermediate overflow/underflow, so it is safe for values such
+// as parsecs expressed in meters. fma computes a*b + c with a single rounding.
+
+template<typename UnitTag>
+Quantity<UnitTag> hypot(const Quantity<UnitTag>& x, const Quantity<UnitTag>& y) {
+    return Quantity<UnitTag>(std::hypot(x.value(), y.value()));
+}
+
+template<typename UnitTag>
+Quantity<UnitTag> hypot(const Quantity<UnitTag>& x, const Quantity<UnitTag>& y,
+                        const Quantity<UnitTag>& z) {
+    return Quantity<UnitTag>(std::hypot(x.value(), y.value(), z.value()));
+}
+
+// a * s + b for a scalar s
+template<typename UnitTag>
+Quantity<UnitTag> fma(const Quantity<UnitTag>& a, double s, const Quantity<UnitTag>& b) {
+    return Quantity<UnitTag>(std::fma(a.value(), s, b.value()));
+}
+
+// x * x + c, e.g. accumulating a sum of squares
+template<typename UnitTag>
+Squared<Quantity<UnitTag>> fma(const Quantity<UnitTag>& a, const Quantity<UnitTag>& b,
+                               const Squared<Quantity<UnitTag>>& c) {
+    return Squared<Quantity<UnitTag>>(std::fma(a.value(), b.value(), c.value()));
+}
+
+// rate * duration + start, e.g. velocity * time + position
+template<typename NumeratorTag, typename DenominatorTag>
+Quantity<NumeratorTag> fma(const Quantity<CompoundTag<NumeratorTag, DenominatorTag>>& rate,
+                           const Quantity<DenominatorTag>& t,
+                           const Quantity<NumeratorTag>& start) {
+    return Quantity<NumeratorTag>(std::fma(rate.value(), t.value(), start.value()));
+}
+
+// ============================================================================
+// Selection and Interpolation
+// ============================================================================
+
+template<typename UnitTag>
+Quantity<UnitTag> abs(const Quantity<UnitTag>& q) {
+    return q.abs();
+}
+
+template<typename UnitTag>
+Quantity<UnitTag> min(const Quantity<UnitTag>& a, const Quantity<UnitTag>& b) {
+    return b < a ? b : a;
+}
+
+template<typename UnitTag>
+Quantity<UnitTag> max(const Quantity<UnitTag>& a, const Quantity<UnitTag>& b) {
+    return a < b ? b : a;
+}
+
+template<typename UnitTag>
+Quantity<UnitTag> clamp(const Quantity<UnitTag>& q, const Quantity<UnitTag>& lo,
+                        const Quantity<UnitTag>& hi) {
+    return q < lo ? lo : (hi < q ? hi : q);
+}
+
+// a + t * (b - a); exact at t == 0 and t == 1
+template<typename UnitTag>
+Quantity<UnitTag> lerp(const Quantity<UnitTag>& a, const Quantity<UnitTag>& b, double t) {
+    return Quantity<UnitTag>(t == 1.0 ? b.value()
+                                      : std::fma(t, b.value() - a.value(), a.value()));
+}
+
+// ============================================================================
+// Rounding
+// ============================================================================
+// floor/ceil/round/trunc operate on the value in the quantity's own unit.
+// The *_to variants round to a multiple of a step of the same unit, or to a
+// whole number of another unit of the same dimension:
+//
+//   floor_to(Second(125.0), Second(60.0))  -> 120 s
+//   round_to<Hour>(Minute(100.0))          -> 120 min
+
+template<typename UnitTag>
+Quantity<UnitTag> floor(const Quantity<UnitTag>& q) {
+    return Quantity<UnitTag>(std::floor(q.value()));
+}
+
+template<typename UnitTag>
+Quantity<UnitTag> ceil(const Quantity<UnitTag>& q) {
+    return Quantity<UnitTag>(std::ceil(q.value()));
+}
+
+template<typename UnitTag>
+Quantity<UnitTag> round(const Quantity<UnitTag>& q) {
+    return Quantity<UnitTag>(std::round(q.value()));
+}
+
+template<typename UnitTag>
+Quantity<UnitTag> trunc(const Quantity<UnitTag>& q) {
+    return Quantity<UnitTag>(std::trunc(q.value()));
+}
+
+template<typename UnitTag>
+Quantity<UnitTag> floor_to(const Quantity<UnitTag>& q, const Quantity<UnitTag>& step) {
+    return Quantity<UnitTag>(std::floor(q.value() / step.value()) * step.value());
+}
+
+template<typename UnitTag>
+Quantity<UnitTag> ceil_to(const Quantity<UnitTag>& q, const Quantity<UnitTag>& step) {
+    return Quantity<UnitTag>(std::ceil(q.value() / step.value()) * step.value());
+}
+
+template<typename UnitTag>
+Quantity<UnitTag> round_to(const Quantity<UnitTag>& q, const Quantity<UnitTag>& step) {
+    return Quantity<UnitTag>(std::round(q.value() / step.value()) * step.value());
+}
+
+template<typename StepUnit, typename UnitTag>
+Quantity<UnitTag> floor_to(const Quantity<UnitTag>& q) {
+    return floor_to(q, Quantity<UnitTag>(conversion_factor<StepUnit, UnitTag>()));
+}
+
+template<typename StepUnit, typename UnitTag>
+Quantity<UnitTag> ceil_to(const Quantity<UnitTag>& q) {
+    return ceil_to(q, Quantity<UnitTag>(conversion_factor<StepUnit, UnitTag>()));
+}
+
+template<typename StepUnit, typename UnitTag>
+Quantity<UnitTag> round_to(const Quantity<UnitTag>& q) {
+    return round_to(q, Quantity<UnitTag>(conversion_factor<StepUnit, UnitTag>()));
+}
+
+// ============================================================================
+// Batch Variants
+// ============================================================================
+// Array forms of the functions above. Inputs and outputs are contiguous
+// arrays of n quantities; out may alias any input. The kernels trade the
+// libm calls for vectorizable arithmetic where that matters, so results are
+// close to but not always bit-identical with the scalar functions:
+// - batch::pow multiplies N times instead of calling std::pow (a few ulp for
+//   large |N|).
+// - batch::hypot uses a scaled sqrt formulation (overflow-safe, within a few
+//   ulp of std::hypot; any infinite input gives +inf, as with std::hypot).
+
+namespace batch {
+
+template<int N, typename UnitTag>
+void pow(const Quantity<UnitTag>* in, PowQuantity<Quantity<UnitTag>, N>* out, std::size_t n) {
+    const double* x = detail::raw(in);
+    double* r = detail::raw(out);
+    QTTY_SIMD_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        double acc = 1.0;
+        for (int k = 0; k < (N < 0 ? -N : N); ++k) {
+            acc *= x[i];
+        }
+        r[i] = N < 0 ? 1.0 / acc : acc;
+    }
+}
+
+template<typename UnitTag>
+void square(const Quantity<UnitTag>* in, Squared<Quantity<UnitTag>>* out, std::size_t n) {
+    const double* x = detail::raw(in);
+    double* r = detail::raw(out);
+    QTTY_SIMD_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        r[i] = x[i] * x[i];
+    }
+}
+
+template<typename UnitTag>
+void sqrt(const Quantity<UnitTag>* in, RootQuantity<Quantity<UnitTag>, 2>* out, std::size_t n) {
+    const double* x = detail::raw(in);
+    double* r = detail::raw(out);
+    QTTY_SIMD_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        r[i] = std::sqrt(x[i]);
+    }
+}
+
+template<typename UnitTag>
+void cbrt(const Quantity<UnitTag>* in, RootQuantity<Quantity<UnitTag>, 3>* out, std::size_t n) {
+    const double* x = detail::raw(in);
+    double* r = detail::raw(out);
+    for (std::size_t i = 0; i < n; ++i) {
+        r[i] = std::cbrt(x[i]);
+    }
+}
+
+template<typename UnitTag>
+void hypot(const Quantity<UnitTag>* x, const Quantity<UnitTag>* y,
+           Quantity<UnitTag>* out, std::size_t n) {
+    const double* a = detail::raw(x);
+    const double* b = detail::raw(y);
+    double* r = detail::raw(out);
+    constexpr double kInf = std::numeric_limits<double>::infinity();
+    QTTY_SIMD_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        const double ax = std::fabs(a[i]);
+        const double ay = std::fabs(b[i]);
+        const double hi = ax < ay ? ay : ax;
+        const double lo = ax < ay ? ax : ay;
+        // inf/inf would turn the ratio into NaN, so infinities bypass it
+        const bool inf = ax == kInf || ay == kInf;
+        const double q = hi > 0.0 && !inf ? lo / hi : 0.0;
+        r[i] = inf ? kInf : hi * std::sqrt(1.0 + q * q);
+    }
+}
+
+template<typename UnitTag>
+void hypot(const Quantity<UnitTag>* x, const Quantity<UnitTag>* y, const Quantity<UnitTag>* z,
+           Quantity<UnitTag>* out, std::size_t n) {
+    const double* a = detail::raw(x);
+    const double* b = detail::raw(y);
+    const double* c = detail::raw(z);
+    double* r = detail::raw(out);
+    constexpr double kInf = std::numeric_limits<double>::infinity();
+    QTTY_SIMD_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        const double ax = std::fabs(a[i]);
+        const double ay = std::fabs(b[i]);
+        const double az = std::fabs(c[i]);
+        const double m = std::max(ax, std::max(ay, az));
+        const bool inf = ax == kInf || ay == kInf || az == kInf;
+        const double d = m > 0.0 && !inf ? m : 1.0;
+        const double qx = ax / d;
+        const double qy = ay / d;
+        const double qz = az / d;
+        r[i] = inf ? kInf : m * std::sqrt(qx * qx + qy * qy + qz * qz);
+    }
+}
+
+// out[i] = a[i] * s + b[i]. Vectorized when the target has hardware FMA
+// (e.g. -mfma / -march=native); otherwise each element goes through libm.
+template<typename UnitTag>
+void fma(const Quantity<UnitTag>* a, double s, const Quantity<UnitTag>* b,
+         Quantity<UnitTag>* out, std::size_t n) {
+    const double* x = detail::raw(a);
+    const double* y = detail::raw(b);
+    double* r = detail::raw(out);
+    QTTY_SIMD_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        r[i] = std::fma(x[i], s, y[i]);
+    }
+}
+
+// out[i] = rate[i] * t[i] + start[i]
+template<typename NumeratorTag, typename DenominatorTag>
+void fma(const Quantity<CompoundTag<NumeratorTag, DenominatorTag>>* rate,
+         const Quantity<DenominatorTag>* t, const Quantity<NumeratorTag>* start,
+         Quantity<NumeratorTag>* out, std::size_t n) {
+    const double* v = detail::raw(rate);
+    const double* dt = detail::raw(t);
+    const double* x0 = detail::raw(start);
+    double* r = detail::raw(out);
+    QTTY_SIMD_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        r[i] = std::fma(v[i], dt[i], x0[i]);
+    }
+}
+
+template<typename UnitTag>
+void min(const Quantity<UnitTag>* a, const Quantity<UnitTag>* b,
+         Quantity<UnitTag>* out, std::size_t n) {
+    const double* x = detail::raw(a);
+    const double* y = detail::raw(b);
+    double* r = detail::raw(out);
+    QTTY_SIMD_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        r[i] = y[i] < x[i] ? y[i] : x[i];
+    }
+}
+
+template<typename UnitTag>
+void max(const Quantity<UnitTag>* a, const Quantity<UnitTag>* b,
+         Quantity<UnitTag>* out, std::size_t n) {
+    const double* x = detail::raw(a);
+    const double* y = detail::raw(b);
+    double* r = detail::raw(out);
+    QTTY_SIMD_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        r[i] = x[i] < y[i] ? y[i] : x[i];
+    }
+}
+
+template<typename UnitTag>
+void clamp(const Quantity<UnitTag>* in, const Quantity<UnitTag>& lo, const Quantity<UnitTag>& hi,
+           Quantity<UnitTag>* out, std::size_t n) {
+    const double* x = detail::raw(in);
+    double* r = detail::raw(out);
+    const double l = lo.value();
+    const double h = hi.value();
+    QTTY_SIMD_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        const double v = x[i] < l ? l : x[i];
+        r[i] = h < v ? h : v;
+    }
+}
+
+template<typename UnitTag>
+void lerp(const Quantity<UnitTag>* a, const Quantity<UnitTag>* b, double t,
+          Quantity<UnitTag>* out, std::size_t n) {
+    const double* x = detail::raw(a);
+    const double* y = detail::raw(b);
+    double* r = detail::raw(out);
+    const bool at_end = t == 1.0;
+    QTTY_SIMD_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        r[i] = at_end ? y[i] : std::fma(t, y[i] - x[i], x[i]);
+    }
+}
+
+template<typename UnitTag>
+void floor_to(const Quantity<UnitTag>* in, const Quantity<UnitTag>& step,
+              Quantity<UnitTag>* out, std::size_t n) {
+    const double* x = detail::raw(in);
+    double* r = detail::raw(out);
+    const double s = step.value();
+    QTTY_SIMD_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        r[i] = std::floor(x[i] / s) * s;
+    }
+}
+
+template<typename UnitTag>
+void ceil_to(const Quantity<UnitTag>* in, const Quantity<UnitTag>& step,
+             Quantity<UnitTag>* out, std::size_t n) {
+    const double* x = detail::raw(in);
+    double* r = detail::raw(out);
+    const double s = step.value();
+    QTTY_SIMD_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        r[i] = std::ceil(x[i] / s) * s;
+    }
+}
+
+template<typename UnitTag>
+void round_to(const Quantity<UnitTag>* in, const Quantity<UnitTag>& step,
+              Quantity<UnitTag>* out, std::size_t n) {
+    const double* x = detail::raw(in);
+    double* r = detail::raw(out);
+    const double s = step.value();
+    QTTY_SIMD_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        r[i] = std::round(x[i] / s) * s;
+    }
+}
+
+template<typename StepUnit, typename UnitTag>
+void floor_to(const Quantity<UnitTag>* in, Quantity<UnitTag>* out, std::size_t n) {
+    floor_to(in, Quantity<UnitTag>(conversion_factor<StepUnit, UnitTag>()), out, n);
+}
+
+template<typename StepUnit, typename UnitTag>
+void ceil_to(const Quantity<UnitTag>* in, Quantity<UnitTag>* out, std::size_t n) {
+    ceil_to(in, Quantity<UnitTag>(conversion_factor<StepUnit, UnitTag>()), out, n);
+}
+
+template<typename StepUnit, typename UnitTag>
+void round_to(const Quantity<UnitTag>* in, Quantity<UnitTag>* out, std::size_t n) {
+    round_to(in, Quantity<UnitTag>(conversion_factor<StepUnit, UnitTag>()), out, n);
+}
+
+} // namespace batch
+
+} // namespace qtty
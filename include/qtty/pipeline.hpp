@@ -0,0 +1,512 @@
+#pragma once
+
+/**
+ * @file pipeline.hpp
+ * @brief Parallel batch pipelines: parse -> validate -> convert -> ... -> sink
+ *
+ * A Pipeline<In, Out> is a chain of named stages. Each stage turns one
+ * batch into another, for example:
+ *     std::vector<std::string> -> std::vector<Meter> -> std::vector<Kilometer>
+ *
+ * run() pulls input batches from a source. Every batch moves through the
+ * stages as an independent task on a work-stealing thread pool. Stages are
+ * connected by bounded lock-free queues, so different batches are in
+ * different stages at the same time. A full queue does not block anyone:
+ * the thread that hit it runs downstream work until there is room. The
+ * number of batches read but not yet delivered to the sink is capped at
+ * queue_capacity x stage count; at the cap the source is not read and the
+ * calling thread runs pending work instead. That bounds how far the source
+ * can get ahead of the slowest stage, including batches parked in the
+ * reorder buffer behind one slow batch.
+ *
+ * Batches reach the sink one at a time, in source order, on whichever
+ * thread finished them. So the sink may keep state without locking. Stage
+ * functions, on the other hand, may run on several batches at once and
+ * must be safe to call concurrently.
+ *
+ * run() returns PipelineStats. For each stage it reports the batches and
+ * elements processed, the time spent in the stage (summed over threads)
+ * and the resulting throughput.
+ *
+ * If a stage, the source or the sink throws, no new batches are read, the
+ * batches already in flight are dropped, and run() rethrows the first
+ * exception.
+ *
+ * Ready-made stages (namespace stages):
+ * - parse<Unit>(): JSON values -> quantities (serialization::from_json_value)
+ * - keep_finite(), keep_between(lo, hi): drop invalid elements (filter.hpp)
+ * - convert<Unit>(): batch::convert
+ * - to_json(): quantities -> JSON values (serialization::to_json_value)
+ * - append_to(vec), accumulate(stats): sinks
+ *
+ * Usage example:
+ * @code
+ * auto p = Pipeline<std::vector<std::string>>()
+ *              .then("parse", stages::parse<Meter>())
+ *              .then("validate", stages::keep_finite())
+ *              .then("convert", stages::convert<Kilometer>());
+ *
+ * RunningStats<Kilometer> stats;
+ * PipelineStats report = p.run(std::move(line_batches), stages::accumulate(stats));
+ * for (const StageStats& s : report.stages) {
+ *     std::cout << s.name << ": " << s.items_per_second() << " items/s\n";
+ * }
+ * @endcode
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "convert.hpp"
+#include "ffi_core.hpp"
+#include "filter.hpp"
+#include "serialization.hpp"
+#include "stats.hpp"
+#include "detail/mpmc_queue.hpp"
+#include "detail/parallel.hpp"
+#include "detail/thread_pool.hpp"
+
+namespace qtty {
+
+struct PipelineOptions {
+    unsigned threads = 0;             // 0 = one per hardware thread
+    std::size_t queue_capacity = 64;  // batches buffered between stages
+};
+
+struct StageStats {
+    std::string name;
+    std::uint64_t batches = 0;
+    std::uint64_t items = 0;  // elements in the stage's output batches
+    double busy_seconds = 0.0;
+
+    double items_per_second() const {
+        return busy_seconds > 0.0 ? static_cast<double>(items) / busy_seconds : 0.0;
+    }
+};
+
+struct PipelineStats {
+    std::vector<StageStats> stages;
+    std::uint64_t batches = 0;
+    double wall_seconds = 0.0;
+};
+
+namespace detail {
+
+// Move-only type-erased batch; the pipeline's types are checked statically
+// by Pipeline::then(), so no runtime type check is needed on access.
+struct BatchBoxBase {
+    virtual ~BatchBoxBase() = default;
+};
+
+template<typename T>
+struct BatchBox : BatchBoxBase {
+    T value;
+    explicit BatchBox(T&& v) : value(std::move(v)) {}
+};
+
+using BoxedBatch = std::unique_ptr<BatchBoxBase>;
+
+template<typename T>
+T& unbox(BoxedBatch& b) {
+    return static_cast<BatchBox<T>*>(b.get())->value;
+}
+
+template<typename T, typename = void>
+struct has_size : std::false_type {};
+
+template<typename T>
+struct has_size<T, decltype(void(std::declval<const T&>().size()))> : std::true_type {};
+
+template<typename T>
+std::uint64_t item_count(const T& batch) {
+    if constexpr (has_size<T>::value) {
+        return static_cast<std::uint64_t>(batch.size());
+    } else {
+        return 1;
+    }
+}
+
+struct ErasedStage {
+    std::string name;
+    // Consumes the input batch; returns the output and its element count
+    std::function<BoxedBatch(BoxedBatch&, std::uint64_t&)> fn;
+};
+
+struct PipelineToken {
+    std::uint64_t seq = 0;
+    BoxedBatch batch;
+};
+
+} // namespace detail
+
+// ============================================================================
+// Pipeline
+// ============================================================================
+
+template<typename In, typename Out = In>
+class Pipeline {
+public:
+    Pipeline() = default;
+
+    // Appends a stage: fn(Out&&) -> NewOut
+    template<typename Fn>
+    auto then(std::string name, Fn fn) const {
+        using Next = typename std::decay<std::invoke_result_t<const Fn&, Out&&>>::type;
+        static_assert(!std::is_void<Next>::value, "Pipeline stages must return a batch");
+        Pipeline<In, Next> next;
+        next.stages_ = stages_;
+        next.stages_.push_back(detail::ErasedStage{
+            std::move(name), [fn = std::move(fn)](detail::BoxedBatch& in, std::uint64_t& items) {
+                Next out = fn(std::move(detail::unbox<Out>(in)));
+                items = detail::item_count(out);
+                return detail::BoxedBatch(new detail::BatchBox<Next>(std::move(out)));
+            }});
+        return next;
+    }
+
+    std::size_t stage_count() const noexcept {
+        return stages_.size();
+    }
+
+    // source(In&) fills the next batch and returns false at the end;
+    // sink(Out&&) receives the results in source order.
+    template<typename Source, typename Sink>
+    PipelineStats run(Source source, Sink sink, const PipelineOptions& opts = {}) const {
+        Execution exec(stages_, opts);
+        return exec.run(source, [&sink](detail::BoxedBatch& b) { sink(std::move(detail::unbox<Out>(b))); });
+    }
+
+    template<typename Sink>
+    PipelineStats run(std::vector<In> batches, Sink sink, const PipelineOptions& opts = {}) const {
+        std::size_t next = 0;
+        return run(
+            [&](In& out) {
+                if (next == batches.size()) {
+                    return false;
+                }
+                out = std::move(batches[next++]);
+                return true;
+            },
+            std::move(sink), opts);
+    }
+
+private:
+    template<typename, typename>
+    friend class Pipeline;
+
+    std::vector<detail::ErasedStage> stages_;
+
+    struct alignas(detail::kCacheLine) StageCounters {
+        std::atomic<std::uint64_t> batches{0};
+        std::atomic<std::uint64_t> items{0};
+        std::atomic<std::int64_t> busy_ns{0};
+    };
+
+    // State of one run(). Queue i feeds stage i; the last stage's output
+    // goes through a reorder buffer to the sink.
+    class Execution {
+    public:
+        Execution(const std::vector<detail::ErasedStage>& stages, const PipelineOptions& opts)
+            : stages_(stages), counters_(stages.size()),
+              max_in_flight_(std::max<std::uint64_t>(1, opts.queue_capacity *
+                                                            std::max<std::size_t>(1, stages.size()))),
+              pool_(std::max(1u, detail::worker_count(~std::size_t{0}, opts.threads, 1) - 1)) {
+            for (std::size_t i = 0; i < stages.size(); ++i) {
+                queues_.push_back(std::make_unique<detail::MpmcQueue<detail::PipelineToken>>(opts.queue_capacity));
+            }
+        }
+
+        template<typename Source, typename Deliver>
+        PipelineStats run(Source& source, Deliver deliver) {
+            deliver_ = deliver;
+            const auto start = std::chrono::steady_clock::now();
+
+            std::uint64_t fed = 0;
+            try {
+                for (;;) {
+                    help_until_in_flight(fed, max_in_flight_ - 1);
+                    if (failed_.load(std::memory_order_acquire)) {
+                        break;
+                    }
+                    In batch{};
+                    if (!source(batch)) {
+                        break;
+                    }
+                    detail::PipelineToken token{fed++, detail::BoxedBatch(new detail::BatchBox<In>(std::move(batch)))};
+                    forward(0, token);
+                }
+            } catch (...) {
+                fail(std::current_exception());
+            }
+
+            // Help until every fed batch has been delivered or dropped
+            help_until_in_flight(fed, 0);
+
+            if (error_) {
+                std::rethrow_exception(error_);
+            }
+            PipelineStats stats;
+            stats.batches = fed;
+            stats.wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            for (std::size_t i = 0; i < stages_.size(); ++i) {
+                StageStats s;
+                s.name = stages_[i].name;
+                s.batches = counters_[i].batches.load();
+                s.items = counters_[i].items.load();
+                s.busy_seconds = static_cast<double>(counters_[i].busy_ns.load()) * 1e-9;
+                stats.stages.push_back(std::move(s));
+            }
+            return stats;
+        }
+
+    private:
+        const std::vector<detail::ErasedStage>& stages_;
+        std::vector<StageCounters> counters_;
+        std::vector<std::unique_ptr<detail::MpmcQueue<detail::PipelineToken>>> queues_;
+        const std::uint64_t max_in_flight_;  // fed but not yet delivered or dropped
+        std::function<void(detail::BoxedBatch&)> deliver_;
+
+        std::atomic<bool> failed_{false};
+        std::mutex error_m_;
+        std::exception_ptr error_;
+
+        // Reorder buffer in front of the sink
+        std::mutex sink_m_;
+        std::map<std::uint64_t, detail::BoxedBatch> reorder_;
+        std::uint64_t next_seq_ = 0;
+
+        std::mutex done_m_;
+        std::condition_variable done_cv_;
+        std::uint64_t done_ = 0;
+
+        // Declared last: workers are joined before the state above goes away
+        detail::WorkStealingPool pool_;
+
+        // Runs pending work on the calling thread until at most `limit` of
+        // the `fed` batches are still undelivered
+        void help_until_in_flight(std::uint64_t fed, std::uint64_t limit) {
+            std::unique_lock<std::mutex> lock(done_m_);
+            while (fed - done_ > limit) {
+                lock.unlock();
+                bool worked = pool_.run_one();
+                for (std::size_t i = 0; i < queues_.size() && !worked; ++i) {
+                    worked = process(i);
+                }
+                lock.lock();
+                if (!worked && fed - done_ > limit) {
+                    done_cv_.wait_for(lock, std::chrono::milliseconds(1));
+                }
+            }
+        }
+
+        void fail(std::exception_ptr e) {
+            std::lock_guard<std::mutex> lock(error_m_);
+            if (!error_) {
+                error_ = e;
+            }
+            failed_.store(true, std::memory_order_release);
+        }
+
+        // Hands a token to stage `stage` (or the sink past the last stage).
+        // While the queue is full, this thread drains it itself.
+        void forward(std::size_t stage, detail::PipelineToken& token) {
+            if (stage == queues_.size()) {
+                finish(token);
+                return;
+            }
+            while (!queues_[stage]->try_push(token)) {
+                process(stage);
+            }
+            pool_.submit([this, stage] { process(stage); });
+        }
+
+        // Runs one queued batch through `stage`; false if the queue was empty
+        bool process(std::size_t stage) {
+            detail::PipelineToken token;
+            if (!queues_[stage]->try_pop(token)) {
+                return false;
+            }
+            if (failed_.load(std::memory_order_acquire)) {
+                token.batch.reset();
+                finish(token);
+                return true;
+            }
+            try {
+                std::uint64_t items = 0;
+                const auto t0 = std::chrono::steady_clock::now();
+                token.batch = stages_[stage].fn(token.batch, items);
+                const auto t1 = std::chrono::steady_clock::now();
+                StageCounters& c = counters_[stage];
+                c.batches.fetch_add(1, std::memory_order_relaxed);
+                c.items.fetch_add(items, std::memory_order_relaxed);
+                c.busy_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count(),
+                                    std::memory_order_relaxed);
+            } catch (...) {
+                fail(std::current_exception());
+                token.batch.reset();
+                finish(token);
+                return true;
+            }
+            forward(stage + 1, token);
+            return true;
+        }
+
+        // Delivers finished tokens to the sink in sequence order. Dropped
+        // tokens (empty batch) only advance the sequence.
+        void finish(detail::PipelineToken& token) {
+            std::uint64_t delivered = 0;
+            {
+                std::lock_guard<std::mutex> lock(sink_m_);
+                reorder_.emplace(token.seq, std::move(token.batch));
+                for (auto it = reorder_.begin(); it != reorder_.end() && it->first == next_seq_;
+                     it = reorder_.erase(it)) {
+                    if (it->second && !failed_.load(std::memory_order_acquire)) {
+                        try {
+                            deliver_(it->second);
+                        } catch (...) {
+                            fail(std::current_exception());
+                        }
+                    }
+                    ++next_seq_;
+                    ++delivered;
+                }
+            }
+            if (delivered != 0) {
+                std::lock_guard<std::mutex> lock(done_m_);
+                done_ += delivered;
+                done_cv_.notify_all();
+            }
+        }
+    };
+};
+
+// ============================================================================
+// Ready-Made Stages
+// ============================================================================
+
+namespace stages {
+
+namespace detail {
+
+template<typename TargetTag>
+struct parse_fn {
+    std::vector<Quantity<TargetTag>> operator()(std::vector<std::string>&& json) const {
+        std::vector<Quantity<TargetTag>> out(json.size());
+        for (std::size_t i = 0; i < json.size(); ++i) {
+            out[i] = serialization::from_json_value<TargetTag>(json[i]);
+        }
+        return out;
+    }
+};
+
+template<typename TargetTag>
+struct convert_fn {
+    template<typename SourceTag>
+    std::vector<Quantity<TargetTag>> operator()(std::vector<Quantity<SourceTag>>&& in) const {
+        if constexpr (std::is_same<SourceTag, TargetTag>::value) {
+            return std::move(in);
+        } else {
+            std::vector<Quantity<TargetTag>> out(in.size());
+            batch::convert(in.data(), out.data(), in.size());
+            return out;
+        }
+    }
+};
+
+// Keeps the elements whose mask bit is set, in place
+template<typename Q>
+std::vector<Q> compress_in_place(std::vector<Q>&& v, const std::vector<std::uint64_t>& mask) {
+    v.resize(batch::compress(v.data(), mask.data(), v.size(), v.data()));
+    return std::move(v);
+}
+
+struct keep_finite_fn {
+    template<typename Tag>
+    std::vector<Quantity<Tag>> operator()(std::vector<Quantity<Tag>>&& in) const {
+        std::vector<std::uint64_t> mask(mask_words(in.size()));
+        batch::is_finite(in.data(), in.size(), mask.data());
+        return compress_in_place(std::move(in), mask);
+    }
+};
+
+template<typename LoTag, typename HiTag>
+struct keep_between_fn {
+    Quantity<LoTag> lo;
+    Quantity<HiTag> hi;
+
+    template<typename Tag>
+    std::vector<Quantity<Tag>> operator()(std::vector<Quantity<Tag>>&& in) const {
+        std::vector<std::uint64_t> mask(mask_words(in.size()));
+        batch::between(in.data(), in.size(), lo, hi, mask.data());
+        return compress_in_place(std::move(in), mask);
+    }
+};
+
+struct to_json_fn {
+    template<typename Tag>
+    std::vector<std::string> operator()(std::vector<Quantity<Tag>>&& in) const {
+        std::vector<std::string> out(in.size());
+        for (std::size_t i = 0; i < in.size(); ++i) {
+            out[i] = serialization::to_json_value(in[i]);
+        }
+        return out;
+    }
+};
+
+} // namespace detail
+
+// std::vector<std::string> of JSON numbers in Unit -> std::vector<Quantity<Unit>>
+template<typename Unit>
+detail::parse_fn<typename ExtractTag<Unit>::type> parse() {
+    return {};
+}
+
+// Drops NaN and infinite elements
+inline detail::keep_finite_fn keep_finite() {
+    return {};
+}
+
+// Keeps lo <= v <= hi; the bounds may be in any unit of the batch's dimension
+template<typename LoTag, typename HiTag>
+detail::keep_between_fn<LoTag, HiTag> keep_between(const Quantity<LoTag>& lo, const Quantity<HiTag>& hi) {
+    return {lo, hi};
+}
+
+template<typename Unit>
+detail::convert_fn<typename ExtractTag<Unit>::type> convert() {
+    return {};
+}
+
+inline detail::to_json_fn to_json() {
+    return {};
+}
+
+// Sink appending every element of every batch to `out`
+template<typename T>
+auto append_to(std::vector<T>& out) {
+    return [&out](std::vector<T>&& batch) { out.insert(out.end(), batch.begin(), batch.end()); };
+}
+
+// Sink folding every batch into `stats`
+template<typename Q>
+auto accumulate(RunningStats<Q>& stats) {
+    return [&stats](std::vector<Q>&& batch) { stats.push(batch.data(), batch.size()); };
+}
+
+} // namespace stages
+
+} // namespace qtty
@@ -0,0 +1,256 @@
+#pragma once
+
+/**
+ * @file reduce.hpp
+ * @brief Accurate and reproducible sum / mean / dot over quantity arrays
+ *
+ * Summation methods:
+ * - SumMethod::Naive: plain summation in 8 independent lanes. Fastest, and
+ *   the error grows with n like std::accumulate's.
+ * - SumMethod::Neumaier (default): lane-wise compensated (Kahan-Babuska)
+ *   summation. The error does not grow with n.
+ * - SumMethod::Pairwise: recursive halving over 8-lane naive leaves. The
+ *   error grows like log n, at close to naive speed.
+ * - SumMethod::Reproducible: fixed 4096-element blocks, each summed with
+ *   the Neumaier kernel, then combined along a fixed binary tree over block
+ *   index. The result is bit-identical for any thread count and any SIMD
+ *   width the compiler picks, since lanes are explicit and only additions
+ *   are involved. It is not preserved under -ffast-math.
+ *
+ * The other methods split the array into one chunk per thread, so their
+ * last bits may change with the thread count.
+ *
+ * dot() sums the rounded products with the chosen method. For Q x Q the
+ * result type is Squared<Q>; weighting by plain doubles returns Q.
+ *
+ * Usage example:
+ * @code
+ * Watt total = batch::sum(power.data(), power.size());
+ *
+ * ReduceOptions opts;
+ * opts.method = SumMethod::Reproducible;
+ * Parsec mean_d = batch::mean(dist.data(), dist.size(), opts);
+ * Squared<Meter> ss = batch::dot(x.data(), x.data(), x.size(), opts);
+ * @endcode
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "ffi_core.hpp"
+#include "math.hpp"
+#include "detail/parallel.hpp"
+#include "detail/simd.hpp"
+
+namespace qtty {
+
+enum class SumMethod {
+    Naive,
+    Neumaier,
+    Pairwise,
+    Reproducible
+};
+
+struct ReduceOptions {
+    SumMethod method = SumMethod::Neumaier;
+    unsigned threads = 0;  // 0 = one per hardware thread
+};
+
+namespace detail {
+
+inline constexpr std::size_t kReduceLanes = 8;
+inline constexpr std::size_t kReproducibleBlock = 4096;
+inline constexpr std::size_t kPairwiseLeaf = 256;
+
+// Unevaluated sum hi + lo
+struct CompensatedSum {
+    double hi = 0.0;
+    double lo = 0.0;
+
+    double value() const {
+        return hi + lo;
+    }
+};
+
+// Knuth two-sum: a + b = s + e exactly
+inline CompensatedSum two_sum(double a, double b) {
+    const double s = a + b;
+    const double bb = s - a;
+    return {s, (a - (s - bb)) + (b - bb)};
+}
+
+inline CompensatedSum combine(const CompensatedSum& a, const CompensatedSum& b) {
+    CompensatedSum r = two_sum(a.hi, b.hi);
+    r.lo += a.lo + b.lo;
+    return r;
+}
+
+// Element access: either x[i] or x[i] * y[i]
+struct PlainTerms {
+    const double* x;
+    double operator()(std::size_t i) const {
+        return x[i];
+    }
+};
+
+struct ProductTerms {
+    const double* x;
+    const double* y;
+    double operator()(std::size_t i) const {
+        return x[i] * y[i];
+    }
+};
+
+template<typename Terms>
+double naive_sum(const Terms& t, std::size_t begin, std::size_t end) {
+    double acc[kReduceLanes] = {};
+    const std::size_t n = end - begin;
+    const std::size_t whole = n - n % kReduceLanes;
+    for (std::size_t i = 0; i < whole; i += kReduceLanes) {
+        QTTY_SIMD_LOOP
+        for (std::size_t l = 0; l < kReduceLanes; ++l) {
+            acc[l] += t(begin + i + l);
+        }
+    }
+    for (std::size_t i = whole; i < n; ++i) {
+        acc[i - whole] += t(begin + i);
+    }
+    double s = 0.0;
+    for (std::size_t l = 0; l < kReduceLanes; ++l) {
+        s += acc[l];
+    }
+    return s;
+}
+
+template<typename Terms>
+CompensatedSum neumaier_sum(const Terms& t, std::size_t begin, std::size_t end) {
+    double s[kReduceLanes] = {}, c[kReduceLanes] = {};
+    const std::size_t n = end - begin;
+    const std::size_t whole = n - n % kReduceLanes;
+    for (std::size_t i = 0; i < whole; i += kReduceLanes) {
+        QTTY_SIMD_LOOP
+        for (std::size_t l = 0; l < kReduceLanes; ++l) {
+            const double v = t(begin + i + l);
+            const double sum = s[l] + v;
+            c[l] += std::fabs(s[l]) >= std::fabs(v) ? (s[l] - sum) + v : (v - sum) + s[l];
+            s[l] = sum;
+        }
+    }
+    for (std::size_t i = whole; i < n; ++i) {
+        const std::size_t l = i - whole;
+        const double v = t(begin + i);
+        const double sum = s[l] + v;
+        c[l] += std::fabs(s[l]) >= std::fabs(v) ? (s[l] - sum) + v : (v - sum) + s[l];
+        s[l] = sum;
+    }
+    CompensatedSum r;
+    for (std::size_t l = 0; l < kReduceLanes; ++l) {
+        r = combine(r, {s[l], c[l]});
+    }
+    return r;
+}
+
+template<typename Terms>
+double pairwise_sum(const Terms& t, std::size_t begin, std::size_t end) {
+    if (end - begin <= kPairwiseLeaf) {
+        return naive_sum(t, begin, end);
+    }
+    const std::size_t mid = begin + (end - begin) / 2;
+    return pairwise_sum(t, begin, mid) + pairwise_sum(t, mid, end);
+}
+
+template<typename Terms>
+CompensatedSum chunk_sum(const Terms& t, std::size_t begin, std::size_t end, SumMethod method) {
+    switch (method) {
+        case SumMethod::Naive:
+            return {naive_sum(t, begin, end), 0.0};
+        case SumMethod::Pairwise:
+            return {pairwise_sum(t, begin, end), 0.0};
+        default:
+            return neumaier_sum(t, begin, end);
+    }
+}
+
+template<typename Terms>
+double reduce_terms(const Terms& t, std::size_t n, const ReduceOptions& opts) {
+    if (n == 0) {
+        return 0.0;
+    }
+    if (opts.method == SumMethod::Reproducible) {
+        const std::size_t blocks = (n + kReproducibleBlock - 1) / kReproducibleBlock;
+        std::vector<CompensatedSum> partial(blocks);
+        parallel_for(blocks, opts.threads, [&](std::size_t bb, std::size_t be) {
+            for (std::size_t b = bb; b < be; ++b) {
+                const std::size_t begin = b * kReproducibleBlock;
+                partial[b] = neumaier_sum(t, begin, std::min(n, begin + kReproducibleBlock));
+            }
+        }, kMinItemsPerThread / kReproducibleBlock);
+        // Fixed tree: combine neighbours at stride 1, 2, 4, ...
+        for (std::size_t stride = 1; stride < blocks; stride *= 2) {
+            for (std::size_t b = 0; b + stride < blocks; b += 2 * stride) {
+                partial[b] = combine(partial[b], partial[b + stride]);
+            }
+        }
+        return partial[0].value();
+    }
+
+    const unsigned workers = worker_count(n, opts.threads);
+    std::vector<CompensatedSum> partial(workers);
+    const std::size_t chunk = (n + workers - 1) / workers;
+    parallel_for(workers, workers, [&](std::size_t wb, std::size_t we) {
+        for (std::size_t w = wb; w < we; ++w) {
+            const std::size_t begin = std::min(n, w * chunk);
+            const std::size_t end = std::min(n, begin + chunk);
+            partial[w] = chunk_sum(t, begin, end, opts.method);
+        }
+    }, 1);
+    CompensatedSum total;
+    for (const auto& p : partial) {
+        total = opts.method == SumMethod::Naive ? CompensatedSum{total.hi + p.hi, 0.0}
+                                                : combine(total, p);
+    }
+    return total.value();
+}
+
+} // namespace detail
+
+namespace batch {
+
+template<typename UnitTag>
+Quantity<UnitTag> sum(const Quantity<UnitTag>* values, std::size_t n,
+                      const ReduceOptions& opts = ReduceOptions()) {
+    return Quantity<UnitTag>(detail::reduce_terms(detail::PlainTerms{detail::raw(values)}, n, opts));
+}
+
+// NaN for an empty array
+template<typename UnitTag>
+Quantity<UnitTag> mean(const Quantity<UnitTag>* values, std::size_t n,
+                       const ReduceOptions& opts = ReduceOptions()) {
+    if (n == 0) {
+        return Quantity<UnitTag>(std::numeric_limits<double>::quiet_NaN());
+    }
+    return Quantity<UnitTag>(sum(values, n, opts).value() / static_cast<double>(n));
+}
+
+// sum of a[i] * b[i]
+template<typename UnitTag>
+Squared<Quantity<UnitTag>> dot(const Quantity<UnitTag>* a, const Quantity<UnitTag>* b,
+                               std::size_t n, const ReduceOptions& opts = ReduceOptions()) {
+    return Squared<Quantity<UnitTag>>(
+        detail::reduce_terms(detail::ProductTerms{detail::raw(a), detail::raw(b)}, n, opts));
+}
+
+// sum of a[i] * w[i] with dimensionless weights
+template<typename UnitTag>
+Quantity<UnitTag> dot(const Quantity<UnitTag>* a, const double* w, std::size_t n,
+                      const ReduceOptions& opts = ReduceOptions()) {
+    return Quantity<UnitTag>(
+        detail::reduce_terms(detail::ProductTerms{detail::raw(a), w}, n, opts));
+}
+
+} // namespace batch
+
+} // namespace qtty
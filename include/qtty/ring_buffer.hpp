@@ -0,0 +1,295 @@
+#pragma once
+
+/**
+ * @file ring_buffer.hpp
+ * @brief Lock-free ring buffers for handing quantities between threads
+ *
+ * Two fixed-capacity rings of Quantity<Tag> samples:
+ * - SpscRing<Q>: one producer thread and one consumer thread. Each side
+ *   publishes its index with a single release store and keeps a cached
+ *   copy of the other side's index, so in steady state it touches only
+ *   its own cache line.
+ * - MpmcRing<Q>: any number of producers and consumers. Slots carry
+ *   sequence numbers (Vyukov's bounded queue), and a bulk operation claims
+ *   the run of ready slots at its end of the ring with one CAS.
+ *
+ * The element type is part of the ring's type, so a ring of Meter only
+ * accepts and yields Meter and units cannot get lost between threads.
+ * Storage is allocated once, at construction, and rounded up to a power of
+ * two. Elements are trivially copyable doubles, so push and pop are plain
+ * copies and need no allocation.
+ *
+ * No operation blocks. try_push / try_pop move one element and report
+ * failure when the ring is full or empty. push / pop move as many elements
+ * of a span as fit (or are available) and return that number. An MpmcRing
+ * consumer only claims slots a producer has finished writing (and a
+ * producer only slots a consumer has finished reading), so a thread
+ * descheduled mid-copy delays nobody: until it finishes, its slot simply
+ * counts as not yet filled (or not yet free).
+ * Index counters sit on separate cache lines so producers and consumers do
+ * not false-share.
+ *
+ * Usage example:
+ * @code
+ * SpscRing<Meter> ring(4096);
+ *
+ * // sensor thread
+ * Meter samples[64]; ...
+ * std::size_t sent = 0;
+ * while (sent < 64) sent += ring.push(span<const Meter>(samples + sent, 64 - sent));
+ *
+ * // processing thread
+ * std::vector<Meter> got(256);
+ * std::size_t n = ring.pop(span<Meter>(got));
+ * @endcode
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+#include "ffi_core.hpp"
+#include "span.hpp"
+#include "detail/mpmc_queue.hpp"
+#include "detail/simd.hpp"
+
+namespace qtty {
+
+namespace detail {
+
+template<typename Q>
+constexpr bool check_ring_element() {
+    using Tag = typename Q::unit_tag;
+    static_assert(std::is_same<Q, Quantity<Tag>>::value, "Ring buffers hold Quantity<Tag> elements");
+    return check_quantity_layout<Tag>();
+}
+
+inline std::size_t ring_capacity(std::size_t capacity) {
+    if (capacity == 0) {
+        throw std::invalid_argument("Ring buffer capacity must be positive");
+    }
+    return round_up_pow2(capacity);
+}
+
+} // namespace detail
+
+// ============================================================================
+// Single Producer / Single Consumer
+// ============================================================================
+
+template<typename Q>
+class SpscRing {
+    static_assert(detail::check_ring_element<Q>(), "");
+
+public:
+    using value_type = Q;
+
+    // Capacity is rounded up to a power of two
+    explicit SpscRing(std::size_t capacity)
+        : mask_(detail::ring_capacity(capacity) - 1), buf_(new Q[mask_ + 1]) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    std::size_t capacity() const noexcept {
+        return mask_ + 1;
+    }
+
+    // Exact when called from either endpoint thread while the other is idle
+    std::size_t size_approx() const noexcept {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+    // Producer side
+    bool try_push(const Q& q) {
+        return push(span<const Q>(&q, 1)) == 1;
+    }
+
+    // Producer side; returns how many leading elements were enqueued
+    std::size_t push(span<const Q> items) {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        std::size_t free = capacity() - (tail - cached_head_);
+        if (free < items.size()) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            free = capacity() - (tail - cached_head_);
+        }
+        const std::size_t k = std::min(free, items.size());
+        copy_in(tail, items.data(), k);
+        tail_.store(tail + k, std::memory_order_release);
+        return k;
+    }
+
+    // Consumer side
+    bool try_pop(Q& out) {
+        return pop(span<Q>(&out, 1)) == 1;
+    }
+
+    // Consumer side; returns how many elements were written to `out`
+    std::size_t pop(span<Q> out) {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        std::size_t avail = cached_tail_ - head;
+        if (avail < out.size()) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            avail = cached_tail_ - head;
+        }
+        const std::size_t k = std::min(avail, out.size());
+        copy_out(head, out.data(), k);
+        head_.store(head + k, std::memory_order_release);
+        return k;
+    }
+
+private:
+    // Consumer line: its index and its view of the producer's
+    alignas(detail::kCacheLine) std::atomic<std::size_t> head_{0};
+    std::size_t cached_tail_ = 0;
+    // Producer line
+    alignas(detail::kCacheLine) std::atomic<std::size_t> tail_{0};
+    std::size_t cached_head_ = 0;
+    // Read-only after construction
+    alignas(detail::kCacheLine) std::size_t mask_;
+    std::unique_ptr<Q[]> buf_;
+
+    // At most two contiguous copies around the wrap point
+    void copy_in(std::size_t pos, const Q* src, std::size_t k) {
+        const std::size_t at = pos & mask_;
+        const std::size_t first = std::min(k, capacity() - at);
+        std::copy(src, src + first, buf_.get() + at);
+        std::copy(src + first, src + k, buf_.get());
+    }
+
+    void copy_out(std::size_t pos, Q* dst, std::size_t k) const {
+        const std::size_t at = pos & mask_;
+        const std::size_t first = std::min(k, capacity() - at);
+        std::copy(buf_.get() + at, buf_.get() + at + first, dst);
+        std::copy(buf_.get(), buf_.get() + (k - first), dst + first);
+    }
+};
+
+// ============================================================================
+// Multi Producer / Multi Consumer
+// ============================================================================
+
+template<typename Q>
+class MpmcRing {
+    static_assert(detail::check_ring_element<Q>(), "");
+
+public:
+    using value_type = Q;
+
+    explicit MpmcRing(std::size_t capacity)
+        : mask_(detail::ring_capacity(capacity) - 1), cells_(new Cell[mask_ + 1]) {
+        for (std::size_t i = 0; i <= mask_; ++i) {
+            cells_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcRing(const MpmcRing&) = delete;
+    MpmcRing& operator=(const MpmcRing&) = delete;
+
+    std::size_t capacity() const noexcept {
+        return mask_ + 1;
+    }
+
+    std::size_t size_approx() const noexcept {
+        const std::size_t head = head_.load(std::memory_order_acquire);
+        const std::size_t tail = tail_.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    bool try_push(const Q& q) {
+        return push(span<const Q>(&q, 1)) == 1;
+    }
+
+    // Claims the run of free slots at the tail (up to items.size()) with one
+    // CAS, then fills them. Returns how many leading elements were enqueued;
+    // 0 when the ring is full or the next slot is still being read.
+    std::size_t push(span<const Q> items) {
+        const std::size_t want = std::min(items.size(), capacity());
+        std::size_t pos = tail_.load(std::memory_order_relaxed);
+        std::size_t k = 0;
+        while (want > 0) {
+            k = run_length(pos, 0, want);
+            if (k > 0) {
+                if (tail_.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (lap(pos, 0) < 0) {
+                return 0;
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);  // stale tail
+            }
+        }
+        for (std::size_t j = 0; j < k; ++j) {
+            Cell& cell = cells_[(pos + j) & mask_];
+            cell.value = items[j];
+            cell.seq.store(pos + j + 1, std::memory_order_release);
+        }
+        return k;
+    }
+
+    bool try_pop(Q& out) {
+        return pop(span<Q>(&out, 1)) == 1;
+    }
+
+    // Claims the run of published slots at the head (up to out.size()) with
+    // one CAS, then drains them. Returns how many elements were written to
+    // `out`; 0 when the ring is empty or the next slot is still being written.
+    std::size_t pop(span<Q> out) {
+        const std::size_t want = std::min(out.size(), capacity());
+        std::size_t pos = head_.load(std::memory_order_relaxed);
+        std::size_t k = 0;
+        while (want > 0) {
+            k = run_length(pos, 1, want);
+            if (k > 0) {
+                if (head_.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (lap(pos, 1) < 0) {
+                return 0;
+            } else {
+                pos = head_.load(std::memory_order_relaxed);  // stale head
+            }
+        }
+        for (std::size_t j = 0; j < k; ++j) {
+            Cell& cell = cells_[(pos + j) & mask_];
+            out[j] = cell.value;
+            cell.seq.store(pos + j + mask_ + 1, std::memory_order_release);
+        }
+        return k;
+    }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> seq;
+        Q value;
+    };
+
+    alignas(detail::kCacheLine) std::atomic<std::size_t> head_{0};
+    alignas(detail::kCacheLine) std::atomic<std::size_t> tail_{0};
+    alignas(detail::kCacheLine) std::size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+
+    // Sequence of the cell for `pos` relative to the value that makes it
+    // ready: `ready` is 0 for a free slot (push) and 1 for a published one
+    // (pop). Negative means the slot is a lap behind (full / empty or still
+    // in use), positive means `pos` is stale.
+    std::intptr_t lap(std::size_t pos, std::size_t ready) const {
+        const std::size_t seq = cells_[pos & mask_].seq.load(std::memory_order_acquire);
+        return static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + ready);
+    }
+
+    // Number of consecutive ready slots from `pos`, at most `limit`
+    std::size_t run_length(std::size_t pos, std::size_t ready, std::size_t limit) const {
+        std::size_t k = 0;
+        while (k < limit && lap(pos + k, ready) == 0) {
+            ++k;
+        }
+        return k;
+    }
+};
+
+} // namespace qtty
@@ -0,0 +1,380 @@
+#pragma once
+
+/**
+ * @file shm_channel.hpp
+ * @brief Shared-memory quantity channel between processes (POSIX)
+ *
+ * ShmChannel<Q> is a single-producer / single-consumer ring of Quantity<Tag>
+ * samples in a POSIX shared-memory object (shm_open + mmap). One process
+ * creates the channel under a name and another attaches to it. Samples
+ * travel as raw doubles in the ring: nothing is serialized, and the only
+ * copy is the producer's write into the ring. With prepare()/commit() the
+ * producer can even build samples directly in shared memory, and with
+ * peek()/release() the consumer can read them there.
+ *
+ * The mapped region starts with a header:
+ *     magic | layout version | abi_version() | unit_id | element size |
+ *     capacity | head (own cache line) | tail (own cache line)
+ * followed by the ring. attach() checks every field against its own build
+ * and its own Q before it touches the ring:
+ * - a foreign object or layout version: std::invalid_argument;
+ * - a different qtty-ffi ABI: QttyException;
+ * - a different unit, even of the same dimension: InvalidUnitError.
+ * The last one is deliberate: the samples are used in place, so the units
+ * must match exactly. Convert on the producer side if needed.
+ *
+ * OS failures are reported as std::system_error. The creating handle
+ * unlinks the name when it is destroyed. An attached process keeps its
+ * mapping until it detaches.
+ *
+ * Exactly one process may write and one may read at a time. The head and
+ * tail counters are lock-free atomics, which are address-free, so they
+ * work across processes.
+ *
+ * Available when QTTY_HAS_SHM is 1 (POSIX systems). On older glibc,
+ * shm_open lives in librt; the CMake target links it when present.
+ *
+ * Usage example:
+ * @code
+ * // acquisition process
+ * auto tx = ShmChannel<Meter>::create("/ranges", 1 << 16);
+ * span<Meter> slot = tx.prepare(256);       // write samples in place
+ * fill(slot.data(), slot.size());
+ * tx.commit(slot.size());
+ *
+ * // analysis process
+ * auto rx = ShmChannel<Meter>::attach("/ranges");
+ * span<const Meter> got = rx.peek(1024);    // read samples in place
+ * stats.push(got.data(), got.size());
+ * rx.release(got.size());
+ * @endcode
+ */
+
+#if defined(__unix__) || defined(__APPLE__)
+#define QTTY_HAS_SHM 1
+#else
+#define QTTY_HAS_SHM 0
+#endif
+
+#if QTTY_HAS_SHM
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "qtty.hpp"
+#include "span.hpp"
+#include "detail/mpmc_queue.hpp"
+#include "detail/simd.hpp"
+
+namespace qtty {
+
+namespace detail {
+
+inline constexpr std::uint64_t kShmMagic = 0x314D485359545451ULL;  // "QTTYSHM1" little-endian
+inline constexpr std::uint32_t kShmLayoutVersion = 1;
+
+struct alignas(kCacheLine) ShmHeader {
+    std::atomic<std::uint64_t> magic;  // written last by the creator
+    std::uint32_t layout_version;
+    std::uint32_t abi_version;
+    std::uint32_t unit_id;
+    std::uint32_t element_size;
+    std::uint64_t capacity;
+    alignas(kCacheLine) std::atomic<std::uint64_t> head;  // consumer
+    alignas(kCacheLine) std::atomic<std::uint64_t> tail;  // producer
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "Shared-memory channels need lock-free 64-bit atomics");
+static_assert(sizeof(ShmHeader) % kCacheLine == 0, "Ring data must start on a cache line");
+
+[[noreturn]] inline void throw_os_error(const std::string& what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+// POSIX shared-memory names start with exactly one '/'
+inline std::string shm_object_name(const std::string& name) {
+    if (name.empty()) {
+        throw std::invalid_argument("Shared-memory channel name must not be empty");
+    }
+    return name[0] == '/' ? name : "/" + name;
+}
+
+} // namespace detail
+
+template<typename Q>
+class ShmChannel {
+    using Tag = typename Q::unit_tag;
+    static_assert(std::is_same<Q, Quantity<Tag>>::value, "Channels carry Quantity<Tag> elements");
+    static_assert(detail::check_quantity_layout<Tag>(), "");
+
+public:
+    using value_type = Q;
+
+    // Creates a new channel; fails if the name already exists. Capacity is
+    // rounded up to a power of two.
+    static ShmChannel create(const std::string& name, std::size_t capacity) {
+        if (capacity == 0) {
+            throw std::invalid_argument("Shared-memory channel capacity must be positive");
+        }
+        const std::string object = detail::shm_object_name(name);
+        const std::uint64_t cap = detail::round_up_pow2(capacity);
+        const std::size_t bytes = sizeof(detail::ShmHeader) + cap * sizeof(Q);
+
+        const int fd = ::shm_open(object.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) {
+            detail::throw_os_error("shm_open " + object);
+        }
+        ShmChannel ch;
+        ch.name_ = object;
+        ch.owner_ = true;  // unlinks on failure below too
+        if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            ::close(fd);
+            detail::throw_os_error("ftruncate " + object);
+        }
+        ch.map(fd, bytes, object);
+
+        detail::ShmHeader* h = new (ch.base_) detail::ShmHeader;
+        h->head.store(0, std::memory_order_relaxed);
+        h->tail.store(0, std::memory_order_relaxed);
+        h->layout_version = detail::kShmLayoutVersion;
+        h->abi_version = abi_version();
+        h->unit_id = static_cast<std::uint32_t>(UnitTraits<Tag>::unit_id());
+        h->element_size = sizeof(Q);
+        h->capacity = cap;
+        // Publishing the magic last marks the header complete
+        h->magic.store(detail::kShmMagic, std::memory_order_release);
+        return ch;
+    }
+
+    // Attaches to an existing channel and validates its header
+    static ShmChannel attach(const std::string& name) {
+        const std::string object = detail::shm_object_name(name);
+        const int fd = ::shm_open(object.c_str(), O_RDWR, 0);
+        if (fd < 0) {
+            detail::throw_os_error("shm_open " + object);
+        }
+        struct stat st {};
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            detail::throw_os_error("fstat " + object);
+        }
+        const std::size_t bytes = static_cast<std::size_t>(st.st_size);
+        if (bytes < sizeof(detail::ShmHeader)) {
+            ::close(fd);
+            throw std::invalid_argument(object + " is not a qtty channel");
+        }
+        ShmChannel ch;
+        ch.name_ = object;
+        ch.map(fd, bytes, object);
+
+        const detail::ShmHeader* h = ch.header();
+        if (h->magic.load(std::memory_order_acquire) != detail::kShmMagic) {
+            throw std::invalid_argument(object + " is not a qtty channel");
+        }
+        if (h->layout_version != detail::kShmLayoutVersion || h->element_size != sizeof(Q)) {
+            throw std::invalid_argument(object + " has an unsupported channel layout");
+        }
+        if (h->abi_version != abi_version()) {
+            throw QttyException(object + " was created against qtty-ffi ABI " +
+                                std::to_string(h->abi_version) + ", this process uses " +
+                                std::to_string(abi_version()));
+        }
+        if (h->unit_id != static_cast<std::uint32_t>(UnitTraits<Tag>::unit_id())) {
+            throw InvalidUnitError(object + " carries unit " + std::to_string(h->unit_id) +
+                                   ", expected " +
+                                   std::to_string(static_cast<std::uint32_t>(UnitTraits<Tag>::unit_id())));
+        }
+        // Divide rather than multiply: the capacity comes from shared memory
+        if (h->capacity == 0 || (h->capacity & (h->capacity - 1)) != 0 ||
+            h->capacity > (bytes - sizeof(detail::ShmHeader)) / sizeof(Q)) {
+            throw std::invalid_argument(object + " has an inconsistent capacity");
+        }
+        return ch;
+    }
+
+    // Removes a channel name left behind by a crashed creator
+    static void unlink(const std::string& name) {
+        ::shm_unlink(detail::shm_object_name(name).c_str());
+    }
+
+    ShmChannel(ShmChannel&& other) noexcept
+        : base_(std::exchange(other.base_, nullptr)), bytes_(other.bytes_), name_(std::move(other.name_)),
+          owner_(std::exchange(other.owner_, false)), cached_head_(other.cached_head_),
+          cached_tail_(other.cached_tail_) {}
+
+    ShmChannel& operator=(ShmChannel&& other) noexcept {
+        if (this != &other) {
+            close();
+            base_ = std::exchange(other.base_, nullptr);
+            bytes_ = other.bytes_;
+            name_ = std::move(other.name_);
+            owner_ = std::exchange(other.owner_, false);
+            cached_head_ = other.cached_head_;
+            cached_tail_ = other.cached_tail_;
+        }
+        return *this;
+    }
+
+    ShmChannel(const ShmChannel&) = delete;
+    ShmChannel& operator=(const ShmChannel&) = delete;
+
+    ~ShmChannel() {
+        close();
+    }
+
+    const std::string& name() const noexcept {
+        return name_;
+    }
+
+    std::size_t capacity() const noexcept {
+        return static_cast<std::size_t>(header()->capacity);
+    }
+
+    std::size_t size_approx() const noexcept {
+        return static_cast<std::size_t>(header()->tail.load(std::memory_order_acquire) -
+                                        header()->head.load(std::memory_order_acquire));
+    }
+
+    // ------------------------------------------------------------------------
+    // Producer
+    // ------------------------------------------------------------------------
+
+    // Contiguous free slots for up to n samples (possibly fewer, or none,
+    // when the ring is full or wraps). Fill them, then commit().
+    span<Q> prepare(std::size_t n) {
+        detail::ShmHeader* h = header();
+        const std::uint64_t tail = h->tail.load(std::memory_order_relaxed);
+        std::uint64_t free = h->capacity - (tail - cached_head_);
+        if (free < n) {
+            cached_head_ = h->head.load(std::memory_order_acquire);
+            free = h->capacity - (tail - cached_head_);
+        }
+        const std::uint64_t at = tail & (h->capacity - 1);
+        const std::size_t k = static_cast<std::size_t>(std::min<std::uint64_t>({n, free, h->capacity - at}));
+        return span<Q>(data() + at, k);
+    }
+
+    // Publishes the first k prepared samples
+    void commit(std::size_t k) {
+        detail::ShmHeader* h = header();
+        h->tail.store(h->tail.load(std::memory_order_relaxed) + k, std::memory_order_release);
+    }
+
+    // Copies as many leading samples as fit; returns the number written
+    std::size_t write(span<const Q> items) {
+        std::size_t done = 0;
+        while (done < items.size()) {
+            span<Q> slot = prepare(items.size() - done);
+            if (slot.empty()) {
+                break;
+            }
+            std::copy(items.data() + done, items.data() + done + slot.size(), slot.data());
+            commit(slot.size());
+            done += slot.size();
+        }
+        return done;
+    }
+
+    // ------------------------------------------------------------------------
+    // Consumer
+    // ------------------------------------------------------------------------
+
+    // Contiguous published samples, up to max (fewer at the wrap point).
+    // They stay valid until release().
+    span<const Q> peek(std::size_t max) {
+        detail::ShmHeader* h = header();
+        const std::uint64_t head = h->head.load(std::memory_order_relaxed);
+        std::uint64_t avail = cached_tail_ - head;
+        if (avail < max) {
+            cached_tail_ = h->tail.load(std::memory_order_acquire);
+            avail = cached_tail_ - head;
+        }
+        const std::uint64_t at = head & (h->capacity - 1);
+        const std::size_t k = static_cast<std::size_t>(std::min<std::uint64_t>({max, avail, h->capacity - at}));
+        return span<const Q>(data() + at, k);
+    }
+
+    // Returns the first k peeked samples' slots to the producer
+    void release(std::size_t k) {
+        detail::ShmHeader* h = header();
+        h->head.store(h->head.load(std::memory_order_relaxed) + k, std::memory_order_release);
+    }
+
+    // Copies up to out.size() samples; returns the number read
+    std::size_t read(span<Q> out) {
+        std::size_t done = 0;
+        while (done < out.size()) {
+            span<const Q> got = peek(out.size() - done);
+            if (got.empty()) {
+                break;
+            }
+            std::copy(got.begin(), got.end(), out.data() + done);
+            release(got.size());
+            done += got.size();
+        }
+        return done;
+    }
+
+private:
+    void* base_ = nullptr;
+    std::size_t bytes_ = 0;
+    std::string name_;
+    bool owner_ = false;
+    // Process-local snapshots of the other side's counter
+    std::uint64_t cached_head_ = 0;
+    std::uint64_t cached_tail_ = 0;
+
+    ShmChannel() = default;
+
+    // Maps the object and closes fd (the mapping keeps the memory alive)
+    void map(int fd, std::size_t bytes, const std::string& object) {
+        void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        const int err = errno;
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            errno = err;
+            detail::throw_os_error("mmap " + object);
+        }
+        base_ = p;
+        bytes_ = bytes;
+        cached_head_ = header()->head.load(std::memory_order_acquire);
+        cached_tail_ = header()->tail.load(std::memory_order_acquire);
+    }
+
+    void close() noexcept {
+        if (base_ != nullptr) {
+            ::munmap(base_, bytes_);
+            base_ = nullptr;
+        }
+        if (owner_) {
+            ::shm_unlink(name_.c_str());
+            owner_ = false;
+        }
+    }
+
+    detail::ShmHeader* header() const noexcept {
+        return static_cast<detail::ShmHeader*>(base_);
+    }
+
+    Q* data() const noexcept {
+        return reinterpret_cast<Q*>(static_cast<char*>(base_) + sizeof(detail::ShmHeader));
+    }
+};
+
+} // namespace qtty
+
+#endif // QTTY_HAS_SHM
@@ -0,0 +1,342 @@
+#pragma once
+
+/**
+ * @file sketch.hpp
+ * @brief Mergeable KLL quantile sketch over typed quantities
+ *
+ * KllSketch<Q> estimates quantiles and ranks of a stream of Q values in
+ * O(k) memory (Karnin, Lang, Liberty 2016). Items live in a stack of
+ * compactors. Each item at level h stands for 2^h inputs. When the sketch
+ * is full, the lowest over-capacity level is sorted and every other item
+ * (random offset) is promoted one level up. The rank error is roughly
+ * 1.7 / k (about 1% for the default k = 200). min() and max() are exact.
+ *
+ * Sketches with the same k merge by concatenating levels and compacting,
+ * so partial sketches built on different threads or nodes combine into
+ * one with the same error guarantee.
+ *
+ * serialize() produces a compact little-endian byte string:
+ *
+ *     "QKLL" | version u8 | unit_id u32 | k u16 | levels u8 | n u64 |
+ *     min f64 | max f64 | per level: count u32, items f64...
+ *
+ * deserialize() accepts any unit of Q's dimension and rescales the items.
+ * quantile_in<Target>() is just the quantile times a cached factor.
+ *
+ * Usage example:
+ * @code
+ * KllSketch<Millisecond> sketch;
+ * sketch.push(latencies.data(), latencies.size());
+ * Millisecond p99 = sketch.quantile(0.99);
+ * Second p99_s = sketch.quantile_in<SecondTag>(0.99);
+ *
+ * std::vector<std::uint8_t> bytes = sketch.serialize();
+ * total.merge(KllSketch<Millisecond>::deserialize(bytes.data(), bytes.size()));
+ * @endcode
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "ffi_core.hpp"
+#include "detail/bytes.hpp"
+#include "detail/factors.hpp"
+
+namespace qtty {
+
+template<typename Q>
+class KllSketch {
+public:
+    using unit_tag = typename Q::unit_tag;
+
+    static constexpr std::uint8_t kFormatVersion = 1;
+
+    explicit KllSketch(std::uint16_t k = 200) : k_(k) {
+        if (k < 8) {
+            throw std::invalid_argument("KllSketch k must be at least 8");
+        }
+        levels_.emplace_back();
+        capacity_ = compute_capacity();
+    }
+
+    std::uint16_t k() const {
+        return k_;
+    }
+
+    // Number of values pushed (including merged sketches)
+    std::uint64_t count() const {
+        return n_;
+    }
+
+    bool empty() const {
+        return n_ == 0;
+    }
+
+    // Number of retained items
+    std::size_t retained() const {
+        return size_;
+    }
+
+    void push(const Q& q) {
+        const double x = q.value();
+        if (std::isnan(x)) {
+            return;
+        }
+        levels_[0].push_back(x);
+        ++size_;
+        ++n_;
+        min_ = std::min(min_, x);
+        max_ = std::max(max_, x);
+        if (size_ >= capacity_) {
+            compress();
+        }
+    }
+
+    // NaN values are skipped
+    void push(const Q* values, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            push(values[i]);
+        }
+    }
+
+    void merge(const KllSketch& other) {
+        if (other.k_ != k_) {
+            throw std::invalid_argument("KllSketch merge requires equal k");
+        }
+        if (other.n_ == 0) {
+            return;
+        }
+        while (levels_.size() < other.levels_.size()) {
+            levels_.emplace_back();
+        }
+        capacity_ = compute_capacity();
+        for (std::size_t h = 0; h < other.levels_.size(); ++h) {
+            levels_[h].insert(levels_[h].end(), other.levels_[h].begin(), other.levels_[h].end());
+        }
+        size_ += other.size_;
+        n_ += other.n_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+        while (size_ >= capacity_) {
+            compress();
+        }
+    }
+
+    Q min() const {
+        return Q(n_ == 0 ? std::numeric_limits<double>::quiet_NaN() : min_);
+    }
+
+    Q max() const {
+        return Q(n_ == 0 ? std::numeric_limits<double>::quiet_NaN() : max_);
+    }
+
+    // Estimated value at normalized rank q in [0, 1]; NaN when empty
+    Q quantile(double q) const {
+        Q out;
+        quantiles(&q, &out, 1);
+        return out;
+    }
+
+    template<typename TargetTag>
+    Quantity<TargetTag> quantile_in(double q) const {
+        return Quantity<TargetTag>(quantile(q).value() * conversion_factor<unit_tag, TargetTag>());
+    }
+
+    // Several quantiles with one sort of the retained items
+    void quantiles(const double* qs, Q* out, std::size_t m) const {
+        const auto items = weighted_items();
+        for (std::size_t j = 0; j < m; ++j) {
+            if (n_ == 0 || std::isnan(qs[j])) {
+                out[j] = Q(std::numeric_limits<double>::quiet_NaN());
+                continue;
+            }
+            const double q = std::min(1.0, std::max(0.0, qs[j]));
+            if (q <= 0.0) {
+                out[j] = Q(min_);
+                continue;
+            }
+            if (q >= 1.0) {
+                out[j] = Q(max_);
+                continue;
+            }
+            const double target = q * static_cast<double>(n_);
+            double cum = 0.0;
+            double value = max_;
+            for (const auto& it : items) {
+                cum += static_cast<double>(it.second);
+                if (cum >= target) {
+                    value = it.first;
+                    break;
+                }
+            }
+            out[j] = Q(value);
+        }
+    }
+
+    // Estimated fraction of values <= x
+    template<typename Tag>
+    double rank(const Quantity<Tag>& x) const {
+        if (n_ == 0) {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        const double v = x.value() * conversion_factor<Tag, unit_tag>();
+        std::uint64_t below = 0;
+        for (std::size_t h = 0; h < levels_.size(); ++h) {
+            for (double item : levels_[h]) {
+                if (item <= v) {
+                    below += std::uint64_t{1} << h;
+                }
+            }
+        }
+        return static_cast<double>(below) / static_cast<double>(n_);
+    }
+
+    std::vector<std::uint8_t> serialize() const {
+        std::vector<std::uint8_t> out;
+        out.reserve(36 + 4 * levels_.size() + 8 * retained());
+        for (char c : {'Q', 'K', 'L', 'L'}) {
+            detail::put_u8(out, static_cast<std::uint8_t>(c));
+        }
+        detail::put_u8(out, kFormatVersion);
+        detail::put_u32(out, static_cast<std::uint32_t>(UnitTraits<unit_tag>::unit_id()));
+        detail::put_u16(out, k_);
+        detail::put_u8(out, static_cast<std::uint8_t>(levels_.size()));
+        detail::put_u64(out, n_);
+        detail::put_f64(out, min_);
+        detail::put_f64(out, max_);
+        for (const auto& level : levels_) {
+            detail::put_u32(out, static_cast<std::uint32_t>(level.size()));
+            for (double v : level) {
+                detail::put_f64(out, v);
+            }
+        }
+        return out;
+    }
+
+    // Throws std::invalid_argument on malformed input and the usual
+    // conversion errors when the stored unit does not match Q's dimension
+    static KllSketch deserialize(const std::uint8_t* data, std::size_t size) {
+        detail::ByteReader in(data, size);
+        const std::uint8_t* magic = in.bytes(4);
+        if (magic[0] != 'Q' || magic[1] != 'K' || magic[2] != 'L' || magic[3] != 'L') {
+            throw std::invalid_argument("Not a KLL sketch");
+        }
+        if (in.u8() != kFormatVersion) {
+            throw std::invalid_argument("Unsupported KLL sketch version");
+        }
+        const UnitId unit = static_cast<UnitId>(in.u32());
+        const double f = detail::runtime_conversion_factor(unit, UnitTraits<unit_tag>::unit_id());
+        KllSketch s(in.u16());
+        const std::uint8_t levels = in.u8();
+        if (levels == 0 || levels > 64) {
+            throw std::invalid_argument("Invalid KLL sketch level count");
+        }
+        s.n_ = in.u64();
+        s.min_ = in.f64() * f;
+        s.max_ = in.f64() * f;
+        s.levels_.assign(levels, {});
+        std::uint64_t weight = 0;
+        for (std::size_t h = 0; h < levels; ++h) {
+            const std::uint32_t count = in.u32();
+            if (count > in.remaining() / 8) {
+                throw std::invalid_argument("Truncated binary data");
+            }
+            s.levels_[h].resize(count);
+            for (double& v : s.levels_[h]) {
+                v = in.f64() * f;
+            }
+            // Level weights come from the input, so guard the running total
+            if (count > (std::numeric_limits<std::uint64_t>::max() - weight) >> h) {
+                throw std::invalid_argument("Inconsistent KLL sketch");
+            }
+            weight += static_cast<std::uint64_t>(count) << h;
+            s.size_ += count;
+        }
+        s.capacity_ = s.compute_capacity();
+        if (weight != s.n_ || in.remaining() != 0) {
+            throw std::invalid_argument("Inconsistent KLL sketch");
+        }
+        if (f < 0.0) {
+            std::swap(s.min_, s.max_);
+        }
+        return s;
+    }
+
+private:
+    std::uint16_t k_;
+    std::uint64_t n_ = 0;
+    std::size_t size_ = 0;      // retained items
+    std::size_t capacity_ = 0;  // sum of level capacities
+    double min_ = std::numeric_limits<double>::infinity();
+    double max_ = -std::numeric_limits<double>::infinity();
+    std::vector<std::vector<double>> levels_;
+    std::uint64_t rng_ = 0x9E3779B97F4A7C15ull;
+
+    // Capacity of level h: k * (2/3)^(depth below the top), at least 2
+    std::size_t level_capacity(std::size_t h) const {
+        const std::size_t depth = levels_.size() - 1 - h;
+        const double c = std::ceil(static_cast<double>(k_) * std::pow(2.0 / 3.0, depth));
+        return std::max<std::size_t>(2, static_cast<std::size_t>(c));
+    }
+
+    std::size_t compute_capacity() const {
+        std::size_t total = 0;
+        for (std::size_t h = 0; h < levels_.size(); ++h) {
+            total += level_capacity(h);
+        }
+        return total;
+    }
+
+    bool coin() {
+        rng_ ^= rng_ << 13;
+        rng_ ^= rng_ >> 7;
+        rng_ ^= rng_ << 17;
+        return (rng_ & 1) != 0;
+    }
+
+    // Halve the lowest level that is at or over capacity
+    void compress() {
+        for (std::size_t h = 0; h < levels_.size(); ++h) {
+            if (levels_[h].size() < level_capacity(h)) {
+                continue;
+            }
+            if (h + 1 == levels_.size()) {
+                levels_.emplace_back();
+                capacity_ = compute_capacity();
+            }
+            std::vector<double>& buf = levels_[h];
+            std::sort(buf.begin(), buf.end());
+            // An odd item out stays behind so promoted weight stays exact
+            const std::size_t keep = buf.size() % 2;
+            const std::size_t offset = coin() ? 1 : 0;
+            std::vector<double>& up = levels_[h + 1];
+            for (std::size_t i = keep + offset; i < buf.size(); i += 2) {
+                up.push_back(buf[i]);
+            }
+            size_ -= (buf.size() - keep) / 2;
+            buf.resize(keep);
+            return;
+        }
+    }
+
+    // Retained items with their weights, sorted by value
+    std::vector<std::pair<double, std::uint64_t>> weighted_items() const {
+        std::vector<std::pair<double, std::uint64_t>> items;
+        items.reserve(retained());
+        for (std::size_t h = 0; h < levels_.size(); ++h) {
+            for (double v : levels_[h]) {
+                items.emplace_back(v, std::uint64_t{1} << h);
+            }
+        }
+        std::sort(items.begin(), items.end());
+        return items;
+    }
+};
+
+} // namespace qtty
@@ -0,0 +1,463 @@
+#pragma once
+
+/**
+ * @file sky_index.hpp
+ * @brief Hierarchical equal-area sky index for cone searches and nearest neighbours
+ *
+ * SkyIndex bins (longitude, latitude) positions into HEALPix pixels in the
+ * NESTED numbering scheme. In that scheme every pixel at order p covers a
+ * contiguous range of pixel numbers at any finer order, so sorting the
+ * points by their fine pixel lets a query descend the pixel hierarchy and
+ * collect whole ranges of points at once:
+ *
+ * - pixels whose bounding circle misses the cone are skipped,
+ * - pixels that lie entirely inside the cone are accepted without
+ *   per-point tests,
+ * - only points in boundary pixels are tested individually.
+ *
+ * Positions are stored as unit vectors sorted by pixel (36 bytes per point:
+ * 3 doubles, a 64-bit pixel key and a 32-bit row id). Per-point tests use
+ * chord lengths, which stay exact down to micro-arcsecond radii.
+ *
+ * The build computes pixel keys and vectors in parallel and sorts with a
+ * parallel merge sort.
+ *
+ * Usage example:
+ * @code
+ * SkyIndex index = SkyIndex::build(ra.data(), dec.data(), n);
+ * std::vector<std::uint32_t> rows = index.cone_search(ra0, dec0, Arcsecond(5.0));
+ * SkyIndex::Match m = index.nearest(ra0, dec0);   // m.index, m.separation
+ * @endcode
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ffi_core.hpp"
+#include "units/angular.hpp"
+#include "angles.hpp"
+#include "detail/factors.hpp"
+#include "detail/parallel.hpp"
+
+namespace qtty {
+
+namespace detail {
+namespace healpix {
+
+// HEALPix NESTED scheme (Gorski et al. 2005), following the reference
+// Healpix_Base implementation. z = sin(latitude), phi = longitude in radians.
+
+inline constexpr int kMaxOrder = 29;
+
+inline std::uint64_t spread_bits(std::uint64_t v) {
+    v &= 0x00000000FFFFFFFFull;
+    v = (v | (v << 16)) & 0x0000FFFF0000FFFFull;
+    v = (v | (v << 8)) & 0x00FF00FF00FF00FFull;
+    v = (v | (v << 4)) & 0x0F0F0F0F0F0F0F0Full;
+    v = (v | (v << 2)) & 0x3333333333333333ull;
+    v = (v | (v << 1)) & 0x5555555555555555ull;
+    return v;
+}
+
+inline std::uint64_t compress_bits(std::uint64_t v) {
+    v &= 0x5555555555555555ull;
+    v = (v | (v >> 1)) & 0x3333333333333333ull;
+    v = (v | (v >> 2)) & 0x0F0F0F0F0F0F0F0Full;
+    v = (v | (v >> 4)) & 0x00FF00FF00FF00FFull;
+    v = (v | (v >> 8)) & 0x0000FFFF0000FFFFull;
+    v = (v | (v >> 16)) & 0x00000000FFFFFFFFull;
+    return v;
+}
+
+inline std::uint64_t xyf2nest(int order, std::int64_t ix, std::int64_t iy, int face) {
+    return (static_cast<std::uint64_t>(face) << (2 * order)) +
+           spread_bits(static_cast<std::uint64_t>(ix)) +
+           (spread_bits(static_cast<std::uint64_t>(iy)) << 1);
+}
+
+// sth = cos(latitude), used near the poles where 1 - |z| cancels
+inline std::uint64_t ang2pix_nest(int order, double z, double sth, double phi) {
+    const std::int64_t nside = std::int64_t{1} << order;
+    const double za = std::fabs(z);
+    double tt = std::fmod(phi * (2.0 / kPi), 4.0);
+    tt = tt < 0.0 ? tt + 4.0 : tt;
+    if (za <= 2.0 / 3.0) {
+        const double temp1 = nside * (0.5 + tt);
+        const double temp2 = nside * (z * 0.75);
+        const std::int64_t jp = static_cast<std::int64_t>(temp1 - temp2);
+        const std::int64_t jm = static_cast<std::int64_t>(temp1 + temp2);
+        const std::int64_t ifp = jp >> order;
+        const std::int64_t ifm = jm >> order;
+        const int face = static_cast<int>(
+            ifp == ifm ? (ifp | 4) : (ifp < ifm ? ifp : ifm + 8));
+        const std::int64_t ix = jm & (nside - 1);
+        const std::int64_t iy = nside - (jp & (nside - 1)) - 1;
+        return xyf2nest(order, ix, iy, face);
+    }
+    const int ntt = std::min(3, static_cast<int>(tt));
+    const double tp = tt - ntt;
+    const double tmp = za < 0.99 ? nside * std::sqrt(3.0 * (1.0 - za))
+                                 : nside * sth / std::sqrt((1.0 + za) / 3.0);
+    std::int64_t jp = static_cast<std::int64_t>(tp * tmp);
+    std::int64_t jm = static_cast<std::int64_t>((1.0 - tp) * tmp);
+    jp = std::min(jp, nside - 1);
+    jm = std::min(jm, nside - 1);
+    return z >= 0.0 ? xyf2nest(order, nside - jm - 1, nside - jp - 1, ntt)
+                    : xyf2nest(order, jp, jm, ntt + 8);
+}
+
+// Unit vector of the pixel center
+inline void pix2vec_nest(int order, std::uint64_t pix, double v[3]) {
+    static const int jrll[12] = {2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4};
+    static const int jpll[12] = {1, 3, 5, 7, 0, 2, 4, 6, 1, 3, 5, 7};
+    const std::int64_t nside = std::int64_t{1} << order;
+    const std::uint64_t npface = std::uint64_t{1} << (2 * order);
+    const int face = static_cast<int>(pix >> (2 * order));
+    const std::uint64_t local = pix & (npface - 1);
+    const std::int64_t ix = static_cast<std::int64_t>(compress_bits(local));
+    const std::int64_t iy = static_cast<std::int64_t>(compress_bits(local >> 1));
+    const double fact2 = 4.0 / (12.0 * static_cast<double>(npface));
+
+    const std::int64_t jr = (static_cast<std::int64_t>(jrll[face]) << order) - ix - iy - 1;
+    std::int64_t nr;
+    double z, sth;
+    if (jr < nside) {
+        nr = jr;
+        const double tmp = static_cast<double>(nr * nr) * fact2;
+        z = 1.0 - tmp;
+        sth = std::sqrt(tmp * (2.0 - tmp));
+    } else if (jr > 3 * nside) {
+        nr = 4 * nside - jr;
+        const double tmp = static_cast<double>(nr * nr) * fact2;
+        z = tmp - 1.0;
+        sth = std::sqrt(tmp * (2.0 - tmp));
+    } else {
+        nr = nside;
+        z = static_cast<double>(2 * nside - jr) * 2.0 / (3.0 * static_cast<double>(nside));
+        sth = std::sqrt((1.0 - z) * (1.0 + z));
+    }
+    std::int64_t tmp = static_cast<std::int64_t>(jpll[face]) * nr + ix - iy;
+    if (tmp < 0) {
+        tmp += 8 * nr;
+    }
+    const double phi = (0.25 * kPi * static_cast<double>(tmp)) / static_cast<double>(nr);
+    v[0] = sth * std::cos(phi);
+    v[1] = sth * std::sin(phi);
+    v[2] = z;
+}
+
+// Upper bound on the angular distance from a pixel center to any point of
+// the pixel at this order (Healpix_Base::max_pixrad plus a safety margin
+// for curved pixel edges and boundary rounding).
+inline double max_pixrad(int order) {
+    const double nside = static_cast<double>(std::int64_t{1} << order);
+    const double za = 2.0 / 3.0;
+    const double pa = kPi / (4.0 * nside);
+    double t1 = 1.0 - 1.0 / nside;
+    t1 *= t1;
+    const double zb = 1.0 - t1 / 3.0;
+    const double sa = std::sqrt((1.0 - za) * (1.0 + za));
+    const double sb = std::sqrt((1.0 - zb) * (1.0 + zb));
+    const double ax = sa * std::cos(pa), ay = sa * std::sin(pa), az = za;
+    const double bx = sb, by = 0.0, bz = zb;
+    const double cx = ay * bz - az * by, cy = az * bx - ax * bz, cz = ax * by - ay * bx;
+    const double angle = std::atan2(std::sqrt(cx * cx + cy * cy + cz * cz),
+                                    ax * bx + ay * by + az * bz);
+    return angle * 1.1 + 1e-12;
+}
+
+} // namespace healpix
+} // namespace detail
+
+struct SkyIndexOptions {
+    int order = -1;        // HEALPix order of the leaf pixels; -1 picks one from n
+    unsigned threads = 0;  // 0 = one per hardware thread
+};
+
+class SkyIndex {
+public:
+    struct Match {
+        std::uint32_t index;
+        Radian separation;
+    };
+
+    SkyIndex() = default;
+
+    template<typename AngleTag>
+    static SkyIndex build(const Quantity<AngleTag>* lon, const Quantity<AngleTag>* lat,
+                          std::size_t n, const SkyIndexOptions& opts = SkyIndexOptions());
+
+    std::size_t size() const {
+        return ids_.size();
+    }
+
+    int order() const {
+        return order_;
+    }
+
+    // Rows whose separation from (lon, lat) is <= radius, in pixel order.
+    // A non-finite center or radius matches nothing.
+    template<typename AngleTag, typename RadiusTag>
+    void cone_search(const Quantity<AngleTag>& lon, const Quantity<AngleTag>& lat,
+                     const Quantity<RadiusTag>& radius, std::vector<std::uint32_t>& out) const {
+        double q[3];
+        unit_vector<AngleTag>(lon, lat, q);
+        cone_search_radians(q, radius.value() * detail::radians_per_unit<RadiusTag>(), out);
+    }
+
+    template<typename AngleTag, typename RadiusTag>
+    std::vector<std::uint32_t> cone_search(const Quantity<AngleTag>& lon,
+                                           const Quantity<AngleTag>& lat,
+                                           const Quantity<RadiusTag>& radius) const {
+        std::vector<std::uint32_t> out;
+        cone_search(lon, lat, radius, out);
+        return out;
+    }
+
+    // Closest indexed position; throws std::out_of_range on an empty index
+    // and std::invalid_argument on a non-finite position
+    template<typename AngleTag>
+    Match nearest(const Quantity<AngleTag>& lon, const Quantity<AngleTag>& lat) const {
+        if (!std::isfinite(lon.value()) || !std::isfinite(lat.value())) {
+            throw std::invalid_argument("SkyIndex::nearest needs a finite position");
+        }
+        double q[3];
+        unit_vector<AngleTag>(lon, lat, q);
+        return nearest_unit(q);
+    }
+
+private:
+    int order_ = 0;
+    std::vector<std::uint64_t> keys_;  // leaf pixel per point, ascending
+    std::vector<std::uint32_t> ids_;   // input row per point
+    std::vector<double> xyz_;          // unit vectors, 3 per point
+
+    template<typename AngleTag>
+    static void unit_vector(const Quantity<AngleTag>& lon, const Quantity<AngleTag>& lat,
+                            double v[3]) {
+        const SinCos sl = sincos(lon);
+        const SinCos sb = sincos(lat);
+        v[0] = sb.cos * sl.cos;
+        v[1] = sb.cos * sl.sin;
+        v[2] = sb.sin;
+    }
+
+    static int default_order(std::size_t n) {
+        // About 16 points per leaf pixel
+        int order = 0;
+        while (order < 16 && 12.0 * std::pow(4.0, order) * 16.0 < static_cast<double>(n)) {
+            ++order;
+        }
+        return order;
+    }
+
+    // Squared chord length between two unit vectors
+    static double chord2(const double* a, const double* b) {
+        const double dx = a[0] - b[0];
+        const double dy = a[1] - b[1];
+        const double dz = a[2] - b[2];
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    static double angle_between(const double* a, const double* b) {
+        const double cx = a[1] * b[2] - a[2] * b[1];
+        const double cy = a[2] * b[0] - a[0] * b[2];
+        const double cz = a[0] * b[1] - a[1] * b[0];
+        return std::atan2(std::sqrt(cx * cx + cy * cy + cz * cz),
+                          a[0] * b[0] + a[1] * b[1] + a[2] * b[2]);
+    }
+
+    // Range of sorted points inside pixel `pix` at order p
+    std::pair<std::size_t, std::size_t> pixel_range(int p, std::uint64_t pix) const {
+        const int shift = 2 * (order_ - p);
+        const std::uint64_t lo = pix << shift;
+        const std::uint64_t hi = (pix + 1) << shift;
+        const auto b = std::lower_bound(keys_.begin(), keys_.end(), lo);
+        const auto e = std::lower_bound(b, keys_.end(), hi);
+        return {static_cast<std::size_t>(b - keys_.begin()),
+                static_cast<std::size_t>(e - keys_.begin())};
+    }
+
+    // Calls fn(i) for every sorted position i within `radius` of q
+    template<typename Fn>
+    void visit_cone(const double q[3], double radius, Fn&& fn) const {
+        // NaN radius or center (from a non-finite query angle) matches nothing
+        if (keys_.empty() || !(radius >= 0.0) || !std::isfinite(q[0] + q[1] + q[2])) {
+            return;
+        }
+        if (radius >= detail::kPi) {
+            for (std::size_t i = 0; i < ids_.size(); ++i) {
+                fn(i);
+            }
+            return;
+        }
+        const double chord = 2.0 * std::sin(0.5 * radius);
+        const double limit = chord * chord;
+
+        struct Node {
+            int order;
+            std::uint64_t pix;
+        };
+        std::vector<Node> stack;
+        for (std::uint64_t f = 12; f-- > 0;) {
+            stack.push_back({0, f});
+        }
+        while (!stack.empty()) {
+            const Node node = stack.back();
+            stack.pop_back();
+            const auto range = pixel_range(node.order, node.pix);
+            if (range.first == range.second) {
+                continue;
+            }
+            double c[3];
+            detail::healpix::pix2vec_nest(node.order, node.pix, c);
+            const double d = angle_between(q, c);
+            const double r = detail::healpix::max_pixrad(node.order);
+            if (d > radius + r) {
+                continue;
+            }
+            if (d + r <= radius) {
+                for (std::size_t i = range.first; i < range.second; ++i) {
+                    fn(i);
+                }
+                continue;
+            }
+            if (node.order == order_ || range.second - range.first <= 32) {
+                for (std::size_t i = range.first; i < range.second; ++i) {
+                    if (chord2(q, &xyz_[3 * i]) <= limit) {
+                        fn(i);
+                    }
+                }
+                continue;
+            }
+            for (std::uint64_t child = 4; child-- > 0;) {
+                stack.push_back({node.order + 1, node.pix * 4 + child});
+            }
+        }
+    }
+
+    void cone_search_radians(const double q[3], double radius,
+                             std::vector<std::uint32_t>& out) const {
+        visit_cone(q, radius, [&](std::size_t i) { out.push_back(ids_[i]); });
+    }
+
+    Match nearest_unit(const double q[3]) const {
+        if (keys_.empty()) {
+            throw std::out_of_range("SkyIndex::nearest on an empty index");
+        }
+        // Grow a cone until it holds a point no farther than its radius;
+        // every closer point then lies inside the cone as well.
+        double radius = std::sqrt(4.0 * detail::kPi / (12.0 * std::pow(4.0, order_)));
+        for (;;) {
+            double best_c2 = std::numeric_limits<double>::infinity();
+            std::uint32_t best = 0;
+            visit_cone(q, radius, [&](std::size_t i) {
+                const double c2 = chord2(q, &xyz_[3 * i]);
+                if (c2 < best_c2 || (c2 == best_c2 && ids_[i] < best)) {
+                    best_c2 = c2;
+                    best = ids_[i];
+                }
+            });
+            const double sep = 2.0 * std::asin(std::min(1.0, 0.5 * std::sqrt(best_c2)));
+            if (sep <= radius || radius >= detail::kPi) {
+                return {best, Radian(sep)};
+            }
+            radius = std::min(2.0 * radius, detail::kPi);
+        }
+    }
+};
+
+template<typename AngleTag>
+SkyIndex SkyIndex::build(const Quantity<AngleTag>* lon, const Quantity<AngleTag>* lat,
+                         std::size_t n, const SkyIndexOptions& opts) {
+    if (n > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::invalid_argument("SkyIndex supports at most 2^32 - 1 points");
+    }
+    if (opts.order > detail::healpix::kMaxOrder) {
+        throw std::invalid_argument("SkyIndex order must be <= 29");
+    }
+    // Non-finite angles have no pixel (and would overflow the integer
+    // conversions in ang2pix_nest)
+    for (std::size_t i = 0; i < n; ++i) {
+        if (!std::isfinite(lon[i].value()) || !std::isfinite(lat[i].value())) {
+            throw std::invalid_argument("SkyIndex::build needs finite positions (row " +
+                                        std::to_string(i) + ")");
+        }
+    }
+    SkyIndex index;
+    index.order_ = opts.order >= 0 ? opts.order : default_order(n);
+    const int order = index.order_;
+
+    // Pixel keys and unit vectors, in input order
+    std::vector<std::pair<std::uint64_t, std::uint32_t>> entries(n);
+    std::vector<double> xyz(3 * n);
+    const double* l = detail::raw(lon);
+    const double* b = detail::raw(lat);
+    const double per_turn = detail::units_per_turn<AngleTag>();
+    detail::parallel_for(n, opts.threads, [&](std::size_t begin, std::size_t end) {
+        constexpr std::size_t kBlock = 256;
+        double sl[kBlock], cl[kBlock], sb[kBlock], cb[kBlock];
+        for (std::size_t base = begin; base < end; base += kBlock) {
+            const std::size_t m = std::min(kBlock, end - base);
+            detail::sincos_kernel(l + base, sl, cl, m, per_turn, Accuracy::Precise);
+            detail::sincos_kernel(b + base, sb, cb, m, per_turn, Accuracy::Precise);
+            for (std::size_t i = 0; i < m; ++i) {
+                const std::size_t k = base + i;
+                double phi = std::atan2(sl[i], cl[i]);
+                phi = phi < 0.0 ? phi + detail::kTwoPi : phi;
+                xyz[3 * k] = cb[i] * cl[i];
+                xyz[3 * k + 1] = cb[i] * sl[i];
+                xyz[3 * k + 2] = sb[i];
+                entries[k] = {detail::healpix::ang2pix_nest(order, sb[i], std::fabs(cb[i]), phi),
+                              static_cast<std::uint32_t>(k)};
+            }
+        }
+    }, 4096);
+
+    // Parallel merge sort: sort equal chunks, then merge neighbours pairwise
+    const unsigned workers = detail::worker_count(n, opts.threads, 4096);
+    const std::size_t chunk = (n + workers - 1) / std::max(1u, workers);
+    detail::parallel_for(workers, workers, [&](std::size_t wb, std::size_t we) {
+        for (std::size_t w = wb; w < we; ++w) {
+            const std::size_t lo = std::min(n, w * chunk);
+            const std::size_t hi = std::min(n, lo + chunk);
+            std::sort(entries.begin() + lo, entries.begin() + hi);
+        }
+    }, 1);
+    for (std::size_t width = chunk; width < n; width *= 2) {
+        const std::size_t merges = (n + 2 * width - 1) / (2 * width);
+        detail::parallel_for(merges, workers, [&](std::size_t mb, std::size_t me) {
+            for (std::size_t m = mb; m < me; ++m) {
+                const std::size_t lo = m * 2 * width;
+                const std::size_t mid = std::min(n, lo + width);
+                const std::size_t hi = std::min(n, lo + 2 * width);
+                std::inplace_merge(entries.begin() + lo, entries.begin() + mid,
+                                   entries.begin() + hi);
+            }
+        }, 1);
+    }
+
+    index.keys_.resize(n);
+    index.ids_.resize(n);
+    index.xyz_.resize(3 * n);
+    detail::parallel_for(n, opts.threads, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            const std::size_t k = entries[i].second;
+            index.keys_[i] = entries[i].first;
+            index.ids_[i] = entries[i].second;
+            index.xyz_[3 * i] = xyz[3 * k];
+            index.xyz_[3 * i + 1] = xyz[3 * k + 1];
+            index.xyz_[3 * i + 2] = xyz[3 * k + 2];
+        }
+    });
+    return index;
+}
+
+} // namespace qtty
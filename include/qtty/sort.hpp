@@ -0,0 +1,282 @@
+#pragma once
+
+/**
+ * @file sort.hpp
+ * @brief Radix sort and branchless binary search over quantity arrays
+ *
+ * radix_sort() sorts an array of Quantity<Tag> ascending by value with an
+ * LSD radix sort on the IEEE-754 bit pattern, which takes O(n) time and
+ * does no comparisons. Each double is mapped to an unsigned key whose
+ * integer order matches the numeric order:
+ * - negative values have all bits flipped;
+ * - other values have the sign bit set.
+ * The keys are then sorted in six passes of 11 bits each. One counting
+ * pass over the input builds all six digit histograms up front. A pass
+ * whose digit is the same for every key (common for narrow-range data) is
+ * skipped. The sort is stable and orders -0 before +0. NaNs go to the ends
+ * according to their sign bit.
+ *
+ * parallel_radix_sort() does the same with per-thread digit counts. A
+ * prefix sum over (bucket, thread) then lets every thread scatter its own
+ * chunk into disjoint output ranges. The result is identical to the serial
+ * sort.
+ *
+ * lower_bound() / upper_bound() / equal_range() search a sorted array for a
+ * probe in any unit of the same dimension. The probe is converted into the
+ * array's unit once. The search halves the range without branches and
+ * finishes the last window with a vectorizable count. batch::lower_bound()
+ * resolves many probes with a single conversion factor.
+ *
+ * Usage example:
+ * @code
+ * radix_sort(dist.data(), dist.size());                    // std::vector<Meter>
+ * parallel_radix_sort(big.data(), big.size());
+ *
+ * std::size_t i = lower_bound(dist.data(), dist.size(), Kilometer(1.5));
+ * auto [first, last] = equal_range(dist.data(), dist.size(), Meter(0.0));
+ * @endcode
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "ffi_core.hpp"
+#include "detail/parallel.hpp"
+#include "detail/simd.hpp"
+
+namespace qtty {
+
+namespace detail {
+
+inline constexpr int kRadixBits = 11;
+inline constexpr std::size_t kRadixBuckets = std::size_t{1} << kRadixBits;
+inline constexpr int kRadixPasses = 6;  // ceil(64 / 11)
+inline constexpr std::size_t kRadixSmall = 256;  // below this std::sort wins
+inline constexpr std::size_t kSearchWindow = 16;
+
+// Order-preserving map from double to uint64 and back
+inline std::uint64_t float_key(double x) {
+    std::uint64_t b;
+    std::memcpy(&b, &x, sizeof b);
+    const std::uint64_t mask = static_cast<std::uint64_t>(-static_cast<std::int64_t>(b >> 63)) |
+                               (std::uint64_t{1} << 63);
+    return b ^ mask;
+}
+
+inline double key_float(std::uint64_t k) {
+    const std::uint64_t mask = ((k >> 63) - 1) | (std::uint64_t{1} << 63);
+    const std::uint64_t b = k ^ mask;
+    double x;
+    std::memcpy(&x, &b, sizeof x);
+    return x;
+}
+
+inline std::size_t radix_digit(std::uint64_t key, int pass) {
+    return static_cast<std::size_t>(key >> (pass * kRadixBits)) & (kRadixBuckets - 1);
+}
+
+// Keys to sorted keys in place, with `tmp` as the ping-pong buffer
+inline void radix_sort_keys(std::vector<std::uint64_t>& keys, std::vector<std::uint64_t>& tmp) {
+    const std::size_t n = keys.size();
+    std::vector<std::size_t> hist(kRadixPasses * kRadixBuckets, 0);
+    for (std::size_t i = 0; i < n; ++i) {
+        for (int p = 0; p < kRadixPasses; ++p) {
+            ++hist[p * kRadixBuckets + radix_digit(keys[i], p)];
+        }
+    }
+    tmp.resize(n);
+    for (int p = 0; p < kRadixPasses; ++p) {
+        std::size_t* h = hist.data() + p * kRadixBuckets;
+        if (h[radix_digit(keys[0], p)] == n) {
+            continue;
+        }
+        std::size_t sum = 0;
+        for (std::size_t b = 0; b < kRadixBuckets; ++b) {
+            const std::size_t c = h[b];
+            h[b] = sum;
+            sum += c;
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::uint64_t k = keys[i];
+            tmp[h[radix_digit(k, p)]++] = k;
+        }
+        keys.swap(tmp);
+    }
+}
+
+inline void parallel_radix_sort_keys(std::vector<std::uint64_t>& keys,
+                                     std::vector<std::uint64_t>& tmp, unsigned workers) {
+    const std::size_t n = keys.size();
+    const std::size_t chunk = (n + workers - 1) / workers;
+    // hist[(w * kRadixPasses + p) * kRadixBuckets + digit]
+    std::vector<std::size_t> hist(static_cast<std::size_t>(workers) * kRadixPasses * kRadixBuckets);
+    std::vector<std::size_t> total(kRadixPasses * kRadixBuckets, 0);
+    tmp.resize(n);
+
+    auto for_each_worker = [&](auto&& fn) {
+        parallel_for(workers, workers, [&](std::size_t wb, std::size_t we) {
+            for (std::size_t w = wb; w < we; ++w) {
+                const std::size_t begin = std::min(n, w * chunk);
+                fn(w, begin, std::min(n, begin + chunk));
+            }
+        }, 1);
+    };
+
+    // Global counts of every digit decide which passes can be skipped
+    for_each_worker([&](std::size_t w, std::size_t begin, std::size_t end) {
+        std::size_t* h = hist.data() + w * kRadixPasses * kRadixBuckets;
+        std::fill(h, h + kRadixPasses * kRadixBuckets, 0);
+        for (std::size_t i = begin; i < end; ++i) {
+            for (int p = 0; p < kRadixPasses; ++p) {
+                ++h[p * kRadixBuckets + radix_digit(keys[i], p)];
+            }
+        }
+    });
+    for (unsigned w = 0; w < workers; ++w) {
+        for (std::size_t j = 0; j < total.size(); ++j) {
+            total[j] += hist[w * kRadixPasses * kRadixBuckets + j];
+        }
+    }
+
+    for (int p = 0; p < kRadixPasses; ++p) {
+        if (total[p * kRadixBuckets + radix_digit(keys[0], p)] == n) {
+            continue;
+        }
+        // Per-thread counts of this pass's digit over the current order
+        for_each_worker([&](std::size_t w, std::size_t begin, std::size_t end) {
+            std::size_t* h = hist.data() + (w * kRadixPasses + p) * kRadixBuckets;
+            std::fill(h, h + kRadixBuckets, 0);
+            for (std::size_t i = begin; i < end; ++i) {
+                ++h[radix_digit(keys[i], p)];
+            }
+        });
+        // Exclusive prefix over (bucket, thread) keeps the sort stable
+        std::size_t sum = 0;
+        for (std::size_t b = 0; b < kRadixBuckets; ++b) {
+            for (unsigned w = 0; w < workers; ++w) {
+                std::size_t& c = hist[(w * kRadixPasses + p) * kRadixBuckets + b];
+                const std::size_t count = c;
+                c = sum;
+                sum += count;
+            }
+        }
+        for_each_worker([&](std::size_t w, std::size_t begin, std::size_t end) {
+            std::size_t* h = hist.data() + (w * kRadixPasses + p) * kRadixBuckets;
+            for (std::size_t i = begin; i < end; ++i) {
+                const std::uint64_t k = keys[i];
+                tmp[h[radix_digit(k, p)]++] = k;
+            }
+        });
+        keys.swap(tmp);
+    }
+}
+
+template<typename UnitTag>
+void radix_sort_impl(Quantity<UnitTag>* data, std::size_t n, unsigned workers) {
+    double* x = raw(data);
+    if (n < kRadixSmall) {
+        std::sort(x, x + n, [](double a, double b) { return float_key(a) < float_key(b); });
+        return;
+    }
+    std::vector<std::uint64_t> keys(n), tmp;
+    QTTY_SIMD_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        keys[i] = float_key(x[i]);
+    }
+    if (workers <= 1) {
+        radix_sort_keys(keys, tmp);
+    } else {
+        parallel_radix_sort_keys(keys, tmp, workers);
+    }
+    QTTY_SIMD_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        x[i] = key_float(keys[i]);
+    }
+}
+
+// Number of x[0, n) that are < v (Strict) or <= v, for sorted x
+template<bool Strict>
+std::size_t count_before(const double* x, std::size_t n, double v) {
+    const double* base = x;
+    std::size_t len = n;
+    while (len > kSearchWindow) {
+        const std::size_t half = len / 2;
+        const double probe = base[half - 1];
+        base = (Strict ? probe < v : probe <= v) ? base + half : base;
+        len -= half;
+    }
+    std::size_t below = 0;
+    QTTY_SIMD_LOOP
+    for (std::size_t i = 0; i < len; ++i) {
+        below += (Strict ? base[i] < v : base[i] <= v) ? 1 : 0;
+    }
+    return static_cast<std::size_t>(base - x) + below;
+}
+
+} // namespace detail
+
+// ============================================================================
+// Sorting
+// ============================================================================
+
+template<typename UnitTag>
+void radix_sort(Quantity<UnitTag>* data, std::size_t n) {
+    detail::radix_sort_impl(data, n, 1);
+}
+
+// threads == 0: one per hardware thread
+template<typename UnitTag>
+void parallel_radix_sort(Quantity<UnitTag>* data, std::size_t n, unsigned threads = 0) {
+    detail::radix_sort_impl(data, n, detail::worker_count(n, threads));
+}
+
+// ============================================================================
+// Searching (data must be sorted ascending)
+// ============================================================================
+
+// First index whose value is not less than `probe`
+template<typename UnitTag, typename ProbeTag>
+std::size_t lower_bound(const Quantity<UnitTag>* data, std::size_t n,
+                        const Quantity<ProbeTag>& probe) {
+    const double v = probe.value() * conversion_factor<ProbeTag, UnitTag>();
+    return detail::count_before<true>(detail::raw(data), n, v);
+}
+
+// First index whose value is greater than `probe`
+template<typename UnitTag, typename ProbeTag>
+std::size_t upper_bound(const Quantity<UnitTag>* data, std::size_t n,
+                        const Quantity<ProbeTag>& probe) {
+    const double v = probe.value() * conversion_factor<ProbeTag, UnitTag>();
+    return detail::count_before<false>(detail::raw(data), n, v);
+}
+
+template<typename UnitTag, typename ProbeTag>
+std::pair<std::size_t, std::size_t> equal_range(const Quantity<UnitTag>* data, std::size_t n,
+                                                const Quantity<ProbeTag>& probe) {
+    const double v = probe.value() * conversion_factor<ProbeTag, UnitTag>();
+    const double* x = detail::raw(data);
+    const std::size_t first = detail::count_before<true>(x, n, v);
+    return {first, first + detail::count_before<false>(x + first, n - first, v)};
+}
+
+namespace batch {
+
+// out[j] = lower_bound(data, n, probes[j])
+template<typename UnitTag, typename ProbeTag>
+void lower_bound(const Quantity<UnitTag>* data, std::size_t n, const Quantity<ProbeTag>* probes,
+                 std::size_t* out, std::size_t m) {
+    const double f = conversion_factor<ProbeTag, UnitTag>();
+    const double* x = detail::raw(data);
+    const double* p = detail::raw(probes);
+    for (std::size_t j = 0; j < m; ++j) {
+        out[j] = detail::count_before<true>(x, n, p[j] * f);
+    }
+}
+
+} // namespace batch
+
+} // namespace qtty
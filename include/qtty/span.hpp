@@ -0,0 +1,219 @@
+#pragma once
+
+/**
+ * @file span.hpp
+ * @brief Zero-copy views between raw double buffers and quantity arrays
+ *
+ * Quantity<Tag> is standard-layout, trivially copyable and exactly one
+ * double in size and alignment. detail::raw() checks this for every tag at
+ * compile time. So a buffer of n doubles in Tag's unit can be viewed as n
+ * quantities, and the other way round, without copying:
+ *
+ * - as_quantities<Tag>(buffer) views doubles as Quantity<Tag>.
+ * - as_doubles(quantities) views quantities as their raw values.
+ *
+ * Both accept a pointer and a count, or anything with data() and size()
+ * (std::vector, std::array, qtty::span, ...). Constness is carried over
+ * from the source. The views do not own memory and must not outlive the
+ * buffer, so a temporary container is a compile error (a temporary span is
+ * fine; it does not own its data either). No unit conversion happens: the
+ * doubles must already be in Tag's unit.
+ *
+ * qtty::span<T> is std::span<T> when the standard library provides it
+ * (C++20). Otherwise it is a minimal dynamic-extent stand-in with the same
+ * member names.
+ *
+ * Usage example:
+ * @code
+ * const double* decoded = decoder.values();   // metres, owned by the decoder
+ * span<const Meter> d = as_quantities<MeterTag>(decoded, decoder.count());
+ * Meter total = batch::sum(d.data(), d.size());
+ *
+ * std::vector<Second> t = ...;
+ * span<double> raw = as_doubles(t);           // hand to a numeric library
+ * @endcode
+ */
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#if defined(__has_include)
+#if __has_include(<version>)
+#include <version>
+#endif
+#endif
+
+#if defined(__cpp_lib_span) && __cpp_lib_span >= 202002L
+#include <span>
+#define QTTY_HAS_STD_SPAN 1
+#else
+#define QTTY_HAS_STD_SPAN 0
+#endif
+
+#include "ffi_core.hpp"
+#include "detail/simd.hpp"
+
+namespace qtty {
+
+#if QTTY_HAS_STD_SPAN
+
+template<typename T>
+using span = std::span<T>;
+
+#else
+
+// Dynamic-extent subset of std::span
+template<typename T>
+class span {
+public:
+    using element_type = T;
+    using value_type = typename std::remove_cv<T>::type;
+    using size_type = std::size_t;
+    using pointer = T*;
+    using reference = T&;
+    using iterator = T*;
+
+    constexpr span() noexcept = default;
+    constexpr span(T* data, std::size_t size) noexcept : data_(data), size_(size) {}
+
+    template<std::size_t N>
+    constexpr span(T (&array)[N]) noexcept : data_(array), size_(N) {}
+
+    // Any contiguous container whose data() converts to T*
+    template<typename Container,
+             typename = typename std::enable_if<
+                 !std::is_same<typename std::decay<Container>::type, span>::value &&
+                 std::is_convertible<decltype(std::declval<Container&>().data()), T*>::value>::type>
+    constexpr span(Container& c) noexcept : data_(c.data()), size_(c.size()) {}
+
+    // span<U> -> span<const U>
+    template<typename U,
+             typename = typename std::enable_if<std::is_convertible<U (*)[], T (*)[]>::value>::type>
+    constexpr span(const span<U>& other) noexcept : data_(other.data()), size_(other.size()) {}
+
+    constexpr T* data() const noexcept {
+        return data_;
+    }
+
+    constexpr std::size_t size() const noexcept {
+        return size_;
+    }
+
+    constexpr std::size_t size_bytes() const noexcept {
+        return size_ * sizeof(T);
+    }
+
+    constexpr bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    constexpr T& operator[](std::size_t i) const {
+        return data_[i];
+    }
+
+    constexpr T& front() const {
+        return data_[0];
+    }
+
+    constexpr T& back() const {
+        return data_[size_ - 1];
+    }
+
+    constexpr T* begin() const noexcept {
+        return data_;
+    }
+
+    constexpr T* end() const noexcept {
+        return data_ + size_;
+    }
+
+    constexpr span first(std::size_t count) const {
+        return span(data_, count);
+    }
+
+    constexpr span last(std::size_t count) const {
+        return span(data_ + (size_ - count), count);
+    }
+
+    constexpr span subspan(std::size_t offset, std::size_t count = static_cast<std::size_t>(-1)) const {
+        return span(data_ + offset, count == static_cast<std::size_t>(-1) ? size_ - offset : count);
+    }
+
+private:
+    T* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+#endif
+
+// ============================================================================
+// Doubles -> Quantities
+// ============================================================================
+
+template<typename UnitTag>
+span<Quantity<UnitTag>> as_quantities(double* data, std::size_t n) {
+    static_assert(detail::check_quantity_layout<UnitTag>(), "");
+    return span<Quantity<UnitTag>>(reinterpret_cast<Quantity<UnitTag>*>(data), n);
+}
+
+template<typename UnitTag>
+span<const Quantity<UnitTag>> as_quantities(const double* data, std::size_t n) {
+    static_assert(detail::check_quantity_layout<UnitTag>(), "");
+    return span<const Quantity<UnitTag>>(reinterpret_cast<const Quantity<UnitTag>*>(data), n);
+}
+
+// Lvalue buffers only: a view of a temporary would dangle
+template<typename UnitTag, typename Buffer>
+auto as_quantities(Buffer& buffer) -> decltype(as_quantities<UnitTag>(buffer.data(), buffer.size())) {
+    return as_quantities<UnitTag>(buffer.data(), buffer.size());
+}
+
+template<typename UnitTag, typename Buffer>
+void as_quantities(const Buffer&& buffer) = delete;
+
+// Spans borrow their data, so temporaries are fine (and win overload
+// resolution over the deleted rvalue overload above)
+template<typename UnitTag>
+span<Quantity<UnitTag>> as_quantities(span<double> buffer) {
+    return as_quantities<UnitTag>(buffer.data(), buffer.size());
+}
+
+template<typename UnitTag>
+span<const Quantity<UnitTag>> as_quantities(span<const double> buffer) {
+    return as_quantities<UnitTag>(buffer.data(), buffer.size());
+}
+
+// ============================================================================
+// Quantities -> Doubles
+// ============================================================================
+
+template<typename UnitTag>
+span<double> as_doubles(Quantity<UnitTag>* data, std::size_t n) {
+    return span<double>(detail::raw(data), n);
+}
+
+template<typename UnitTag>
+span<const double> as_doubles(const Quantity<UnitTag>* data, std::size_t n) {
+    return span<const double>(detail::raw(data), n);
+}
+
+template<typename Buffer>
+auto as_doubles(Buffer& buffer) -> decltype(as_doubles(buffer.data(), buffer.size())) {
+    return as_doubles(buffer.data(), buffer.size());
+}
+
+template<typename Buffer>
+void as_doubles(const Buffer&& buffer) = delete;
+
+template<typename UnitTag>
+span<double> as_doubles(span<Quantity<UnitTag>> quantities) {
+    return as_doubles(quantities.data(), quantities.size());
+}
+
+template<typename UnitTag>
+span<const double> as_doubles(span<const Quantity<UnitTag>> quantities) {
+    return as_doubles(quantities.data(), quantities.size());
+}
+
+} // namespace qtty
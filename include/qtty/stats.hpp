@@ -0,0 +1,254 @@
+#pragma once
+
+/**
+ * @file stats.hpp
+ * @brief Streaming, mergeable statistics over quantities
+ *
+ * RunningStats<Q> tracks count, compensated sum, mean, variance, min and max
+ * of a stream of Q values. Results are typed: mean/min/max/sum are Q and
+ * variances are Squared<Q> (math.hpp).
+ *
+ * - Single values update with Welford's algorithm.
+ * - Arrays are consumed in blocks. Each block's sum (lane-wise Neumaier),
+ *   min/max and centered sum of squares are flat vectorizable loops. The
+ *   block is then folded in with Chan et al.'s pairwise update, the same
+ *   one merge() uses.
+ * - merge() combines partial accumulators, e.g. one per thread.
+ *   batch::stats() does this over a thread split of an array.
+ *
+ * Merging in a different order can change the last bits of the results.
+ *
+ * Usage example:
+ * @code
+ * RunningStats<Millisecond> latency;
+ * latency.push(Millisecond(12.5));
+ * latency.push(samples.data(), samples.size());
+ * Millisecond mu = latency.mean();
+ * Squared<Millisecond> var = latency.variance();
+ *
+ * RunningStats<Watt> all = batch::stats(readings.data(), readings.size());
+ * @endcode
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "ffi_core.hpp"
+#include "math.hpp"
+#include "detail/parallel.hpp"
+#include "detail/simd.hpp"
+
+namespace qtty {
+
+namespace detail {
+
+inline constexpr std::size_t kStatsBlock = 1024;
+inline constexpr std::size_t kStatsLanes = 8;
+
+// Neumaier step: s + x with the rounding error accumulated into c
+inline void neumaier_add(double& s, double& c, double x) {
+    const double t = s + x;
+    c += std::fabs(s) >= std::fabs(x) ? (s - t) + x : (x - t) + s;
+    s = t;
+}
+
+struct BlockStats {
+    double sum;
+    double sum_comp;
+    double min;
+    double max;
+    double m2;
+    bool nan;
+};
+
+// Sum (lane-wise Neumaier), min, max and centered sum of squares of x[0, n)
+inline BlockStats block_stats(const double* x, std::size_t n) {
+    double s[kStatsLanes] = {}, c[kStatsLanes] = {}, nans[kStatsLanes] = {};
+    double lo[kStatsLanes], hi[kStatsLanes];
+    for (std::size_t l = 0; l < kStatsLanes; ++l) {
+        lo[l] = std::numeric_limits<double>::infinity();
+        hi[l] = -std::numeric_limits<double>::infinity();
+    }
+    const std::size_t whole = n - n % kStatsLanes;
+    for (std::size_t i = 0; i < whole; i += kStatsLanes) {
+        QTTY_SIMD_LOOP
+        for (std::size_t l = 0; l < kStatsLanes; ++l) {
+            const double v = x[i + l];
+            const double t = s[l] + v;
+            c[l] += std::fabs(s[l]) >= std::fabs(v) ? (s[l] - t) + v : (v - t) + s[l];
+            s[l] = t;
+            lo[l] = v < lo[l] ? v : lo[l];
+            hi[l] = v > hi[l] ? v : hi[l];
+            nans[l] += v != v ? 1.0 : 0.0;
+        }
+    }
+    for (std::size_t i = whole; i < n; ++i) {
+        const std::size_t l = i - whole;
+        neumaier_add(s[l], c[l], x[i]);
+        lo[l] = std::min(lo[l], x[i]);
+        hi[l] = std::max(hi[l], x[i]);
+        nans[l] += std::isnan(x[i]) ? 1.0 : 0.0;
+    }
+
+    BlockStats b = {0.0, 0.0, lo[0], hi[0], 0.0, false};
+    for (std::size_t l = 0; l < kStatsLanes; ++l) {
+        b.nan = b.nan || nans[l] > 0.0;
+        neumaier_add(b.sum, b.sum_comp, s[l]);
+        b.sum_comp += c[l];
+        b.min = std::min(b.min, lo[l]);
+        b.max = std::max(b.max, hi[l]);
+    }
+    const double mean = (b.sum + b.sum_comp) / static_cast<double>(n);
+    double m2 = 0.0;
+    QTTY_SIMD_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        const double d = x[i] - mean;
+        m2 += d * d;
+    }
+    b.m2 = m2;
+    return b;
+}
+
+} // namespace detail
+
+template<typename Q>
+class RunningStats {
+public:
+    RunningStats() = default;
+
+    void push(const Q& q) {
+        const double x = q.value();
+        ++count_;
+        const double delta = x - mean_;
+        mean_ += delta / static_cast<double>(count_);
+        m2_ += delta * (x - mean_);
+        detail::neumaier_add(sum_, comp_, x);
+        min_ = std::min(min_, x);
+        max_ = std::max(max_, x);
+        nan_ = nan_ || std::isnan(x);
+    }
+
+    void push(const Q* values, std::size_t n) {
+        const double* x = detail::raw(values);
+        for (std::size_t base = 0; base < n; base += detail::kStatsBlock) {
+            const std::size_t m = std::min(detail::kStatsBlock, n - base);
+            const detail::BlockStats b = detail::block_stats(x + base, m);
+            RunningStats block;
+            block.count_ = m;
+            block.sum_ = b.sum;
+            block.comp_ = b.sum_comp;
+            block.mean_ = (b.sum + b.sum_comp) / static_cast<double>(m);
+            block.m2_ = b.m2;
+            block.min_ = b.min;
+            block.max_ = b.max;
+            block.nan_ = b.nan;
+            merge(block);
+        }
+    }
+
+    // Fold another accumulator in (Chan et al. parallel update)
+    void merge(const RunningStats& other) {
+        if (other.count_ == 0) {
+            return;
+        }
+        if (count_ == 0) {
+            *this = other;
+            return;
+        }
+        const double na = static_cast<double>(count_);
+        const double nb = static_cast<double>(other.count_);
+        const double n = na + nb;
+        const double delta = other.mean_ - mean_;
+        mean_ += delta * (nb / n);
+        m2_ += other.m2_ + delta * delta * (na * nb / n);
+        count_ += other.count_;
+        detail::neumaier_add(sum_, comp_, other.sum_);
+        comp_ += other.comp_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+        nan_ = nan_ || other.nan_;
+    }
+
+    std::uint64_t count() const {
+        return count_;
+    }
+
+    Q sum() const {
+        return Q(sum_ + comp_);
+    }
+
+    // NaN when empty
+    Q mean() const {
+        return Q(count_ == 0 ? std::numeric_limits<double>::quiet_NaN() : mean_);
+    }
+
+    // Population variance; NaN when empty
+    Squared<Q> variance() const {
+        return Squared<Q>(count_ == 0 ? std::numeric_limits<double>::quiet_NaN()
+                                      : m2_ / static_cast<double>(count_));
+    }
+
+    // Unbiased sample variance; NaN below two values
+    Squared<Q> sample_variance() const {
+        return Squared<Q>(count_ < 2 ? std::numeric_limits<double>::quiet_NaN()
+                                     : m2_ / static_cast<double>(count_ - 1));
+    }
+
+    Q stddev() const {
+        return Q(std::sqrt(variance().value()));
+    }
+
+    Q sample_stddev() const {
+        return Q(std::sqrt(sample_variance().value()));
+    }
+
+    // NaN when empty or when any value was NaN
+    Q min() const {
+        return Q(count_ == 0 || nan_ ? std::numeric_limits<double>::quiet_NaN() : min_);
+    }
+
+    Q max() const {
+        return Q(count_ == 0 || nan_ ? std::numeric_limits<double>::quiet_NaN() : max_);
+    }
+
+private:
+    std::uint64_t count_ = 0;
+    double mean_ = 0.0;
+    double m2_ = 0.0;
+    double sum_ = 0.0;
+    double comp_ = 0.0;
+    double min_ = std::numeric_limits<double>::infinity();
+    double max_ = -std::numeric_limits<double>::infinity();
+    bool nan_ = false;
+};
+
+namespace batch {
+
+// Statistics of values[0, n), accumulated per thread and merged in order
+template<typename UnitTag>
+RunningStats<Quantity<UnitTag>> stats(const Quantity<UnitTag>* values, std::size_t n,
+                                      unsigned threads = 0) {
+    const unsigned workers = detail::worker_count(n, threads);
+    std::vector<RunningStats<Quantity<UnitTag>>> partial(workers);
+    const std::size_t chunk = (n + workers - 1) / workers;
+    detail::parallel_for(workers, workers, [&](std::size_t wb, std::size_t we) {
+        for (std::size_t w = wb; w < we; ++w) {
+            const std::size_t begin = std::min(n, w * chunk);
+            const std::size_t end = std::min(n, begin + chunk);
+            partial[w].push(values + begin, end - begin);
+        }
+    }, 1);
+    RunningStats<Quantity<UnitTag>> total;
+    for (const auto& p : partial) {
+        total.merge(p);
+    }
+    return total;
+}
+
+} // namespace batch
+
+} // namespace qtty
@@ -0,0 +1,520 @@
+#pragma once
+
+/**
+ * @file stream.hpp
+ * @brief Coroutine generators and tasks for batched quantity streams (C++20)
+ *
+ * Ingest code that receives data incrementally (files, sockets, queues) can
+ * be written as a chain of coroutine stages that pass batches along:
+ *
+ * - Generator<T>: a pull-based coroutine that co_yields values. A producer
+ *   only runs when the consumer asks for the next value, so a slow
+ *   consumer naturally throttles its producers (backpressure). No stage
+ *   buffers more than one batch.
+ * - Batch<Q> = span<const Q>: a view of a producer-owned buffer. It is
+ *   valid until the consumer asks for the next batch. Coroutine switches
+ *   happen once per batch rather than once per element, so their cost is
+ *   amortized over the batch size.
+ * - Task<T>: a lazy coroutine returning T. It can be co_awaited from
+ *   another Task and run with sync_wait().
+ *
+ * Stages:
+ * - from_span(data, batch_size): source that slices an existing array.
+ * - convert<Unit>(in): rescales each batch with batch::convert into a
+ *   reused buffer.
+ * - parse<Unit>(lines): parses batches of JSON values through
+ *   serialization::from_json_value.
+ * - prefetch(in, depth): runs the upstream stages on a background thread,
+ *   at most `depth` batches ahead. It blocks when full, which is bounded
+ *   backpressure. This overlaps upstream I/O with downstream computation.
+ * - aggregate(in): Task that folds every batch into a RunningStats<Q>.
+ *
+ * Exceptions thrown in any stage propagate to the consumer, including from
+ * the prefetch thread.
+ *
+ * The header is empty unless the compiler supports coroutines
+ * (QTTY_HAS_COROUTINES).
+ *
+ * Usage example:
+ * @code
+ * stream::Generator<stream::Batch<Meter>> read_file(std::string path);  // user source
+ *
+ * auto stats = stream::sync_wait(stream::aggregate(
+ *     stream::convert<KilometerTag>(stream::prefetch(read_file("d.bin"), 4))));
+ * Kilometer mean = stats.mean();
+ * @endcode
+ */
+
+#if defined(__has_include)
+#if __has_include(<coroutine>) && defined(__cpp_impl_coroutine)
+#define QTTY_HAS_COROUTINES 1
+#endif
+#endif
+#ifndef QTTY_HAS_COROUTINES
+#define QTTY_HAS_COROUTINES 0
+#endif
+
+#if QTTY_HAS_COROUTINES
+
+#include <algorithm>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "convert.hpp"
+#include "ffi_core.hpp"
+#include "serialization.hpp"
+#include "span.hpp"
+#include "stats.hpp"
+
+namespace qtty {
+namespace stream {
+
+template<typename Q>
+using Batch = span<const Q>;
+
+// ============================================================================
+// Generator
+// ============================================================================
+
+template<typename T>
+class Generator {
+public:
+    struct promise_type {
+        const T* value = nullptr;
+        std::exception_ptr error;
+
+        Generator get_return_object() {
+            return Generator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+
+        std::suspend_always final_suspend() noexcept {
+            return {};
+        }
+
+        // The yielded object lives in the coroutine frame until resumption
+        std::suspend_always yield_value(const T& v) noexcept {
+            value = std::addressof(v);
+            return {};
+        }
+
+        void return_void() noexcept {}
+
+        void unhandled_exception() {
+            error = std::current_exception();
+        }
+
+        // Generators are synchronous; await inside a Task instead
+        template<typename U>
+        void await_transform(U&&) = delete;
+    };
+
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+        explicit iterator(Generator* g) : g_(g) {}
+
+        const T& operator*() const {
+            return g_->value();
+        }
+
+        iterator& operator++() {
+            if (!g_->next()) {
+                g_ = nullptr;
+            }
+            return *this;
+        }
+
+        void operator++(int) {
+            ++*this;
+        }
+
+        friend bool operator==(const iterator& it, std::default_sentinel_t) {
+            return it.g_ == nullptr;
+        }
+
+    private:
+        Generator* g_ = nullptr;
+    };
+
+    Generator() = default;
+
+    Generator(Generator&& other) noexcept : h_(std::exchange(other.h_, {})) {}
+
+    Generator& operator=(Generator&& other) noexcept {
+        if (this != &other) {
+            reset();
+            h_ = std::exchange(other.h_, {});
+        }
+        return *this;
+    }
+
+    Generator(const Generator&) = delete;
+    Generator& operator=(const Generator&) = delete;
+
+    ~Generator() {
+        reset();
+    }
+
+    // Runs the producer to its next co_yield; false once it has finished
+    bool next() {
+        if (!h_ || h_.done()) {
+            return false;
+        }
+        h_.resume();
+        if (h_.done()) {
+            if (h_.promise().error) {
+                std::rethrow_exception(std::exchange(h_.promise().error, nullptr));
+            }
+            return false;
+        }
+        return true;
+    }
+
+    const T& value() const {
+        return *h_.promise().value;
+    }
+
+    iterator begin() {
+        return next() ? iterator(this) : iterator();
+    }
+
+    std::default_sentinel_t end() const noexcept {
+        return {};
+    }
+
+private:
+    std::coroutine_handle<promise_type> h_;
+
+    explicit Generator(std::coroutine_handle<promise_type> h) : h_(h) {}
+
+    void reset() {
+        if (h_) {
+            h_.destroy();
+            h_ = {};
+        }
+    }
+};
+
+// ============================================================================
+// Task
+// ============================================================================
+
+namespace detail {
+
+template<typename T>
+struct TaskResult {
+    std::variant<std::monostate, T, std::exception_ptr> result;
+
+    template<typename U>
+    void return_value(U&& v) {
+        result.template emplace<1>(std::forward<U>(v));
+    }
+
+    void unhandled_exception() {
+        result.template emplace<2>(std::current_exception());
+    }
+
+    T take() {
+        if (result.index() == 2) {
+            std::rethrow_exception(std::get<2>(result));
+        }
+        return std::move(std::get<1>(result));
+    }
+};
+
+template<>
+struct TaskResult<void> {
+    std::exception_ptr error;
+
+    void return_void() noexcept {}
+
+    void unhandled_exception() {
+        error = std::current_exception();
+    }
+
+    void take() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+} // namespace detail
+
+template<typename T = void>
+class Task {
+public:
+    struct promise_type : detail::TaskResult<T> {
+        std::coroutine_handle<> continuation;
+
+        Task get_return_object() {
+            return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+
+        struct final_awaiter {
+            bool await_ready() noexcept {
+                return false;
+            }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                auto c = h.promise().continuation;
+                return c ? c : std::noop_coroutine();
+            }
+
+            void await_resume() noexcept {}
+        };
+
+        final_awaiter final_suspend() noexcept {
+            return {};
+        }
+    };
+
+    Task(Task&& other) noexcept : h_(std::exchange(other.h_, {})) {}
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    Task& operator=(Task&&) = delete;
+
+    ~Task() {
+        if (h_) {
+            h_.destroy();
+        }
+    }
+
+    // co_await starts the task and resumes the awaiter when it finishes
+    auto operator co_await() && noexcept {
+        struct awaiter {
+            std::coroutine_handle<promise_type> h;
+
+            bool await_ready() noexcept {
+                return false;
+            }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> cont) noexcept {
+                h.promise().continuation = cont;
+                return h;
+            }
+
+            T await_resume() {
+                return h.promise().take();
+            }
+        };
+        return awaiter{h_};
+    }
+
+private:
+    template<typename U>
+    friend U sync_wait(Task<U>&& task);
+
+    std::coroutine_handle<promise_type> h_;
+
+    explicit Task(std::coroutine_handle<promise_type> h) : h_(h) {}
+};
+
+// Runs the task on the calling thread and returns its result. The stages
+// in this header complete synchronously (prefetch blocks on its queue), so
+// the task has finished when resume() returns.
+template<typename T>
+T sync_wait(Task<T>&& task) {
+    task.h_.resume();
+    if (!task.h_.done()) {
+        throw std::logic_error("sync_wait: task suspended on an asynchronous operation");
+    }
+    return task.h_.promise().take();
+}
+
+// ============================================================================
+// Stages
+// ============================================================================
+
+// Slices data into batches of batch_size (the last one may be shorter)
+template<typename Q>
+Generator<Batch<Q>> from_span(span<const Q> data, std::size_t batch_size) {
+    if (batch_size == 0) {
+        throw std::invalid_argument("Stream batch size must be positive");
+    }
+    for (std::size_t i = 0; i < data.size(); i += batch_size) {
+        co_yield Batch<Q>(data.data() + i, std::min(batch_size, data.size() - i));
+    }
+}
+
+template<typename Unit, typename SourceTag>
+Generator<Batch<Quantity<typename ExtractTag<Unit>::type>>>
+convert(Generator<Batch<Quantity<SourceTag>>> in) {
+    using Target = Quantity<typename ExtractTag<Unit>::type>;
+    std::vector<Target> buf;
+    for (const auto& batch : in) {
+        buf.resize(batch.size());
+        batch::convert(batch.data(), buf.data(), batch.size());
+        co_yield Batch<Target>(buf.data(), buf.size());
+    }
+}
+
+// Each string is a JSON number in Unit (serialization::from_json_value)
+template<typename Unit>
+Generator<Batch<Quantity<typename ExtractTag<Unit>::type>>>
+parse(Generator<Batch<std::string>> lines) {
+    using Target = Quantity<typename ExtractTag<Unit>::type>;
+    std::vector<Target> buf;
+    for (const auto& batch : lines) {
+        buf.resize(batch.size());
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            buf[i] = serialization::from_json_value<Unit>(batch[i]);
+        }
+        co_yield Batch<Target>(buf.data(), buf.size());
+    }
+}
+
+namespace detail {
+
+// Bounded hand-off between the prefetch thread and the consumer. Buffers
+// are recycled so steady-state streaming does not allocate.
+template<typename Q>
+class BatchQueue {
+public:
+    explicit BatchQueue(std::size_t depth) : depth_(depth) {}
+
+    // Blocks while full; false once the consumer has gone away
+    bool push(const Batch<Q>& batch) {
+        std::unique_lock<std::mutex> lock(m_);
+        not_full_.wait(lock, [&] { return ready_.size() < depth_ || cancelled_; });
+        if (cancelled_) {
+            return false;
+        }
+        std::vector<Q> buf;
+        if (!free_.empty()) {
+            buf = std::move(free_.back());
+            free_.pop_back();
+        }
+        lock.unlock();
+        buf.assign(batch.begin(), batch.end());
+        lock.lock();
+        ready_.push_back(std::move(buf));
+        not_empty_.notify_one();
+        return true;
+    }
+
+    void close(std::exception_ptr error = nullptr) {
+        std::lock_guard<std::mutex> lock(m_);
+        closed_ = true;
+        error_ = error;
+        not_empty_.notify_one();
+    }
+
+    void cancel() {
+        std::lock_guard<std::mutex> lock(m_);
+        cancelled_ = true;
+        not_full_.notify_one();
+    }
+
+    // Swaps the next batch into `out` (returning the old buffer for reuse);
+    // false at the end of the stream. Rethrows the producer's exception.
+    bool pop(std::vector<Q>& out) {
+        std::unique_lock<std::mutex> lock(m_);
+        not_empty_.wait(lock, [&] { return !ready_.empty() || closed_; });
+        if (out.capacity() != 0) {
+            free_.push_back(std::move(out));
+        }
+        if (!ready_.empty()) {
+            out = std::move(ready_.front());
+            ready_.pop_front();
+            not_full_.notify_one();
+            return true;
+        }
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+        return false;
+    }
+
+private:
+    std::size_t depth_;
+    std::mutex m_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+    std::deque<std::vector<Q>> ready_;
+    std::vector<std::vector<Q>> free_;
+    bool closed_ = false;
+    bool cancelled_ = false;
+    std::exception_ptr error_;
+};
+
+// Cancels and joins the producer when the consuming frame is destroyed
+template<typename Q>
+struct ProducerGuard {
+    BatchQueue<Q>& queue;
+    std::thread& thread;
+
+    ~ProducerGuard() {
+        queue.cancel();
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+};
+
+} // namespace detail
+
+// Drives `in` on a background thread, keeping up to `depth` batches ready
+template<typename Q>
+Generator<Batch<Q>> prefetch(Generator<Batch<Q>> in, std::size_t depth = 2) {
+    if (depth == 0) {
+        throw std::invalid_argument("Prefetch depth must be positive");
+    }
+    detail::BatchQueue<Q> queue(depth);
+    std::thread producer([&queue, up = std::move(in)]() mutable {
+        try {
+            for (const auto& batch : up) {
+                if (!queue.push(batch)) {
+                    return;
+                }
+            }
+            queue.close();
+        } catch (...) {
+            queue.close(std::current_exception());
+        }
+    });
+    detail::ProducerGuard<Q> guard{queue, producer};
+    std::vector<Q> current;
+    while (queue.pop(current)) {
+        co_yield Batch<Q>(current.data(), current.size());
+    }
+}
+
+// Folds every batch into running statistics
+template<typename Q>
+Task<RunningStats<Q>> aggregate(Generator<Batch<Q>> in) {
+    RunningStats<Q> stats;
+    for (const auto& batch : in) {
+        stats.push(batch.data(), batch.size());
+    }
+    co_return stats;
+}
+
+} // namespace stream
+} // namespace qtty
+
+#endif // QTTY_HAS_COROUTINES
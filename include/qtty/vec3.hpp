@@ -0,0 +1,311 @@
+#pragma once
+
+/**
+ * @file vec3.hpp
+ * @brief Unit-typed 3-vectors and structure-of-arrays vector columns
+ *
+ * Vec3<Q> holds three components of the same Quantity type Q. Operations
+ * carry the dimension through, using the power types from math.hpp:
+ *
+ *     dot(Vec3<Meter>, Vec3<Meter>)   -> Squared<Meter>   (m^2)
+ *     cross(Vec3<Meter>, Vec3<Meter>) -> Vec3<Squared<Meter>>
+ *     norm(Vec3<Meter>)               -> Meter
+ *
+ * Vec3Array<Q> stores millions of vectors as three separate columns (x, y, z)
+ * so that the batch kernels below are straight vectorizable loops. Unit
+ * conversion of a whole array applies one factor to every component (see
+ * convert.hpp).
+ *
+ * Usage example:
+ * @code
+ * Vec3<Meter> r{Meter(1.0), Meter(2.0), Meter(2.0)};
+ * Meter len = norm(r);                           // 3 m
+ * Vec3<Kilometer> r_km = r.to<KilometerTag>();
+ *
+ * Vec3Array<Meter> pos(n);
+ * std::vector<Meter> dist(n);
+ * batch::norm(pos, dist.data());
+ * Vec3Array<Kilometer> pos_km = pos.to<KilometerTag>();
+ * @endcode
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include "ffi_core.hpp"
+#include "math.hpp"
+#include "convert.hpp"
+#include "detail/simd.hpp"
+
+namespace qtty {
+
+template<typename Q>
+struct Vec3 {
+    using quantity_type = Q;
+    using unit_tag = typename Q::unit_tag;
+
+    Q x;
+    Q y;
+    Q z;
+
+    template<typename TargetTag>
+    Vec3<Quantity<TargetTag>> to() const {
+        const double f = conversion_factor<unit_tag, TargetTag>();
+        return {Quantity<TargetTag>(x.value() * f), Quantity<TargetTag>(y.value() * f),
+                Quantity<TargetTag>(z.value() * f)};
+    }
+
+    Vec3 operator+(const Vec3& o) const {
+        return {x + o.x, y + o.y, z + o.z};
+    }
+
+    Vec3 operator-(const Vec3& o) const {
+        return {x - o.x, y - o.y, z - o.z};
+    }
+
+    Vec3 operator-() const {
+        return {-x, -y, -z};
+    }
+
+    Vec3 operator*(double s) const {
+        return {x * s, y * s, z * s};
+    }
+
+    Vec3 operator/(double s) const {
+        return {x / s, y / s, z / s};
+    }
+
+    friend Vec3 operator*(double s, const Vec3& v) {
+        return v * s;
+    }
+
+    Vec3& operator+=(const Vec3& o) {
+        x += o.x;
+        y += o.y;
+        z += o.z;
+        return *this;
+    }
+
+    Vec3& operator-=(const Vec3& o) {
+        x -= o.x;
+        y -= o.y;
+        z -= o.z;
+        return *this;
+    }
+
+    Vec3& operator*=(double s) {
+        x *= s;
+        y *= s;
+        z *= s;
+        return *this;
+    }
+
+    bool operator==(const Vec3& o) const {
+        return x == o.x && y == o.y && z == o.z;
+    }
+
+    bool operator!=(const Vec3& o) const {
+        return !(*this == o);
+    }
+};
+
+// ============================================================================
+// Dimensioned Vector Products
+// ============================================================================
+
+template<typename Q>
+Squared<Q> dot(const Vec3<Q>& a, const Vec3<Q>& b) {
+    return Squared<Q>(a.x.value() * b.x.value() + a.y.value() * b.y.value() +
+                      a.z.value() * b.z.value());
+}
+
+template<typename Q>
+Vec3<Squared<Q>> cross(const Vec3<Q>& a, const Vec3<Q>& b) {
+    const double ax = a.x.value(), ay = a.y.value(), az = a.z.value();
+    const double bx = b.x.value(), by = b.y.value(), bz = b.z.value();
+    return {Squared<Q>(ay * bz - az * by), Squared<Q>(az * bx - ax * bz),
+            Squared<Q>(ax * by - ay * bx)};
+}
+
+template<typename Q>
+Squared<Q> norm2(const Vec3<Q>& a) {
+    return dot(a, a);
+}
+
+template<typename Q>
+Q norm(const Vec3<Q>& a) {
+    return Q(std::sqrt(norm2(a).value()));
+}
+
+template<typename Q>
+Q distance(const Vec3<Q>& a, const Vec3<Q>& b) {
+    return norm(a - b);
+}
+
+// ============================================================================
+// Structure-of-Arrays Columns
+// ============================================================================
+
+template<typename Q>
+class Vec3Array {
+public:
+    using quantity_type = Q;
+    using unit_tag = typename Q::unit_tag;
+
+    Vec3Array() = default;
+
+    explicit Vec3Array(std::size_t n) : x_(n), y_(n), z_(n) {}
+
+    std::size_t size() const {
+        return x_.size();
+    }
+
+    bool empty() const {
+        return x_.empty();
+    }
+
+    void resize(std::size_t n) {
+        x_.resize(n);
+        y_.resize(n);
+        z_.resize(n);
+    }
+
+    void reserve(std::size_t n) {
+        x_.reserve(n);
+        y_.reserve(n);
+        z_.reserve(n);
+    }
+
+    void push_back(const Vec3<Q>& v) {
+        x_.push_back(v.x);
+        y_.push_back(v.y);
+        z_.push_back(v.z);
+    }
+
+    Vec3<Q> operator[](std::size_t i) const {
+        return {x_[i], y_[i], z_[i]};
+    }
+
+    void set(std::size_t i, const Vec3<Q>& v) {
+        x_[i] = v.x;
+        y_[i] = v.y;
+        z_[i] = v.z;
+    }
+
+    Q* x() { return x_.data(); }
+    Q* y() { return y_.data(); }
+    Q* z() { return z_.data(); }
+    const Q* x() const { return x_.data(); }
+    const Q* y() const { return y_.data(); }
+    const Q* z() const { return z_.data(); }
+
+    // Whole array in another unit; one factor for all components
+    template<typename TargetTag>
+    Vec3Array<Quantity<TargetTag>> to() const {
+        Vec3Array<Quantity<TargetTag>> out(size());
+        batch::convert(x(), out.x(), size());
+        batch::convert(y(), out.y(), size());
+        batch::convert(z(), out.z(), size());
+        return out;
+    }
+
+private:
+    std::vector<Q> x_;
+    std::vector<Q> y_;
+    std::vector<Q> z_;
+};
+
+// ============================================================================
+// Batch Vector Kernels
+// ============================================================================
+// Binary kernels require operands of equal size and throw
+// std::invalid_argument otherwise. Vec3Array outputs are resized to fit;
+// pointer outputs must hold a.size() elements.
+
+namespace detail {
+
+template<typename QA, typename QB>
+void check_same_size(const Vec3Array<QA>& a, const Vec3Array<QB>& b) {
+    if (a.size() != b.size()) {
+        throw std::invalid_argument("Vec3Array operands differ in size");
+    }
+}
+
+} // namespace detail
+
+namespace batch {
+
+template<typename Q>
+void dot(const Vec3Array<Q>& a, const Vec3Array<Q>& b, Squared<Q>* out) {
+    detail::check_same_size(a, b);
+    const double *ax = detail::raw(a.x()), *ay = detail::raw(a.y()), *az = detail::raw(a.z());
+    const double *bx = detail::raw(b.x()), *by = detail::raw(b.y()), *bz = detail::raw(b.z());
+    double* r = detail::raw(out);
+    const std::size_t n = a.size();
+    QTTY_SIMD_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        r[i] = ax[i] * bx[i] + ay[i] * by[i] + az[i] * bz[i];
+    }
+}
+
+template<typename Q>
+void cross(const Vec3Array<Q>& a, const Vec3Array<Q>& b, Vec3Array<Squared<Q>>& out) {
+    detail::check_same_size(a, b);
+    out.resize(a.size());
+    const double *ax = detail::raw(a.x()), *ay = detail::raw(a.y()), *az = detail::raw(a.z());
+    const double *bx = detail::raw(b.x()), *by = detail::raw(b.y()), *bz = detail::raw(b.z());
+    double *rx = detail::raw(out.x()), *ry = detail::raw(out.y()), *rz = detail::raw(out.z());
+    const std::size_t n = a.size();
+    QTTY_SIMD_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        rx[i] = ay[i] * bz[i] - az[i] * by[i];
+        ry[i] = az[i] * bx[i] - ax[i] * bz[i];
+        rz[i] = ax[i] * by[i] - ay[i] * bx[i];
+    }
+}
+
+template<typename Q>
+void norm(const Vec3Array<Q>& a, Q* out) {
+    const double *ax = detail::raw(a.x()), *ay = detail::raw(a.y()), *az = detail::raw(a.z());
+    double* r = detail::raw(out);
+    const std::size_t n = a.size();
+    QTTY_SIMD_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        r[i] = std::sqrt(ax[i] * ax[i] + ay[i] * ay[i] + az[i] * az[i]);
+    }
+}
+
+// out = a + b * s (e.g. position + velocity * dt with s in matching units)
+template<typename Q>
+void axpy(const Vec3Array<Q>& a, const Vec3Array<Q>& b, double s, Vec3Array<Q>& out) {
+    detail::check_same_size(a, b);
+    out.resize(a.size());
+    const std::size_t n = a.size();
+    const Q* in_a[3] = {a.x(), a.y(), a.z()};
+    const Q* in_b[3] = {b.x(), b.y(), b.z()};
+    Q* res[3] = {out.x(), out.y(), out.z()};
+    for (int c = 0; c < 3; ++c) {
+        const double* p = detail::raw(in_a[c]);
+        const double* q = detail::raw(in_b[c]);
+        double* r = detail::raw(res[c]);
+        QTTY_SIMD_LOOP
+        for (std::size_t i = 0; i < n; ++i) {
+            r[i] = p[i] + q[i] * s;
+        }
+    }
+}
+
+// Convert every component into `out`, which is resized to fit
+template<typename Q, typename TargetTag>
+void convert(const Vec3Array<Q>& in, Vec3Array<Quantity<TargetTag>>& out) {
+    out.resize(in.size());
+    convert(in.x(), out.x(), in.size());
+    convert(in.y(), out.y(), in.size());
+    convert(in.z(), out.z(), in.size());
+}
+
+} // namespace batch
+
+} // namespace qtty
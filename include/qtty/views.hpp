@@ -0,0 +1,400 @@
+#pragma once
+
+/**
+ * @file views.hpp
+ * @brief Lazy range adaptors for unit conversion and raw-value projection
+ *
+ * These adaptors wrap a range without copying it and transform each element
+ * as it is read:
+ * - views::convert_to<Unit>: Quantity<S> elements become Quantity<Unit>.
+ *   The S -> Unit factor is resolved once, when the view is built, so each
+ *   element read is a single multiply.
+ * - views::values: Quantity<S> elements become their raw doubles.
+ * - views::as_quantity<Unit>: raw doubles become Quantity<Unit>, with no
+ *   conversion.
+ *
+ * Unit may be a tag or a Quantity type. Adaptors compose with `|` and can
+ * also be called directly:
+ *     views::convert_to<KilometerTag>(range)
+ * An lvalue range is referenced and must outlive the view. An rvalue range
+ * (another view, or a temporary container) is moved into the view.
+ *
+ * The adaptors only need C++17. When <ranges> is available, the views
+ * derive from std::ranges::view_base and their iterators declare an
+ * iterator_concept, so they compose with std::views in either direction.
+ * For example, filter first so that only the surviving elements are
+ * converted:
+ *
+ * @code
+ * std::vector<Meter> d = ...;
+ * for (Kilometer km : d | views::convert_to<KilometerTag>) { ... }
+ *
+ * auto far_km = d | std::views::filter([](Meter m) { return m > Meter(1e3); })
+ *                 | views::convert_to<Kilometer>;
+ * auto raw = d | views::values;                          // doubles
+ * auto typed = buffer | views::as_quantity<SecondTag>;   // Second
+ * @endcode
+ */
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#if defined(__has_include)
+#if __has_include(<version>)
+#include <version>
+#endif
+#endif
+
+#if defined(__cpp_lib_ranges) && __cpp_lib_ranges >= 201911L
+#include <ranges>
+#define QTTY_HAS_STD_RANGES 1
+#else
+#define QTTY_HAS_STD_RANGES 0
+#endif
+
+#include "ffi_core.hpp"
+
+namespace qtty {
+namespace views {
+
+namespace detail {
+
+#if QTTY_HAS_STD_RANGES
+using view_base = std::ranges::view_base;
+#else
+struct view_base {};
+#endif
+
+template<typename R>
+using iterator_of = decltype(std::begin(std::declval<R&>()));
+
+template<typename R>
+using sentinel_of = decltype(std::end(std::declval<R&>()));
+
+template<typename R>
+using element_of = typename std::decay<decltype(*std::begin(std::declval<R&>()))>::type;
+
+// Non-owning reference to an lvalue range
+template<typename R>
+class ref_range : public view_base {
+public:
+    ref_range() = default;
+    explicit ref_range(R& r) : r_(std::addressof(r)) {}
+
+    auto begin() const {
+        return std::begin(*r_);
+    }
+
+    auto end() const {
+        return std::end(*r_);
+    }
+
+    template<typename W = R>
+    auto size() const -> decltype(std::declval<W&>().size()) {
+        return r_->size();
+    }
+
+private:
+    R* r_ = nullptr;
+};
+
+// lvalue ranges are referenced, rvalues are moved in
+template<typename R>
+using stored_range = typename std::conditional<std::is_lvalue_reference<R>::value,
+                                               ref_range<typename std::remove_reference<R>::type>,
+                                               typename std::decay<R>::type>::type;
+
+template<typename R>
+stored_range<R&&> store(R&& r) {
+    if constexpr (std::is_lvalue_reference<R>::value) {
+        return stored_range<R&&>(r);
+    } else {
+        return std::move(r);
+    }
+}
+
+template<typename It>
+struct concept_of {
+    using category = typename std::iterator_traits<It>::iterator_category;
+    using type = typename std::conditional<
+        std::is_base_of<std::random_access_iterator_tag, category>::value,
+        std::random_access_iterator_tag,
+        typename std::conditional<
+            std::is_base_of<std::bidirectional_iterator_tag, category>::value,
+            std::bidirectional_iterator_tag,
+            typename std::conditional<std::is_base_of<std::forward_iterator_tag, category>::value,
+                                      std::forward_iterator_tag,
+                                      std::input_iterator_tag>::type>::type>::type;
+};
+
+// Iterator applying fn to each element of the base range. It yields
+// prvalues, so the legacy category is input; iterator_concept exposes the
+// base's real strength to C++20 ranges.
+template<typename It, typename Fn>
+class map_iterator {
+public:
+    using iterator_category = std::input_iterator_tag;
+    using iterator_concept = typename concept_of<It>::type;
+    using value_type = typename std::decay<decltype(std::declval<const Fn&>()(*std::declval<It&>()))>::type;
+    using difference_type = typename std::iterator_traits<It>::difference_type;
+    using reference = value_type;
+    using pointer = void;
+
+    map_iterator() = default;
+    map_iterator(It it, Fn fn) : it_(std::move(it)), fn_(fn) {}
+
+    const It& base() const {
+        return it_;
+    }
+
+    value_type operator*() const {
+        return fn_(*it_);
+    }
+
+    value_type operator[](difference_type n) const {
+        return fn_(it_[n]);
+    }
+
+    map_iterator& operator++() {
+        ++it_;
+        return *this;
+    }
+
+    map_iterator operator++(int) {
+        map_iterator tmp = *this;
+        ++it_;
+        return tmp;
+    }
+
+    map_iterator& operator--() {
+        --it_;
+        return *this;
+    }
+
+    map_iterator operator--(int) {
+        map_iterator tmp = *this;
+        --it_;
+        return tmp;
+    }
+
+    map_iterator& operator+=(difference_type n) {
+        it_ += n;
+        return *this;
+    }
+
+    map_iterator& operator-=(difference_type n) {
+        it_ -= n;
+        return *this;
+    }
+
+    friend map_iterator operator+(map_iterator a, difference_type n) {
+        a += n;
+        return a;
+    }
+
+    friend map_iterator operator+(difference_type n, map_iterator a) {
+        a += n;
+        return a;
+    }
+
+    friend map_iterator operator-(map_iterator a, difference_type n) {
+        a -= n;
+        return a;
+    }
+
+    friend difference_type operator-(const map_iterator& a, const map_iterator& b) {
+        return a.it_ - b.it_;
+    }
+
+    friend bool operator==(const map_iterator& a, const map_iterator& b) {
+        return a.it_ == b.it_;
+    }
+
+    friend bool operator!=(const map_iterator& a, const map_iterator& b) {
+        return !(a == b);
+    }
+
+    friend bool operator<(const map_iterator& a, const map_iterator& b) {
+        return a.it_ < b.it_;
+    }
+
+    friend bool operator>(const map_iterator& a, const map_iterator& b) {
+        return b < a;
+    }
+
+    friend bool operator<=(const map_iterator& a, const map_iterator& b) {
+        return !(b < a);
+    }
+
+    friend bool operator>=(const map_iterator& a, const map_iterator& b) {
+        return !(a < b);
+    }
+
+private:
+    It it_{};
+    Fn fn_{};
+};
+
+// End marker for base ranges whose end() is not an iterator
+template<typename S>
+class map_sentinel {
+public:
+    map_sentinel() = default;
+    explicit map_sentinel(S s) : s_(std::move(s)) {}
+
+    template<typename It, typename Fn>
+    friend bool operator==(const map_iterator<It, Fn>& it, const map_sentinel& s) {
+        return it.base() == s.s_;
+    }
+
+    template<typename It, typename Fn>
+    friend bool operator==(const map_sentinel& s, const map_iterator<It, Fn>& it) {
+        return it.base() == s.s_;
+    }
+
+    template<typename It, typename Fn>
+    friend bool operator!=(const map_iterator<It, Fn>& it, const map_sentinel& s) {
+        return !(it.base() == s.s_);
+    }
+
+    template<typename It, typename Fn>
+    friend bool operator!=(const map_sentinel& s, const map_iterator<It, Fn>& it) {
+        return !(it.base() == s.s_);
+    }
+
+private:
+    S s_{};
+};
+
+template<typename V, typename Fn>
+class map_view : public view_base {
+public:
+    map_view() = default;
+    map_view(V base, Fn fn) : base_(std::move(base)), fn_(fn) {}
+
+    auto begin() {
+        return map_iterator<iterator_of<V>, Fn>(std::begin(base_), fn_);
+    }
+
+    auto end() {
+        return make_end(base_);
+    }
+
+    template<typename W = const V, typename = iterator_of<W>>
+    auto begin() const {
+        return map_iterator<iterator_of<W>, Fn>(std::begin(base_), fn_);
+    }
+
+    template<typename W = const V, typename = iterator_of<W>>
+    auto end() const {
+        return make_end(base_);
+    }
+
+    template<typename W = V>
+    auto size() const -> decltype(std::declval<const W&>().size()) {
+        return base_.size();
+    }
+
+private:
+    V base_{};
+    Fn fn_{};
+
+    template<typename B>
+    auto make_end(B& b) const {
+        if constexpr (std::is_same<iterator_of<B>, sentinel_of<B>>::value) {
+            return map_iterator<iterator_of<B>, Fn>(std::end(b), fn_);
+        } else {
+            return map_sentinel<sentinel_of<B>>(std::end(b));
+        }
+    }
+};
+
+// ============================================================================
+// Element Functions
+// ============================================================================
+
+template<typename SourceTag, typename TargetTag>
+struct scale_to {
+    double factor = 1.0;
+
+    Quantity<TargetTag> operator()(const Quantity<SourceTag>& q) const {
+        return Quantity<TargetTag>(q.value() * factor);
+    }
+};
+
+struct value_of {
+    template<typename Tag>
+    double operator()(const Quantity<Tag>& q) const {
+        return q.value();
+    }
+};
+
+template<typename Tag>
+struct wrap_as {
+    Quantity<Tag> operator()(double v) const {
+        return Quantity<Tag>(v);
+    }
+};
+
+// ============================================================================
+// Adaptor Closures
+// ============================================================================
+
+template<typename Derived>
+struct closure {
+    template<typename R>
+    friend auto operator|(R&& r, const Derived& self) {
+        return self(std::forward<R>(r));
+    }
+};
+
+template<typename TargetTag>
+struct convert_to_fn : closure<convert_to_fn<TargetTag>> {
+    template<typename R>
+    auto operator()(R&& r) const {
+        using SourceTag = typename element_of<R>::unit_tag;
+        scale_to<SourceTag, TargetTag> fn{conversion_factor<SourceTag, TargetTag>()};
+        return map_view<stored_range<R&&>, decltype(fn)>(store(std::forward<R>(r)), fn);
+    }
+};
+
+struct values_fn : closure<values_fn> {
+    template<typename R>
+    auto operator()(R&& r) const {
+        return map_view<stored_range<R&&>, value_of>(store(std::forward<R>(r)), value_of{});
+    }
+};
+
+template<typename Tag>
+struct as_quantity_fn : closure<as_quantity_fn<Tag>> {
+    template<typename R>
+    auto operator()(R&& r) const {
+        static_assert(std::is_convertible<element_of<R>, double>::value,
+                      "views::as_quantity needs a range of doubles");
+        return map_view<stored_range<R&&>, wrap_as<Tag>>(store(std::forward<R>(r)), wrap_as<Tag>{});
+    }
+};
+
+} // namespace detail
+
+template<typename Unit>
+inline constexpr detail::convert_to_fn<typename ExtractTag<Unit>::type> convert_to{};
+
+inline constexpr detail::values_fn values{};
+
+template<typename Unit>
+inline constexpr detail::as_quantity_fn<typename ExtractTag<Unit>::type> as_quantity{};
+
+} // namespace views
+} // namespace qtty
+
+#if QTTY_HAS_STD_RANGES
+namespace std::ranges {
+// A referenced lvalue range is cheap to copy and does not own its elements
+template<typename R>
+inline constexpr bool enable_borrowed_range<qtty::views::detail::ref_range<R>> = true;
+} // namespace std::ranges
+#endif
@@ -0,0 +1,427 @@
+#pragma once
+
+/**
+ * @file wire.hpp
+ * @brief Compact framed binary encoding of quantity batches
+ *
+ * One frame carries one batch of values in a single unit:
+ *
+ *     offset  size  field
+ *          0     4  magic "QTTY"
+ *          4     1  version (1)
+ *          5     1  representation: 0 = float64, 1 = float32
+ *          6     2  reserved, 0
+ *          8     4  unit_id (UnitId)
+ *         12     4  count
+ *         16     -  count packed little-endian values
+ *
+ * The header is 16 bytes, so float64 payloads stay 8-byte aligned in any
+ * buffer that starts aligned. A float64 frame costs 8 bytes per value plus
+ * 16 per batch; JSON needs about 25 bytes per value.
+ *
+ * Encoding (namespace wire):
+ * - encoded_size(n, repr) is the size of a frame holding n values.
+ * - encode() writes a frame into a caller buffer or a new vector.
+ *   Float32 rounds each value to the nearest float.
+ *
+ * Decoding:
+ * - decode_header() validates a frame header. It throws
+ *   std::invalid_argument for bad magic, version or representation.
+ * - decode<Unit>() converts the values into the receiver's unit while it
+ *   unpacks them: one factor per frame and one multiply per value. A unit
+ *   of another dimension throws IncompatibleDimensionsError.
+ * - decode_in_place<Unit>() rescales a float64 frame inside its own buffer.
+ *   It returns a span of Quantity<Unit> that aliases the payload, with no
+ *   second buffer.
+ *
+ * On POSIX, FrameWriter and FrameReader move frames over nonblocking file
+ * descriptors (sockets, pipes):
+ * - FrameWriter queues encoded frames. flush() writes as many of them as
+ *   the fd accepts with one writev() per call, and resumes partial writes
+ *   on the next flush().
+ * - FrameReader::fill() reads what is available with readv() into its
+ *   buffer plus a 64 KiB spill area, so one call can drain a full socket
+ *   buffer. It stops once the reader's frame size limit is buffered, so a
+ *   fast peer cannot keep it reading or grow the buffer without bound.
+ *   next<Unit>() then decodes each complete frame.
+ * Both return instead of blocking on EAGAIN. Other errors throw
+ * std::system_error.
+ *
+ * Usage example:
+ * @code
+ * wire::FrameWriter tx(sock);
+ * tx.enqueue(ranges.data(), ranges.size());     // Meter, float64
+ * while (!tx.flush()) wait_writable(sock);
+ *
+ * wire::FrameReader rx(sock);
+ * std::vector<Kilometer> batch;
+ * while (rx.fill() > 0 || !rx.eof()) {
+ *     while (rx.next<Kilometer>(batch)) consume(batch);   // converted on decode
+ * }
+ * @endcode
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define QTTY_HAS_WIRE_IO 1
+#include <cerrno>
+#include <system_error>
+#include <sys/uio.h>
+#include <unistd.h>
+#else
+#define QTTY_HAS_WIRE_IO 0
+#endif
+
+#include "ffi_core.hpp"
+#include "span.hpp"
+#include "detail/bytes.hpp"
+#include "detail/factors.hpp"
+#include "detail/simd.hpp"
+
+namespace qtty {
+
+#if QTTY_HAS_WIRE_IO
+namespace detail {
+
+inline constexpr int kWireMaxIov = 64;
+inline constexpr std::size_t kWireReadSpill = 64 * 1024;
+
+inline bool would_block(int err) {
+    return err == EAGAIN || err == EWOULDBLOCK;
+}
+
+} // namespace detail
+#endif
+
+namespace wire {
+
+enum class Repr : std::uint8_t { Float64 = 0, Float32 = 1 };
+
+inline constexpr std::size_t kHeaderSize = 16;
+inline constexpr std::uint8_t kVersion = 1;
+
+struct FrameHeader {
+    UnitId unit;
+    Repr repr;
+    std::uint32_t count;
+
+    std::size_t value_size() const {
+        return repr == Repr::Float64 ? 8 : 4;
+    }
+
+    std::size_t frame_size() const {
+        return kHeaderSize + static_cast<std::size_t>(count) * value_size();
+    }
+};
+
+inline std::size_t encoded_size(std::size_t n, Repr repr = Repr::Float64) {
+    return kHeaderSize + n * (repr == Repr::Float64 ? 8 : 4);
+}
+
+// ============================================================================
+// Encoding
+// ============================================================================
+
+// Writes a frame into out[0, encoded_size(n, repr)); returns its size
+template<typename UnitTag>
+std::size_t encode(const Quantity<UnitTag>* values, std::size_t n, std::uint8_t* out,
+                   Repr repr = Repr::Float64) {
+    if (n > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::invalid_argument("Wire frames hold at most 2^32 - 1 values");
+    }
+    out[0] = 'Q';
+    out[1] = 'T';
+    out[2] = 'T';
+    out[3] = 'Y';
+    out[4] = kVersion;
+    out[5] = static_cast<std::uint8_t>(repr);
+    detail::store_le(out + 6, 0, 2);
+    detail::store_le(out + 8, static_cast<std::uint32_t>(UnitTraits<UnitTag>::unit_id()), 4);
+    detail::store_le(out + 12, n, 4);
+
+    const double* v = detail::raw(values);
+    std::uint8_t* p = out + kHeaderSize;
+    if (repr == Repr::Float64) {
+        for (std::size_t i = 0; i < n; ++i) {
+            detail::store_f64_le(p + 8 * i, v[i]);
+        }
+    } else {
+        for (std::size_t i = 0; i < n; ++i) {
+            const float f = static_cast<float>(v[i]);
+            std::uint32_t bits;
+            std::memcpy(&bits, &f, sizeof bits);
+            detail::store_le(p + 4 * i, bits, 4);
+        }
+    }
+    return encoded_size(n, repr);
+}
+
+template<typename UnitTag>
+std::vector<std::uint8_t> encode(const Quantity<UnitTag>* values, std::size_t n,
+                                 Repr repr = Repr::Float64) {
+    std::vector<std::uint8_t> out(encoded_size(n, repr));
+    encode(values, n, out.data(), repr);
+    return out;
+}
+
+// ============================================================================
+// Decoding
+// ============================================================================
+
+// Parses and validates the 16-byte header at data[0, size)
+inline FrameHeader decode_header(const std::uint8_t* data, std::size_t size) {
+    detail::ByteReader in(data, size);
+    const std::uint8_t* magic = in.bytes(4);
+    if (magic[0] != 'Q' || magic[1] != 'T' || magic[2] != 'T' || magic[3] != 'Y') {
+        throw std::invalid_argument("Not a qtty wire frame");
+    }
+    if (in.u8() != kVersion) {
+        throw std::invalid_argument("Unsupported wire frame version");
+    }
+    const std::uint8_t repr = in.u8();
+    if (repr > static_cast<std::uint8_t>(Repr::Float32)) {
+        throw std::invalid_argument("Unknown wire value representation");
+    }
+    in.u16();  // reserved
+    FrameHeader h;
+    h.unit = static_cast<UnitId>(in.u32());
+    h.repr = static_cast<Repr>(repr);
+    h.count = in.u32();
+    return h;
+}
+
+// Decodes a complete frame into out[0, count), converting to Unit. `out`
+// needs header.count slots. Returns the number of values written.
+template<typename Unit>
+std::size_t decode(const std::uint8_t* data, std::size_t size,
+                   Quantity<typename ExtractTag<Unit>::type>* out) {
+    using Tag = typename ExtractTag<Unit>::type;
+    const FrameHeader h = decode_header(data, size);
+    if (size < h.frame_size()) {
+        throw std::invalid_argument("Truncated wire frame");
+    }
+    const double f = detail::runtime_conversion_factor(h.unit, UnitTraits<Tag>::unit_id());
+    const std::uint8_t* p = data + kHeaderSize;
+    double* o = detail::raw(out);
+    if (h.repr == Repr::Float64) {
+        for (std::size_t i = 0; i < h.count; ++i) {
+            o[i] = detail::load_f64_le(p + 8 * i) * f;
+        }
+    } else {
+        for (std::size_t i = 0; i < h.count; ++i) {
+            const std::uint32_t bits = static_cast<std::uint32_t>(detail::load_le(p + 4 * i, 4));
+            float v;
+            std::memcpy(&v, &bits, sizeof v);
+            o[i] = static_cast<double>(v) * f;
+        }
+    }
+    return h.count;
+}
+
+// Converts a float64 frame to Unit inside `data` and returns the payload
+// as quantities. `data + kHeaderSize` must be 8-byte aligned.
+template<typename Unit>
+span<Quantity<typename ExtractTag<Unit>::type>> decode_in_place(std::uint8_t* data, std::size_t size) {
+    using Tag = typename ExtractTag<Unit>::type;
+    static_assert(detail::check_quantity_layout<Tag>(), "");
+    const FrameHeader h = decode_header(data, size);
+    if (h.repr != Repr::Float64) {
+        throw std::invalid_argument("In-place decoding needs a float64 frame");
+    }
+    if (size < h.frame_size()) {
+        throw std::invalid_argument("Truncated wire frame");
+    }
+    std::uint8_t* p = data + kHeaderSize;
+    if (reinterpret_cast<std::uintptr_t>(p) % alignof(double) != 0) {
+        throw std::invalid_argument("In-place decoding needs an 8-byte aligned payload");
+    }
+    const double f = detail::runtime_conversion_factor(h.unit, UnitTraits<Tag>::unit_id());
+    auto* q = reinterpret_cast<Quantity<Tag>*>(p);
+    double* o = detail::raw(q);
+    for (std::size_t i = 0; i < h.count; ++i) {
+        o[i] = detail::load_f64_le(p + 8 * i) * f;
+    }
+    return span<Quantity<Tag>>(q, h.count);
+}
+
+#if QTTY_HAS_WIRE_IO
+
+// ============================================================================
+// Nonblocking File Descriptor I/O
+// ============================================================================
+
+
+class FrameWriter {
+public:
+    explicit FrameWriter(int fd) : fd_(fd) {}
+
+    template<typename UnitTag>
+    void enqueue(const Quantity<UnitTag>* values, std::size_t n, Repr repr = Repr::Float64) {
+        frames_.push_back(encode(values, n, repr));
+        pending_ += frames_.back().size();
+    }
+
+    // Writes queued frames, several per writev(). True once everything has
+    // been written; false if the fd would block (call again when writable).
+    bool flush() {
+        while (!frames_.empty()) {
+            iovec iov[detail::kWireMaxIov];
+            int k = 0;
+            for (auto it = frames_.begin(); it != frames_.end() && k < detail::kWireMaxIov; ++it, ++k) {
+                const std::size_t skip = k == 0 ? offset_ : 0;
+                iov[k].iov_base = it->data() + skip;
+                iov[k].iov_len = it->size() - skip;
+            }
+            const ssize_t w = ::writev(fd_, iov, k);
+            if (w < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (detail::would_block(errno)) {
+                    return false;
+                }
+                throw std::system_error(errno, std::generic_category(), "writev");
+            }
+            consume(static_cast<std::size_t>(w));
+        }
+        return true;
+    }
+
+    std::size_t pending_bytes() const noexcept {
+        return pending_;
+    }
+
+private:
+    int fd_;
+    std::deque<std::vector<std::uint8_t>> frames_;
+    std::size_t offset_ = 0;  // bytes of frames_.front() already written
+    std::size_t pending_ = 0;
+
+    void consume(std::size_t w) {
+        pending_ -= w;
+        while (w > 0) {
+            const std::size_t left = frames_.front().size() - offset_;
+            if (w < left) {
+                offset_ += w;
+                return;
+            }
+            w -= left;
+            offset_ = 0;
+            frames_.pop_front();
+        }
+    }
+};
+
+class FrameReader {
+public:
+    // Frames larger than max_frame_bytes are rejected rather than buffered
+    explicit FrameReader(int fd, std::size_t max_frame_bytes = std::size_t{64} << 20)
+        : fd_(fd), max_frame_(max_frame_bytes),
+          spill_(new std::uint8_t[detail::kWireReadSpill]) {}
+
+    // Reads what is currently available, stopping early once at least
+    // max_frame_bytes are buffered (decode with next() and call again).
+    // Returns the number of bytes read: 0 when the fd would block, at end of
+    // stream (see eof()) or when the buffer is already full.
+    std::size_t fill() {
+        std::size_t total = 0;
+        while (buffered_bytes() < max_frame_) {
+            compact();
+            if (buf_.size() - end_ < 4096) {
+                buf_.resize(std::max<std::size_t>(buf_.size() * 2, detail::kWireReadSpill));
+            }
+            // Never read more than one spill area past the limit
+            const std::size_t want = max_frame_ - buffered_bytes() + detail::kWireReadSpill;
+            iovec iov[2];
+            iov[0].iov_base = buf_.data() + end_;
+            iov[0].iov_len = std::min(buf_.size() - end_, want);
+            iov[1].iov_base = spill_.get();
+            iov[1].iov_len = std::min(detail::kWireReadSpill, want - iov[0].iov_len);
+            const ssize_t r = ::readv(fd_, iov, iov[1].iov_len > 0 ? 2 : 1);
+            if (r < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (detail::would_block(errno)) {
+                    return total;
+                }
+                throw std::system_error(errno, std::generic_category(), "readv");
+            }
+            if (r == 0) {
+                eof_ = true;
+                return total;
+            }
+            const std::size_t got = static_cast<std::size_t>(r);
+            const std::size_t direct = std::min(got, iov[0].iov_len);
+            end_ += direct;
+            if (got > direct) {
+                buf_.resize(end_);
+                buf_.insert(buf_.end(), spill_.get(), spill_.get() + (got - direct));
+                end_ = buf_.size();
+            }
+            total += got;
+        }
+        return total;
+    }
+
+    // True once the peer has closed its end
+    bool eof() const noexcept {
+        return eof_;
+    }
+
+    std::size_t buffered_bytes() const noexcept {
+        return end_ - begin_;
+    }
+
+    // Decodes the next complete frame into `out` (resized), converting to
+    // Unit. False if no complete frame is buffered yet.
+    template<typename Unit>
+    bool next(std::vector<Quantity<typename ExtractTag<Unit>::type>>& out) {
+        if (buffered_bytes() < kHeaderSize) {
+            return false;
+        }
+        const FrameHeader h = decode_header(buf_.data() + begin_, buffered_bytes());
+        if (h.frame_size() > max_frame_) {
+            throw std::invalid_argument("Wire frame exceeds the reader's size limit");
+        }
+        if (buffered_bytes() < h.frame_size()) {
+            return false;
+        }
+        out.resize(h.count);
+        decode<Unit>(buf_.data() + begin_, h.frame_size(), out.data());
+        begin_ += h.frame_size();
+        return true;
+    }
+
+private:
+    int fd_;
+    std::size_t max_frame_;
+    std::unique_ptr<std::uint8_t[]> spill_;  // second readv target, copied into buf_
+    std::vector<std::uint8_t> buf_;
+    std::size_t begin_ = 0;  // unread bytes are buf_[begin_, end_)
+    std::size_t end_ = 0;
+    bool eof_ = false;
+
+    void compact() {
+        if (begin_ == 0) {
+            return;
+        }
+        std::memmove(buf_.data(), buf_.data() + begin_, end_ - begin_);
+        end_ -= begin_;
+        begin_ = 0;
+    }
+};
+
+#endif // QTTY_HAS_WIRE_IO
+
+} // namespace wire
+} // namespace qtty
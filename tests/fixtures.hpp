@@ -22,3 +22,28 @@ class DerivedQuantityTest : public QttyTest {};
 class QuantityOperationsTest : public QttyTest {};
 class DimensionSafetyTest : public QttyTest {};
 class PrecisionEdgeCaseTest : public QttyTest {};
+class MathFunctionsTest : public QttyTest {};
+class AngleKernelTest : public QttyTest {};
+class SeparationTest : public QttyTest {};
+class FrameTransformTest : public QttyTest {};
+class SkyIndexTest : public QttyTest {};
+class ProperMotionTest : public QttyTest {};
+class EpochTest : public QttyTest {};
+class BulkConvertTest : public QttyTest {};
+class Vec3Test : public QttyTest {};
+class KdTreeTest : public QttyTest {};
+class RunningStatsTest : public QttyTest {};
+class KllSketchTest : public QttyTest {};
+class ReduceTest : public QttyTest {};
+class HistogramTest : public QttyTest {};
+class SortTest : public QttyTest {};
+class LookupTableTest : public QttyTest {};
+class FilterTest : public QttyTest {};
+class SpanTest : public QttyTest {};
+class ViewsTest : public QttyTest {};
+class StreamTest : public QttyTest {};
+class PipelineTest : public QttyTest {};
+class RingBufferTest : public QttyTest {};
+class ShmChannelTest : public QttyTest {};
+class WireTest : public QttyTest {};
+class CborTest : public QttyTest {};
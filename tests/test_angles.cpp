@@ -0,0 +1,188 @@
+#include "fixtures.hpp"
+#include "qtty/angles.hpp"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace {
+
+// Distance between a double result and a long double reference, in units of
+// the reference's last place.
+double ulp_error(double got, long double ref) {
+    const double r = static_cast<double>(ref);
+    const double ulp = std::nextafter(std::fabs(r), INFINITY) - std::fabs(r);
+    return static_cast<double>(std::fabs(static_cast<long double>(got) - ref) / ulp);
+}
+
+const long double kPiL = 3.141592653589793238462643383279502884L;
+
+// Extended-precision reference for an angle in degrees. The reduction by
+// quarter turns is exact, so the reference does not lose accuracy near
+// multiples of 90 degrees.
+void reference_sincos(double deg, long double& s, long double& c) {
+    const long double k = std::nearbyint(static_cast<long double>(deg) / 90.0L);
+    const long double r = (static_cast<long double>(deg) - 90.0L * k) * kPiL / 180.0L;
+    const int q = static_cast<int>(((static_cast<long long>(k) % 4) + 4) % 4);
+    const long double sv[4] = {std::sin(r), std::cos(r), -std::sin(r), -std::cos(r)};
+    const long double cv[4] = {std::cos(r), -std::sin(r), -std::cos(r), std::sin(r)};
+    s = sv[q];
+    c = cv[q];
+}
+
+// Reference for an angle of x / per_rad radians, with per_rad an integer. The
+// split into hi + lo is exact in long double, and libm's long double sin/cos
+// reduce hi correctly however large it is.
+void reference_sincos_rad(double x, double per_rad, long double& s, long double& c) {
+    const double hi = x / per_rad;
+    const long double lo = (static_cast<long double>(x) - static_cast<long double>(hi) * per_rad) / per_rad;
+    const long double sh = std::sin(static_cast<long double>(hi));
+    const long double ch = std::cos(static_cast<long double>(hi));
+    s = sh + lo * ch;
+    c = ch - lo * sh;
+}
+
+template<typename Angle>
+void check_radian_unit(double per_rad, double max_abs, Accuracy acc, double bound) {
+    const std::size_t n = 4001;
+    std::vector<Angle> a(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        // Spread over [-max_abs, max_abs] with irregular mantissas
+        const double t = static_cast<double>(i) / (n - 1) * 2.0 - 1.0;
+        a[i] = Angle(max_abs * t * std::fabs(t) + 0.6180339887 * static_cast<double>(i));
+    }
+    std::vector<double> s(n), c(n);
+    batch::sincos(a.data(), s.data(), c.data(), n, acc);
+    for (std::size_t i = 0; i < n; ++i) {
+        long double rs, rc;
+        reference_sincos_rad(a[i].value(), per_rad, rs, rc);
+        EXPECT_LE(ulp_error(s[i], rs), bound) << a[i].value();
+        EXPECT_LE(ulp_error(c[i], rc), bound) << a[i].value();
+    }
+}
+
+} // namespace
+
+TEST_F(AngleKernelTest, SinCosExactAtQuarterTurns) {
+    for (Accuracy acc : {Accuracy::Precise, Accuracy::Fast}) {
+        for (int k = -8; k <= 8; ++k) {
+            auto sc = sincos(Degree(90.0 * k), acc);
+            const double expect_s[4] = {0.0, 1.0, 0.0, -1.0};
+            const double expect_c[4] = {1.0, 0.0, -1.0, 0.0};
+            const int q = ((k % 4) + 4) % 4;
+            EXPECT_EQ(sc.sin, expect_s[q]) << k;
+            EXPECT_EQ(sc.cos, expect_c[q]) << k;
+        }
+        EXPECT_EQ(sin(HourAngle(6.0), acc), 1.0);
+        EXPECT_EQ(cos(Arcsecond(648000.0), acc), -1.0);
+    }
+}
+
+TEST_F(AngleKernelTest, SinCosNonFinite) {
+    const double inf = std::numeric_limits<double>::infinity();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    for (Accuracy acc : {Accuracy::Precise, Accuracy::Fast}) {
+        for (double v : {nan, inf, -inf}) {
+            const auto deg = sincos(Degree(v), acc);
+            EXPECT_TRUE(std::isnan(deg.sin) && std::isnan(deg.cos)) << v;
+            const auto rad = sincos(Radian(v), acc);
+            EXPECT_TRUE(std::isnan(rad.sin) && std::isnan(rad.cos)) << v;
+        }
+    }
+}
+
+TEST_F(AngleKernelTest, SinCosUlpBounds) {
+    const std::size_t n = 20000;
+    std::vector<Degree> deg(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        deg[i] = Degree(-720.0 + 1440.0 * static_cast<double>(i) / n + 1e-7 * i);
+    }
+    std::vector<double> s(n), c(n);
+    for (Accuracy acc : {Accuracy::Precise, Accuracy::Fast}) {
+        const double bound = acc == Accuracy::Precise ? 2.0 : 4.0;
+        batch::sincos(deg.data(), s.data(), c.data(), n, acc);
+        for (std::size_t i = 0; i < n; ++i) {
+            long double rs, rc;
+            reference_sincos(deg[i].value(), rs, rc);
+            EXPECT_LE(ulp_error(s[i], rs), bound) << deg[i].value();
+            EXPECT_LE(ulp_error(c[i], rc), bound) << deg[i].value();
+        }
+    }
+}
+
+TEST_F(AngleKernelTest, SinCosRadianUnitsAtLargeArguments) {
+    // A quarter turn is not representable in radians, so these go through the
+    // pi/2 reduction rather than the in-unit one
+    check_radian_unit<Radian>(1.0, 1e10, Accuracy::Precise, 2.0);
+    check_radian_unit<Milliradian>(1000.0, 1e13, Accuracy::Precise, 2.0);
+    check_radian_unit<Radian>(1.0, 6e6, Accuracy::Fast, 4.0);  // 2^20 turns
+    check_radian_unit<Milliradian>(1000.0, 6e9, Accuracy::Fast, 4.0);
+    EXPECT_EQ(sin(Radian(3.0)), std::sin(3.0));
+    EXPECT_EQ(sin(Radian(1e6)), std::sin(1e6));
+}
+
+TEST_F(AngleKernelTest, Atan2UlpBounds) {
+    const std::size_t n = 4096;
+    std::vector<Meter> y(n), x(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const double t = static_cast<double>(i) * 0.0017;
+        y[i] = Meter(std::sin(3.0 * t) * (1.0 + t));
+        x[i] = Meter(std::cos(7.0 * t) * (2.0 - 0.3 * t));
+    }
+    std::vector<Radian> out(n);
+    for (Accuracy acc : {Accuracy::Precise, Accuracy::Fast}) {
+        const double bound = acc == Accuracy::Precise ? 1.0 : 4.0;
+        batch::atan2(y.data(), x.data(), out.data(), n, acc);
+        for (std::size_t i = 0; i < n; ++i) {
+            const long double ref = std::atan2(static_cast<long double>(y[i].value()),
+                                               static_cast<long double>(x[i].value()));
+            EXPECT_LE(ulp_error(out[i].value(), ref), bound);
+        }
+    }
+    EXPECT_NEAR(atan2(Meter(1.0), Meter(1.0)).value(), M_PI / 4.0, 1e-15);
+    EXPECT_NEAR(atan2(Meter(0.0), Meter(-1.0), Accuracy::Fast).value(), M_PI, 1e-15);
+    EXPECT_EQ(atan2(Meter(0.0), Meter(0.0), Accuracy::Fast).value(), 0.0);
+
+    // Non-finite inputs follow std::atan2 in both modes
+    const double inf = std::numeric_limits<double>::infinity();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    for (Accuracy acc : {Accuracy::Precise, Accuracy::Fast}) {
+        EXPECT_TRUE(std::isnan(atan2(Meter(1.0), Meter(nan), acc).value()));
+        EXPECT_TRUE(std::isnan(atan2(Meter(nan), Meter(1.0), acc).value()));
+        EXPECT_TRUE(std::isnan(atan2(Meter(nan), Meter(inf), acc).value()));
+        EXPECT_NEAR(atan2(Meter(inf), Meter(inf), acc).value(), M_PI / 4.0, 1e-15);
+        EXPECT_NEAR(atan2(Meter(-inf), Meter(-inf), acc).value(), -3.0 * M_PI / 4.0, 1e-15);
+        EXPECT_NEAR(atan2(Meter(inf), Meter(1.0), acc).value(), M_PI / 2.0, 1e-15);
+        EXPECT_EQ(atan2(Meter(1.0), Meter(inf), acc).value(), 0.0);
+    }
+}
+
+TEST_F(AngleKernelTest, Wrapping) {
+    for (Accuracy acc : {Accuracy::Precise, Accuracy::Fast}) {
+        EXPECT_EQ(wrap_positive(Degree(-90.0), acc).value(), 270.0);
+        EXPECT_EQ(wrap_positive(Degree(720.0), acc).value(), 0.0);
+        EXPECT_EQ(wrap_positive(HourAngle(-1.0), acc).value(), 23.0);
+        EXPECT_EQ(wrap_signed(Degree(270.0), acc).value(), -90.0);
+        EXPECT_EQ(wrap_signed(Degree(180.0), acc).value(), 180.0);
+        EXPECT_EQ(wrap_signed(Degree(-180.0), acc).value(), 180.0);
+        EXPECT_NEAR(wrap_positive(Radian(-0.5), acc).value(), 2.0 * M_PI - 0.5, 1e-15);
+    }
+
+    std::vector<Arcsecond> a = {Arcsecond(-1.0), Arcsecond(1296000.0 + 5.0), Arcsecond(3.0)};
+    batch::wrap_positive(a.data(), a.data(), a.size(), Accuracy::Fast);
+    EXPECT_EQ(a[0].value(), 1295999.0);
+    EXPECT_EQ(a[1].value(), 5.0);
+    EXPECT_EQ(a[2].value(), 3.0);
+
+    std::vector<Degree> d(1000);
+    for (std::size_t i = 0; i < d.size(); ++i) {
+        d[i] = Degree(-1e4 + 20.0 * static_cast<double>(i) + 0.125);
+    }
+    std::vector<Degree> w(d.size());
+    batch::wrap_signed(d.data(), w.data(), d.size(), Accuracy::Fast);
+    for (std::size_t i = 0; i < d.size(); ++i) {
+        EXPECT_GT(w[i].value(), -180.0);
+        EXPECT_LE(w[i].value(), 180.0);
+        EXPECT_EQ(w[i].value(), wrap_signed(d[i]).value());
+    }
+}
@@ -0,0 +1,143 @@
+#include "fixtures.hpp"
+#include "qtty/cbor.hpp"
+#include "qtty/serialization.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+using Bytes = std::vector<std::uint8_t>;
+
+namespace {
+
+// "unit_id": <id>, the map entry every quantity and array encoding carries
+Bytes unit_entry(UnitId unit) {
+    Bytes b = {0x67, 'u', 'n', 'i', 't', '_', 'i', 'd'};
+    detail::cbor_head(b, detail::kCborUint, static_cast<std::uint32_t>(unit));
+    return b;
+}
+
+} // namespace
+
+TEST_F(CborTest, ValueEncoding) {
+    const Bytes b = serialization::to_cbor_value(Meter(1.5));
+    EXPECT_EQ(b, (Bytes{0xFB, 0x3F, 0xF8, 0, 0, 0, 0, 0, 0}));
+    EXPECT_EQ(serialization::from_cbor_value<Meter>(b.data(), b.size()).value(), 1.5);
+
+    // Other CBOR number encodings are accepted as well
+    const Bytes half = {0xF9, 0x3E, 0x00};  // 1.5 as float16
+    EXPECT_EQ(serialization::from_cbor_value<Meter>(half.data(), half.size()).value(), 1.5);
+    const Bytes neg = {0x38, 0x63};  // -100
+    EXPECT_EQ(serialization::from_cbor_value<Meter>(neg.data(), neg.size()).value(), -100.0);
+}
+
+TEST_F(CborTest, QuantityMirrorsJsonLayout) {
+    const Bytes b = serialization::to_cbor(Meter(1500.0));
+    // {"value": 1500.0, "unit_id": <id>}
+    EXPECT_EQ(b[0], 0xA2);
+    EXPECT_EQ(b[1], 0x65);  // text(5)
+    EXPECT_EQ(std::string(b.begin() + 2, b.begin() + 7), "value");
+    EXPECT_LT(b.size(), serialization::to_json(Meter(1500.0)).size());
+
+    EXPECT_DOUBLE_EQ(serialization::from_cbor<Meter>(b.data(), b.size()).value(), 1500.0);
+    EXPECT_DOUBLE_EQ(serialization::from_cbor<Kilometer>(b.data(), b.size()).value(), 1.5);
+    EXPECT_THROW(serialization::from_cbor<Second>(b.data(), b.size()), IncompatibleDimensionsError);
+}
+
+TEST_F(CborTest, DecoderToleratesKeyOrderAndExtraKeys) {
+    // {"note": [1, "x"], "unit_id": <meter>, "value": 2.0 (float32)}
+    Bytes b = {0xA3, 0x64, 'n', 'o', 't', 'e', 0x82, 0x01, 0x61, 'x'};
+    const Bytes unit = unit_entry(UnitTraits<MeterTag>::unit_id());
+    b.insert(b.end(), unit.begin(), unit.end());
+    const Bytes value = {0x65, 'v', 'a', 'l', 'u', 'e', 0xFA, 0x40, 0x00, 0x00, 0x00};
+    b.insert(b.end(), value.begin(), value.end());
+    EXPECT_DOUBLE_EQ(serialization::from_cbor<Meter>(b.data(), b.size()).value(), 2.0);
+}
+
+TEST_F(CborTest, ArraysUseTypedArrayTag) {
+    const std::vector<Meter> m = {Meter(1000.0), Meter(-250.0), Meter(0.5)};
+    const Bytes b = serialization::to_cbor_array(m.data(), m.size());
+    // {"unit_id": <meter>, "values": 86(h'...')}, unit first
+    const Bytes unit = unit_entry(UnitTraits<MeterTag>::unit_id());
+    EXPECT_EQ(b[0], 0xA2);
+    EXPECT_TRUE(std::equal(unit.begin(), unit.end(), b.begin() + 1));
+    const std::size_t at = 1 + unit.size();
+    EXPECT_EQ(std::string(b.begin() + at + 1, b.begin() + at + 7), "values");
+    EXPECT_EQ(b[at + 7], 0xD8);  // tag, 1-byte argument
+    EXPECT_EQ(b[at + 8], 86);
+    EXPECT_EQ(b[at + 9], 0x58);  // bytes, 1-byte length
+    EXPECT_EQ(b[at + 10], 24);
+    EXPECT_EQ(b.size(), at + 11 + 24);
+
+    const auto km = serialization::from_cbor_array<Kilometer>(b.data(), b.size());
+    ASSERT_EQ(km.size(), 3u);
+    EXPECT_DOUBLE_EQ(km[0].value(), 1.0);
+    EXPECT_DOUBLE_EQ(km[1].value(), -0.25);
+    EXPECT_DOUBLE_EQ(km[2].value(), 0.0005);
+
+    const Bytes empty = serialization::to_cbor_array<MeterTag>(nullptr, 0);
+    EXPECT_TRUE(serialization::from_cbor_array<Meter>(empty.data(), empty.size()).empty());
+    EXPECT_THROW(serialization::from_cbor_array<Second>(b.data(), b.size()), IncompatibleDimensionsError);
+}
+
+TEST_F(CborTest, ArraysAcceptBigEndianTagAndPlainArrays) {
+    const Bytes unit = unit_entry(UnitTraits<SecondTag>::unit_id());
+    auto finish = [&](Bytes b) {
+        b.insert(b.end(), unit.begin(), unit.end());
+        return b;
+    };
+    // "values" before "unit_id": decoded first, converted afterwards
+    const Bytes head = {0xA2, 0x66, 'v', 'a', 'l', 'u', 'e', 's'};
+
+    // 82(h'3FF8000000000000') = [1.5] big-endian
+    Bytes be = head;
+    const Bytes be_values = {0xD8, 82, 0x48, 0x3F, 0xF8, 0, 0, 0, 0, 0, 0};
+    be.insert(be.end(), be_values.begin(), be_values.end());
+    be = finish(be);
+    auto s = serialization::from_cbor_array<Second>(be.data(), be.size());
+    ASSERT_EQ(s.size(), 1u);
+    EXPECT_EQ(s[0].value(), 1.5);
+
+    // [60, 120.0]
+    Bytes plain = head;
+    const Bytes plain_values = {0x82, 0x18, 60, 0xFB, 0x40, 0x5E, 0, 0, 0, 0, 0, 0};
+    plain.insert(plain.end(), plain_values.begin(), plain_values.end());
+    plain = finish(plain);
+    auto mins = serialization::from_cbor_array<Minute>(plain.data(), plain.size());
+    ASSERT_EQ(mins.size(), 2u);
+    EXPECT_DOUBLE_EQ(mins[0].value(), 1.0);
+    EXPECT_DOUBLE_EQ(mins[1].value(), 2.0);
+
+    // The encoder's order with a big-endian payload
+    Bytes unit_first = {0xA2};
+    unit_first.insert(unit_first.end(), unit.begin(), unit.end());
+    unit_first.insert(unit_first.end(), head.begin() + 1, head.end());
+    unit_first.insert(unit_first.end(), be_values.begin(), be_values.end());
+    auto ms = serialization::from_cbor_array<Millisecond>(unit_first.data(), unit_first.size());
+    ASSERT_EQ(ms.size(), 1u);
+    EXPECT_DOUBLE_EQ(ms[0].value(), 1500.0);
+}
+
+TEST_F(CborTest, MalformedInputThrows) {
+    const std::vector<Meter> m = {Meter(1.0), Meter(2.0)};
+    const Bytes b = serialization::to_cbor_array(m.data(), m.size());
+    for (std::size_t cut : {std::size_t{0}, std::size_t{5}, std::size_t{15}, b.size() - 1}) {
+        EXPECT_THROW(serialization::from_cbor_array<Meter>(b.data(), cut), std::invalid_argument) << cut;
+    }
+    Bytes trailing = b;
+    trailing.push_back(0x00);
+    EXPECT_THROW(serialization::from_cbor_array<Meter>(trailing.data(), trailing.size()), std::invalid_argument);
+
+    const Bytes indefinite = {0xBF, 0xFF};
+    EXPECT_THROW(serialization::from_cbor<Meter>(indefinite.data(), indefinite.size()), std::invalid_argument);
+    const Bytes missing_unit = {0xA1, 0x65, 'v', 'a', 'l', 'u', 'e', 0x01};
+    EXPECT_THROW(serialization::from_cbor<Meter>(missing_unit.data(), missing_unit.size()), std::invalid_argument);
+    Bytes repeated = {0xA3, 0x65, 'v', 'a', 'l', 'u', 'e', 0x01};
+    const Bytes unit = unit_entry(UnitTraits<MeterTag>::unit_id());
+    repeated.insert(repeated.end(), unit.begin(), unit.end());
+    repeated.insert(repeated.end(), unit.begin(), unit.end());
+    EXPECT_THROW(serialization::from_cbor<Meter>(repeated.data(), repeated.size()), std::invalid_argument);
+    const Bytes text = {0x61, 'x'};
+    EXPECT_THROW(serialization::from_cbor_value<Meter>(text.data(), text.size()), std::invalid_argument);
+}
@@ -0,0 +1,57 @@
+#include "fixtures.hpp"
+#include "qtty/convert.hpp"
+
+#include <vector>
+
+TEST_F(BulkConvertTest, MatchesScalarConversion) {
+    const std::size_t n = 1003;
+    std::vector<Meter> m(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        m[i] = Meter(static_cast<double>(i) * 12.5 - 300.0);
+    }
+    std::vector<Kilometer> km(n);
+    batch::convert(m.data(), km.data(), n);
+    for (std::size_t i = 0; i < n; ++i) {
+        EXPECT_DOUBLE_EQ(km[i].value(), m[i].to<Kilometer>().value());
+    }
+
+    std::vector<Meter> same(n);
+    batch::convert(m.data(), same.data(), n);
+    EXPECT_EQ(same[17].value(), m[17].value());
+}
+
+TEST_F(BulkConvertTest, IncompatibleUnitsThrow) {
+    std::vector<Meter> m(4, Meter(1.0));
+    std::vector<Second> s(4);
+    EXPECT_THROW(batch::convert(m.data(), s.data(), 4), IncompatibleDimensionsError);
+}
+
+TEST_F(BulkConvertTest, FanoutMatchesSeparateConversions) {
+    const std::size_t n = 5000;  // spans several blocks plus a tail
+    std::vector<Meter> m(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        m[i] = Meter(static_cast<double>(i) * 3.75 + 0.5);
+    }
+    std::vector<Kilometer> km(n);
+    std::vector<Mile> mi(n);
+    std::vector<NauticalMile> nmi(n);
+    batch::convert_fanout(m.data(), n, km.data(), mi.data(), nmi.data());
+
+    std::vector<Kilometer> km_ref(n);
+    std::vector<Mile> mi_ref(n);
+    std::vector<NauticalMile> nmi_ref(n);
+    batch::convert(m.data(), km_ref.data(), n);
+    batch::convert(m.data(), mi_ref.data(), n);
+    batch::convert(m.data(), nmi_ref.data(), n);
+    for (std::size_t i = 0; i < n; ++i) {
+        ASSERT_EQ(km[i].value(), km_ref[i].value());
+        ASSERT_EQ(mi[i].value(), mi_ref[i].value());
+        ASSERT_EQ(nmi[i].value(), nmi_ref[i].value());
+    }
+    EXPECT_NEAR(nmi[n - 1].value(), m[n - 1].value() / 1852.0, 1e-12);
+
+    std::vector<Kilometer> single(3);
+    batch::convert_fanout(m.data(), 3, single.data());
+    EXPECT_DOUBLE_EQ(single[2].value(), m[2].value() / 1000.0);
+    batch::convert_fanout(m.data(), 0, single.data());
+}
@@ -0,0 +1,78 @@
+#include "fixtures.hpp"
+#include "qtty/epoch.hpp"
+
+#include <vector>
+
+TEST_F(EpochTest, Construction) {
+    const Epoch j2000 = Epoch::j2000();
+    EXPECT_EQ(j2000.jd_day(), 2451545.0);
+    EXPECT_EQ(j2000.jd_fraction(), 0.0);
+    EXPECT_EQ(Epoch::from_mjd(51544.5), j2000);
+    EXPECT_EQ(Epoch::from_jd(2451544.5, 0.5), j2000);
+    EXPECT_EQ(Epoch::from_jd(2400000.5, 51544.5), j2000);
+    EXPECT_EQ(Epoch::from_tai_seconds(0.0), Epoch::from_jd(2436204.5));
+    EXPECT_DOUBLE_EQ(j2000.mjd(), 51544.5);
+
+    const Epoch t = Epoch::from_jd(2460000.75);
+    EXPECT_EQ(t.jd_day(), 2460000.0);
+    EXPECT_EQ(t.jd_fraction(), 0.75);
+    EXPECT_EQ(Epoch::from_jd(-0.25).jd_day(), -1.0);
+    EXPECT_EQ(Epoch::from_jd(-0.25).jd_fraction(), 0.75);
+}
+
+TEST_F(EpochTest, SubNanosecondOffsets) {
+    const Epoch t0 = Epoch::from_mjd(60000.0);
+    // 100 years of 1 ns steps would be lost in a single-double JD
+    const Epoch t1 = t0 + JulianCentury(1.0) + Nanosecond(1.0);
+    EXPECT_NEAR((t1 - (t0 + JulianCentury(1.0))).value(), 1e-9, 1e-11);
+
+    const EpochDifference d = split_difference(t1, t0);
+    EXPECT_EQ(d.days.value(), 36525.0);
+    EXPECT_NEAR(d.seconds.value(), 1e-9, 1e-11);
+
+    Epoch t = t0;
+    t += Second(0.25);
+    t += Day(3.0);
+    t -= Millisecond(250.0);
+    EXPECT_NEAR((t - t0).value(), 3.0 * 86400.0, 1e-11);
+    EXPECT_NEAR(t.since<DayTag>(t0).value(), 3.0, 1e-15);
+
+    // Crossing a day boundary backwards keeps the fraction normalized
+    const Epoch back = Epoch::from_jd(2451545.0) - Second(1.0);
+    EXPECT_EQ(back.jd_day(), 2451544.0);
+    EXPECT_NEAR(back.jd_fraction(), 1.0 - 1.0 / 86400.0, 1e-16);
+    EXPECT_LT(back, Epoch::j2000());
+}
+
+TEST_F(EpochTest, ComparisonsAndCenturies) {
+    const Epoch a = Epoch::from_jd(2451545.0);
+    const Epoch b = a + Nanosecond(0.5);
+    EXPECT_LT(a, b);
+    EXPECT_GT(b, a);
+    EXPECT_LE(a, a);
+    EXPECT_GE(b, a);
+    EXPECT_NE(a, b);
+
+    EXPECT_DOUBLE_EQ((a + JulianCentury(2.5)).julian_centuries().value(), 2.5);
+    EXPECT_DOUBLE_EQ((a - JulianYear(50.0)).julian_centuries().value(), -0.5);
+    EXPECT_NEAR(Epoch::from_tai_seconds(123.5).tai_seconds(), 123.5, 1e-9);
+}
+
+TEST_F(EpochTest, BatchDifference) {
+    const std::size_t n = 40000;
+    const Epoch origin = Epoch::from_mjd(59000.125);
+    std::vector<Epoch> t(n), u(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        t[i] = origin + Second(static_cast<double>(i) * 37.25) + Nanosecond(static_cast<double>(i % 7));
+        u[i] = origin + Day(static_cast<double>(i % 11));
+    }
+    std::vector<Second> dt(n);
+    batch::difference(t.data(), origin, dt.data(), n, 4);
+    std::vector<Day> dd(n);
+    batch::difference(t.data(), u.data(), dd.data(), n);
+    for (std::size_t i = 0; i < n; i += 13) {
+        EXPECT_EQ(dt[i].value(), t[i].since<SecondTag>(origin).value());
+        EXPECT_NEAR(dt[i].value(), i * 37.25 + (i % 7) * 1e-9, 1e-9);
+        EXPECT_EQ(dd[i].value(), t[i].since<DayTag>(u[i]).value());
+    }
+}
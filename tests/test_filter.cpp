@@ -0,0 +1,115 @@
+#include "fixtures.hpp"
+#include "qtty/filter.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+
+bool bit(const std::vector<std::uint64_t>& mask, std::size_t i) {
+    return ((mask[i / 64] >> (i % 64)) & 1) != 0;
+}
+
+std::vector<Meter> random_meters(std::size_t n, unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> d(0.0, 2000.0);
+    std::vector<Meter> v(n);
+    for (auto& x : v) {
+        x = Meter(d(rng));
+    }
+    return v;
+}
+
+} // namespace
+
+TEST_F(FilterTest, PredicatesMatchScalar) {
+    const std::size_t n = 1000;  // not a multiple of 64
+    auto v = random_meters(n, 3);
+    v[10] = Meter(std::numeric_limits<double>::quiet_NaN());
+    v[11] = Meter(std::numeric_limits<double>::infinity());
+    v[12] = Meter(1000.0);
+
+    std::vector<std::uint64_t> lt(mask_words(n)), le(mask_words(n)), gt(mask_words(n)),
+        ge(mask_words(n)), in(mask_words(n)), nan(mask_words(n)), fin(mask_words(n));
+    batch::less(v.data(), n, Kilometer(1.0), lt.data());
+    batch::less_equal(v.data(), n, Kilometer(1.0), le.data());
+    batch::greater(v.data(), n, Meter(1000.0), gt.data());
+    batch::greater_equal(v.data(), n, Meter(1000.0), ge.data());
+    batch::between(v.data(), n, Meter(500.0), Kilometer(1.5), in.data());
+    batch::is_nan(v.data(), n, nan.data());
+    batch::is_finite(v.data(), n, fin.data());
+
+    for (std::size_t i = 0; i < n; ++i) {
+        const double x = v[i].value();
+        ASSERT_EQ(bit(lt, i), x < 1000.0) << i;
+        ASSERT_EQ(bit(le, i), x <= 1000.0) << i;
+        ASSERT_EQ(bit(gt, i), x > 1000.0) << i;
+        ASSERT_EQ(bit(ge, i), x >= 1000.0) << i;
+        ASSERT_EQ(bit(in, i), x >= 500.0 && x <= 1500.0) << i;
+        ASSERT_EQ(bit(nan, i), std::isnan(x)) << i;
+        ASSERT_EQ(bit(fin, i), std::isfinite(x)) << i;
+    }
+    // Tail bits stay clear
+    EXPECT_EQ(lt.back() >> (n % 64), 0u);
+    EXPECT_EQ(batch::mask_count(nan.data(), n), 1u);
+}
+
+TEST_F(FilterTest, MaskAlgebra) {
+    const std::size_t n = 130;
+    auto v = random_meters(n, 5);
+    std::vector<std::uint64_t> a(mask_words(n)), b(mask_words(n)), c(mask_words(n));
+    batch::less(v.data(), n, Meter(1200.0), a.data());
+    batch::greater(v.data(), n, Meter(800.0), b.data());
+    batch::mask_and(a.data(), b.data(), c.data(), n);
+    std::vector<std::uint64_t> in(mask_words(n));
+    batch::between(v.data(), n, Meter(800.0), Meter(1200.0), in.data());
+    for (std::size_t i = 0; i < n; ++i) {
+        EXPECT_EQ(bit(c, i), bit(in, i));
+    }
+
+    batch::mask_not(a.data(), c.data(), n);
+    batch::mask_or(a.data(), c.data(), c.data(), n);
+    EXPECT_EQ(batch::mask_count(c.data(), n), n);
+    EXPECT_EQ(c.back() >> (n % 64), 0u);
+}
+
+TEST_F(FilterTest, SelectionCompressGather) {
+    const std::size_t n = 777;
+    auto dist = random_meters(n, 7);
+    std::vector<Watt> flux(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        flux[i] = Watt(static_cast<double>(i));
+    }
+    std::vector<std::uint64_t> mask(mask_words(n));
+    batch::less(dist.data(), n, Kilometer(0.5), mask.data());
+
+    const std::size_t m = batch::mask_count(mask.data(), n);
+    std::vector<std::uint32_t> rows(m);
+    EXPECT_EQ(batch::selection_from_mask(mask.data(), n, rows.data()), m);
+
+    std::vector<Meter> near(m);
+    EXPECT_EQ(batch::compress(dist.data(), mask.data(), n, near.data()), m);
+    std::vector<Watt> picked(m);
+    batch::gather(flux.data(), rows.data(), m, picked.data());
+
+    std::size_t k = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (dist[i].value() < 500.0) {
+            ASSERT_LT(k, m);
+            EXPECT_EQ(rows[k], i);
+            EXPECT_EQ(near[k].value(), dist[i].value());
+            EXPECT_EQ(picked[k].value(), static_cast<double>(i));
+            ++k;
+        }
+    }
+    EXPECT_EQ(k, m);
+
+    // All-set words take the bulk-copy path
+    std::vector<std::uint64_t> all(mask_words(n));
+    batch::greater_equal(dist.data(), n, Meter(0.0), all.data());
+    std::vector<Meter> copy(n);
+    EXPECT_EQ(batch::compress(dist.data(), all.data(), n, copy.data()), n);
+    EXPECT_EQ(copy[n - 1].value(), dist[n - 1].value());
+}
@@ -0,0 +1,69 @@
+#include "fixtures.hpp"
+#include "qtty/frames.hpp"
+
+#include <vector>
+
+TEST_F(FrameTransformTest, GalacticReferencePoints) {
+    const FrameRotation& eq_to_gal = FrameRotation::between(Frame::Equatorial, Frame::Galactic);
+
+    // Galactic center and north galactic pole (ICRS)
+    auto center = eq_to_gal.apply(Degree(266.40499625), Degree(-28.93617242));
+    EXPECT_NEAR(wrap_signed(center.lon).value(), 0.0, 1e-5);
+    EXPECT_NEAR(center.lat.value(), 0.0, 1e-5);
+
+    auto pole = eq_to_gal.apply(Degree(192.85948121), Degree(27.12825118));
+    EXPECT_NEAR(pole.lat.value(), 90.0, 1e-5);
+}
+
+TEST_F(FrameTransformTest, EclipticReferencePoints) {
+    const FrameRotation& eq_to_ecl = FrameRotation::between(Frame::Equatorial, Frame::Ecliptic);
+
+    // The vernal equinox is fixed; RA 90 deg on the equator sits at
+    // latitude -obliquity.
+    auto equinox = eq_to_ecl.apply(Degree(0.0), Degree(0.0));
+    EXPECT_NEAR(equinox.lon.value(), 0.0, 1e-12);
+    EXPECT_NEAR(equinox.lat.value(), 0.0, 1e-12);
+
+    auto solstice = eq_to_ecl.apply(Degree(90.0), Degree(0.0));
+    EXPECT_NEAR(solstice.lon.value(), 90.0, 1e-12);
+    EXPECT_NEAR(solstice.lat.value(), -84381.406 / 3600.0, 1e-12);
+}
+
+TEST_F(FrameTransformTest, BatchRoundTrip) {
+    const std::size_t n = 50000;
+    std::vector<Degree> ra(n), dec(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const double t = static_cast<double>(i);
+        ra[i] = Degree(std::fmod(t * 0.731, 360.0));
+        dec[i] = Degree(89.0 * std::sin(t * 0.017));
+    }
+
+    for (Accuracy acc : {Accuracy::Precise, Accuracy::Fast}) {
+        FrameTransformOptions opts;
+        opts.accuracy = acc;
+        std::vector<Radian> l(n), b(n);
+        batch::transform(Frame::Equatorial, Frame::Galactic, ra.data(), dec.data(),
+                         l.data(), b.data(), n, opts);
+
+        std::vector<Radian> le(n), be(n);
+        batch::transform(Frame::Galactic, Frame::Ecliptic, l.data(), b.data(),
+                         le.data(), be.data(), n, opts);
+
+        std::vector<Degree> ra2(n), dec2(n);
+        batch::transform(Frame::Ecliptic, Frame::Equatorial, le.data(), be.data(),
+                         ra2.data(), dec2.data(), n, opts);
+
+        for (std::size_t i = 0; i < n; i += 31) {
+            EXPECT_GE(l[i].value(), 0.0);
+            EXPECT_LT(l[i].value(), 2.0 * M_PI);
+            EXPECT_NEAR(wrap_signed(ra2[i] - ra[i]).value() * std::cos(dec[i].value() * M_PI / 180.0),
+                        0.0, 1e-11);
+            EXPECT_NEAR(dec2[i].value(), dec[i].value(), 1e-11);
+
+            auto single = FrameRotation::between(Frame::Equatorial, Frame::Galactic)
+                              .apply(ra[i].to<Radian>(), dec[i].to<Radian>(), acc);
+            EXPECT_NEAR(single.lon.value(), l[i].value(), 1e-14);
+            EXPECT_NEAR(single.lat.value(), b[i].value(), 1e-14);
+        }
+    }
+}
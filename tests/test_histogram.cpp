@@ -0,0 +1,200 @@
+#include "fixtures.hpp"
+#include "qtty/histogram.hpp"
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// Reference bin by linear scan over the public edges; -1 underflow,
+// bins() overflow
+template<typename Q>
+long reference_bin(const Histogram<Q>& h, double v) {
+    if (v < h.edge(0).value()) {
+        return -1;
+    }
+    for (std::size_t i = 0; i < h.bins(); ++i) {
+        if (v < h.edge(i + 1).value()) {
+            return static_cast<long>(i);
+        }
+    }
+    return static_cast<long>(h.bins());
+}
+
+template<typename Q>
+void expect_matches_reference(const Histogram<Q>& h, const std::vector<double>& values) {
+    std::vector<std::uint64_t> expected(h.bins() + 2, 0);
+    for (double v : values) {
+        ++expected[static_cast<std::size_t>(reference_bin(h, v) + 1)];
+    }
+    EXPECT_EQ(h.underflow(), expected[0]);
+    for (std::size_t i = 0; i < h.bins(); ++i) {
+        EXPECT_EQ(h.count(i), expected[i + 1]) << "bin " << i;
+    }
+    EXPECT_EQ(h.overflow(), expected[h.bins() + 1]);
+}
+
+} // namespace
+
+TEST_F(HistogramTest, LinearBinsAndEdges) {
+    auto h = Histogram<Meter>::linear(Meter(0.0), Meter(10.0), 10);
+    EXPECT_EQ(h.bins(), 10u);
+    EXPECT_EQ(h.binning(), Binning::Linear);
+    EXPECT_DOUBLE_EQ(h.lower(3).value(), 3.0);
+    EXPECT_DOUBLE_EQ(h.upper(3).value(), 4.0);
+
+    std::vector<Meter> v = {Meter(-1.0), Meter(0.0), Meter(0.5), Meter(3.0), Meter(9.999),
+                            Meter(10.0), Meter(std::numeric_limits<double>::quiet_NaN())};
+    h.fill(v.data(), v.size());
+    EXPECT_EQ(h.underflow(), 1u);
+    EXPECT_EQ(h.count(0), 2u);
+    EXPECT_EQ(h.count(3), 1u);
+    EXPECT_EQ(h.count(9), 1u);
+    EXPECT_EQ(h.overflow(), 1u);
+    EXPECT_EQ(h.nan_count(), 1u);
+    EXPECT_EQ(h.total(), v.size());
+    EXPECT_THROW(h.count(10), std::out_of_range);
+}
+
+TEST_F(HistogramTest, ExactAtEdges) {
+    // 0.1-wide bins are not representable; values on the stored edges must
+    // still land in the bin they open
+    auto h = Histogram<Meter>::linear(Meter(0.0), Meter(1.0), 10);
+    std::vector<double> raw;
+    for (std::size_t i = 0; i <= h.bins(); ++i) {
+        const double e = h.edge(i).value();
+        raw.push_back(e);
+        raw.push_back(std::nextafter(e, -1.0));
+        raw.push_back(std::nextafter(e, 2.0));
+    }
+    std::vector<Meter> v(raw.size());
+    for (std::size_t i = 0; i < raw.size(); ++i) {
+        v[i] = Meter(raw[i]);
+    }
+    h.fill(v.data(), v.size());
+    expect_matches_reference(h, raw);
+}
+
+TEST_F(HistogramTest, LogarithmicBins) {
+    auto h = Histogram<Milliwatt>::logarithmic(Milliwatt(1e-3), Milliwatt(1e3), 6);
+    EXPECT_NEAR(h.lower(3).value(), 1.0, 1e-12);
+    std::vector<Milliwatt> v = {Milliwatt(-1.0), Milliwatt(0.0), Milliwatt(5e-3), Milliwatt(1.0),
+                                Milliwatt(999.0), Milliwatt(1e3)};
+    h.fill(v.data(), v.size());
+    EXPECT_EQ(h.underflow(), 2u);
+    EXPECT_EQ(h.count(0), 1u);
+    EXPECT_EQ(h.count(3), 1u);
+    EXPECT_EQ(h.count(5), 1u);
+    EXPECT_EQ(h.overflow(), 1u);
+
+    std::mt19937_64 rng(5);
+    std::uniform_real_distribution<double> e(-4.0, 4.0);
+    std::vector<double> raw(5000);
+    std::vector<Milliwatt> q(raw.size());
+    for (std::size_t i = 0; i < raw.size(); ++i) {
+        raw[i] = std::pow(10.0, e(rng));
+        q[i] = Milliwatt(raw[i]);
+    }
+    auto g = Histogram<Milliwatt>::logarithmic(Milliwatt(1e-3), Milliwatt(1e3), 37);
+    g.fill(q.data(), q.size());
+    expect_matches_reference(g, raw);
+}
+
+TEST_F(HistogramTest, CustomEdges) {
+    std::vector<Second> edges = {Second(0.0), Second(1.0), Second(5.0), Second(60.0)};
+    auto h = Histogram<Second>::custom(edges.data(), edges.size());
+    EXPECT_EQ(h.bins(), 3u);
+    std::vector<double> raw = {-0.5, 0.0, 0.99, 1.0, 4.0, 5.0, 59.0, 60.0, 1e9};
+    std::vector<Second> v(raw.size());
+    for (std::size_t i = 0; i < raw.size(); ++i) {
+        v[i] = Second(raw[i]);
+    }
+    h.fill(v.data(), v.size());
+    expect_matches_reference(h, raw);
+
+    std::vector<Second> bad = {Second(0.0), Second(2.0), Second(2.0)};
+    EXPECT_THROW(Histogram<Second>::custom(bad.data(), bad.size()), std::invalid_argument);
+    EXPECT_THROW(Histogram<Second>::custom(bad.data(), 1), std::invalid_argument);
+    EXPECT_THROW(Histogram<Meter>::linear(Meter(1.0), Meter(1.0), 4), std::invalid_argument);
+    EXPECT_THROW(Histogram<Meter>::logarithmic(Meter(0.0), Meter(1.0), 4), std::invalid_argument);
+}
+
+TEST_F(HistogramTest, FillFromOtherUnit) {
+    auto h = Histogram<Milliwatt>::linear(Milliwatt(0.0), Milliwatt(100.0), 10);
+    std::vector<Watt> w = {Watt(0.005), Watt(0.0155), Watt(0.099), Watt(0.2)};
+    h.fill(w.data(), w.size());
+    h.fill(Kilowatt(1e-6));  // 1 mW
+    EXPECT_EQ(h.count(0), 2u);
+    EXPECT_EQ(h.count(1), 1u);
+    EXPECT_EQ(h.count(9), 1u);
+    EXPECT_EQ(h.overflow(), 1u);
+}
+
+TEST_F(HistogramTest, ShardsMerge) {
+    std::mt19937_64 rng(9);
+    std::normal_distribution<double> d(50.0, 20.0);
+    std::vector<Meter> v(100000);
+    for (auto& x : v) {
+        x = Meter(d(rng));
+    }
+    auto serial = Histogram<Meter>::linear(Meter(0.0), Meter(100.0), 50);
+    serial.fill(v.data(), v.size());
+
+    auto parallel = Histogram<Meter>::linear(Meter(0.0), Meter(100.0), 50);
+    batch::fill(parallel, v.data(), v.size(), 4);
+    for (std::size_t i = 0; i < serial.bins(); ++i) {
+        EXPECT_EQ(parallel.count(i), serial.count(i));
+    }
+    EXPECT_EQ(parallel.underflow(), serial.underflow());
+    EXPECT_EQ(parallel.overflow(), serial.overflow());
+
+    auto other = Histogram<Meter>::linear(Meter(0.0), Meter(100.0), 25);
+    EXPECT_THROW(serial.merge(other), std::invalid_argument);
+}
+
+TEST_F(HistogramTest, SerializeRoundTrip) {
+    auto h = Histogram<Meter>::linear(Meter(0.0), Meter(1000.0), 200);
+    std::vector<Meter> v = {Meter(1.0), Meter(1.5), Meter(700.0), Meter(-3.0)};
+    h.fill(v.data(), v.size());
+    const auto bytes = h.serialize();
+    // Header, two edges and one varint byte per (mostly empty) count
+    EXPECT_LT(bytes.size(), 4u + 1 + 4 + 1 + 4 + 16 + 203 + 1);
+
+    auto back = Histogram<Meter>::deserialize(bytes.data(), bytes.size());
+    EXPECT_EQ(back.bins(), h.bins());
+    EXPECT_EQ(back.count(0), 2u);
+    EXPECT_EQ(back.count(140), 1u);
+    EXPECT_EQ(back.underflow(), 1u);
+    back.merge(h);
+    EXPECT_EQ(back.count(0), 4u);
+
+    // Read back into another length unit: edges are rescaled
+    auto km = Histogram<Kilometer>::deserialize(bytes.data(), bytes.size());
+    EXPECT_DOUBLE_EQ(km.upper(km.bins() - 1).value(), 1.0);
+    EXPECT_EQ(km.count(140), 1u);
+
+    std::vector<Second> edges = {Second(0.0), Second(1.0), Second(3.0)};
+    auto c = Histogram<Second>::custom(edges.data(), edges.size());
+    std::vector<Second> big(300, Second(2.0));
+    c.fill(big.data(), big.size());
+    const auto cb = c.serialize();
+    auto cback = Histogram<Second>::deserialize(cb.data(), cb.size());
+    EXPECT_EQ(cback.binning(), Binning::Custom);
+    EXPECT_EQ(cback.count(1), 300u);
+
+    EXPECT_THROW(Histogram<Second>::deserialize(bytes.data(), bytes.size()),
+                 IncompatibleDimensionsError);
+    EXPECT_THROW(Histogram<Meter>::deserialize(bytes.data(), bytes.size() - 1),
+                 std::invalid_argument);
+
+    // A short input claiming ~4e9 bins is rejected before anything is allocated
+    std::vector<std::uint8_t> huge(bytes.begin(), bytes.begin() + 10);  // magic, version, unit, kind
+    detail::put_u32(huge, 0xFFFFFFF0u);
+    detail::put_f64(huge, 0.0);
+    detail::put_f64(huge, 1.0);
+    detail::put_varint(huge, 0);
+    EXPECT_THROW(Histogram<Meter>::deserialize(huge.data(), huge.size()), std::invalid_argument);
+}
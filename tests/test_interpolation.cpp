@@ -0,0 +1,131 @@
+#include "fixtures.hpp"
+#include "qtty/interpolation.hpp"
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+TEST_F(LookupTableTest, LinearUniform) {
+    std::vector<Watt> p = {Watt(0.0), Watt(10.0), Watt(30.0)};
+    auto t = LookupTable<Second, Watt>::uniform(Second(0.0), Second(2.0), p.data(), p.size());
+    EXPECT_TRUE(t.is_uniform());
+    EXPECT_DOUBLE_EQ(t(Second(0.5)).value(), 5.0);
+    EXPECT_DOUBLE_EQ(t(Second(1.5)).value(), 20.0);
+    EXPECT_DOUBLE_EQ(t(Second(2.0)).value(), 30.0);
+    // Clamped outside the range
+    EXPECT_DOUBLE_EQ(t(Second(-1.0)).value(), 0.0);
+    EXPECT_DOUBLE_EQ(t(Second(9.0)).value(), 30.0);
+    EXPECT_TRUE(std::isnan(t(Second(std::numeric_limits<double>::quiet_NaN())).value()));
+    // Query in another unit
+    EXPECT_DOUBLE_EQ(t(Millisecond(1500.0)).value(), 20.0);
+}
+
+TEST_F(LookupTableTest, LinearNonUniformAndNanExtrapolation) {
+    std::vector<Meter> x = {Meter(0.0), Meter(1.0), Meter(4.0)};
+    std::vector<Watt> y = {Watt(1.0), Watt(2.0), Watt(8.0)};
+    auto t = LookupTable<Meter, Watt>::from_points(x.data(), y.data(), x.size(),
+                                                  Interpolation::Linear, Extrapolation::Nan);
+    EXPECT_FALSE(t.is_uniform());
+    EXPECT_DOUBLE_EQ(t(Meter(0.5)).value(), 1.5);
+    EXPECT_DOUBLE_EQ(t(Meter(1.0)).value(), 2.0);
+    EXPECT_DOUBLE_EQ(t(Meter(2.5)).value(), 5.0);
+    EXPECT_DOUBLE_EQ(t(Meter(4.0)).value(), 8.0);
+    EXPECT_TRUE(std::isnan(t(Meter(-0.1)).value()));
+    EXPECT_TRUE(std::isnan(t(Meter(4.1)).value()));
+    EXPECT_DOUBLE_EQ(t(Kilometer(0.0025)).value(), 5.0);
+}
+
+TEST_F(LookupTableTest, CubicReproducesSmoothCurve) {
+    const std::size_t n = 41;
+    std::vector<Second> x(n);
+    std::vector<Watt> y(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const double s = 0.1 * static_cast<double>(i) + 0.002 * static_cast<double>(i * i);
+        x[i] = Second(s);
+        y[i] = Watt(std::sin(s));
+    }
+    auto cubic = LookupTable<Second, Watt>::from_points(x.data(), y.data(), n, Interpolation::Cubic);
+    auto linear = LookupTable<Second, Watt>::from_points(x.data(), y.data(), n);
+    double err_cubic = 0.0, err_linear = 0.0;
+    for (double s = 0.5; s < 6.5; s += 0.013) {
+        err_cubic = std::max(err_cubic, std::fabs(cubic(Second(s)).value() - std::sin(s)));
+        err_linear = std::max(err_linear, std::fabs(linear(Second(s)).value() - std::sin(s)));
+    }
+    EXPECT_LT(err_cubic, 1e-4);
+    EXPECT_LT(err_cubic * 20.0, err_linear);
+    // Knots are interpolated exactly
+    for (std::size_t i = 0; i < n; ++i) {
+        EXPECT_NEAR(cubic(x[i]).value(), y[i].value(), 1e-12);
+    }
+}
+
+TEST_F(LookupTableTest, UniformCubicMatchesPoints) {
+    const std::size_t n = 17;
+    std::vector<Second> x(n);
+    std::vector<Watt> y(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        x[i] = Second(0.25 * static_cast<double>(i));
+        y[i] = Watt(std::exp(-x[i].value()));
+    }
+    auto u = LookupTable<Second, Watt>::uniform(x.front(), x.back(), y.data(), n,
+                                               Interpolation::Cubic);
+    auto p = LookupTable<Second, Watt>::from_points(x.data(), y.data(), n, Interpolation::Cubic);
+    for (double s = -0.5; s < 4.5; s += 0.07) {
+        EXPECT_NEAR(u(Second(s)).value(), p(Second(s)).value(), 1e-12) << s;
+    }
+}
+
+TEST_F(LookupTableTest, BoundEvaluatorFoldsUnits) {
+    std::vector<Watt> p = {Watt(0.0), Watt(1.0), Watt(4.0), Watt(9.0)};
+    auto t = LookupTable<Second, Watt>::uniform(Second(0.0), Second(3.0), p.data(), p.size(),
+                                               Interpolation::Cubic);
+    std::vector<Second> xs = {Second(0.2), Second(1.7), Second(2.9)};
+    std::vector<Millisecond> xms = {Millisecond(200.0), Millisecond(1700.0), Millisecond(2900.0)};
+
+    std::vector<Watt> ref(xs.size());
+    t.eval(xs.data(), ref.data(), xs.size());
+
+    auto in_ms = t.for_unit<MillisecondTag, MilliwattTag>();
+    std::vector<Milliwatt> out(xms.size());
+    in_ms.eval(xms.data(), out.data(), xms.size());
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+        EXPECT_NEAR(out[i].value(), ref[i].value() * 1e3, 1e-9);
+    }
+    EXPECT_NEAR(in_ms(Millisecond(1700.0)).value(), ref[1].value() * 1e3, 1e-9);
+
+    std::vector<Second> knots = {Second(0.0), Second(0.5), Second(3.0)};
+    auto nu = LookupTable<Second, Watt>::from_points(knots.data(), p.data(), 3);
+    auto nu_ms = nu.for_unit<MillisecondTag>();
+    EXPECT_NEAR(nu_ms(Millisecond(1750.0)).value(), nu(Second(1.75)).value(), 1e-12);
+    std::vector<Watt> batch_out(xms.size());
+    nu.eval(xms.data(), batch_out.data(), xms.size());
+    EXPECT_NEAR(batch_out[2].value(), nu(Second(2.9)).value(), 1e-12);
+}
+
+TEST_F(LookupTableTest, EvaluatorSurvivesTableMove) {
+    std::vector<Second> x = {Second(0.0), Second(1.0), Second(2.0), Second(4.0)};
+    std::vector<Watt> y = {Watt(0.0), Watt(2.0), Watt(1.0), Watt(3.0)};
+    const double expected = LookupTable<Second, Watt>::from_points(x.data(), y.data(), 4,
+                                                                   Interpolation::Cubic)(Second(1.5)).value();
+
+    std::vector<LookupTable<Second, Watt>> tables;
+    tables.push_back(LookupTable<Second, Watt>::from_points(x.data(), y.data(), 4, Interpolation::Cubic));
+    auto in_ms = tables.front().for_unit<MillisecondTag>();
+    for (int i = 0; i < 16; ++i) {  // reallocate the vector under the evaluator
+        tables.push_back(tables.front());
+    }
+    auto moved = std::move(tables.front());
+    tables.clear();
+    EXPECT_DOUBLE_EQ(in_ms(Millisecond(1500.0)).value(), expected);
+    EXPECT_DOUBLE_EQ(moved(Second(1.5)).value(), expected);
+}
+
+TEST_F(LookupTableTest, InvalidInput) {
+    std::vector<Meter> x = {Meter(0.0), Meter(0.0)};
+    std::vector<Watt> y = {Watt(1.0), Watt(2.0)};
+    EXPECT_THROW((LookupTable<Meter, Watt>::from_points(x.data(), y.data(), 2)), std::invalid_argument);
+    EXPECT_THROW((LookupTable<Meter, Watt>::from_points(x.data(), y.data(), 1)), std::invalid_argument);
+    EXPECT_THROW((LookupTable<Meter, Watt>::uniform(Meter(1.0), Meter(0.0), y.data(), 2)),
+                 std::invalid_argument);
+}
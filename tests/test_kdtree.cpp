@@ -0,0 +1,113 @@
+#include "fixtures.hpp"
+#include "qtty/kdtree.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+
+Vec3Array<Meter> random_points(std::size_t n, unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> u(-1000.0, 1000.0);
+    Vec3Array<Meter> pts;
+    for (std::size_t i = 0; i < n; ++i) {
+        // Flattened cloud so the widest-axis choice matters
+        pts.push_back({Meter(u(rng)), Meter(u(rng) * 0.1), Meter(u(rng) * 0.01)});
+    }
+    // Duplicates
+    for (int i = 0; i < 50; ++i) {
+        pts.push_back({Meter(1.0), Meter(2.0), Meter(3.0)});
+    }
+    return pts;
+}
+
+std::vector<std::uint32_t> brute_radius(const Vec3Array<Meter>& pts, const Vec3<Meter>& c,
+                                        double r) {
+    std::vector<std::uint32_t> rows;
+    for (std::size_t i = 0; i < pts.size(); ++i) {
+        if (norm2(pts[i] - c).value() <= r * r) {
+            rows.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+    return rows;
+}
+
+} // namespace
+
+TEST_F(KdTreeTest, RadiusSearchMatchesBruteForce) {
+    const Vec3Array<Meter> pts = random_points(30000, 1);
+    KdTreeOptions opts;
+    opts.threads = 4;
+    const KdTree<Meter> tree = KdTree<Meter>::build(pts, opts);
+    EXPECT_EQ(tree.size(), pts.size());
+
+    const Vec3<Meter> centers[] = {{Meter(0.0), Meter(0.0), Meter(0.0)},
+                                   {Meter(1.0), Meter(2.0), Meter(3.0)},
+                                   {Meter(-990.0), Meter(90.0), Meter(-5.0)}};
+    for (const auto& c : centers) {
+        for (double r : {0.0, 5.0, 60.0, 400.0}) {
+            std::vector<std::uint32_t> got = tree.radius_search(c, Meter(r));
+            std::sort(got.begin(), got.end());
+            EXPECT_EQ(got, brute_radius(pts, c, r)) << r;
+        }
+    }
+}
+
+TEST_F(KdTreeTest, TypedRadiusAndQueryUnits) {
+    const Vec3Array<Meter> pts = random_points(5000, 2);
+    const KdTree<Meter> tree = KdTree<Meter>::build(pts);
+    const Vec3<Kilometer> c_km{Kilometer(0.1), Kilometer(0.0), Kilometer(0.0)};
+    std::vector<std::uint32_t> a = tree.radius_search(c_km, Kilometer(0.075));
+    std::vector<std::uint32_t> b =
+        tree.radius_search(Vec3<Meter>{Meter(100.0), Meter(0.0), Meter(0.0)}, Meter(75.0));
+    std::sort(a.begin(), a.end());
+    std::sort(b.begin(), b.end());
+    EXPECT_FALSE(a.empty());
+    EXPECT_EQ(a, b);
+}
+
+TEST_F(KdTreeTest, NearestMatchesBruteForce) {
+    const Vec3Array<Meter> pts = random_points(20000, 3);
+    const KdTree<Meter> tree = KdTree<Meter>::build(pts);
+    const Vec3Array<Meter> probes = random_points(300, 4);
+
+    std::vector<std::uint32_t> index(probes.size());
+    std::vector<Kilometer> dist(probes.size());
+    batch::nearest(tree, probes, index.data(), dist.data(), 4);
+    for (std::size_t q = 0; q < probes.size(); ++q) {
+        double best = std::numeric_limits<double>::infinity();
+        for (std::size_t i = 0; i < pts.size(); ++i) {
+            best = std::min(best, distance(pts[i], probes[q]).value());
+        }
+        EXPECT_NEAR(dist[q].value() * 1000.0, best, 1e-9);
+        EXPECT_NEAR(distance(pts[index[q]], probes[q]).value(), best, 1e-9);
+    }
+}
+
+TEST_F(KdTreeTest, BatchRadiusAndEdgeCases) {
+    const Vec3Array<Meter> pts = random_points(4000, 5);
+    const KdTree<Meter> tree = KdTree<Meter>::build(pts);
+    const Vec3Array<Meter> probes = random_points(100, 6);
+    std::vector<std::vector<std::uint32_t>> hits;
+    batch::radius_search(tree, probes, Meter(50.0), hits, 3);
+    ASSERT_EQ(hits.size(), probes.size());
+    for (std::size_t q = 0; q < probes.size(); ++q) {
+        std::sort(hits[q].begin(), hits[q].end());
+        EXPECT_EQ(hits[q], brute_radius(pts, probes[q], 50.0));
+    }
+
+    for (std::size_t n : {std::size_t{1}, std::size_t{2}, std::size_t{3}, std::size_t{17}}) {
+        Vec3Array<Meter> few;
+        for (std::size_t i = 0; i < n; ++i) {
+            few.push_back({Meter(static_cast<double>(i)), Meter(0.0), Meter(0.0)});
+        }
+        KdTreeOptions opts;
+        opts.leaf_size = 1;
+        const KdTree<Meter> t = KdTree<Meter>::build(few, opts);
+        EXPECT_EQ(t.nearest(Vec3<Meter>{Meter(n - 0.9), Meter(0.0), Meter(0.0)}).index, n - 1);
+        EXPECT_EQ(t.radius_search(Vec3<Meter>{Meter(0.0), Meter(0.0), Meter(0.0)}, Meter(100.0)).size(), n);
+    }
+    EXPECT_THROW(KdTree<Meter>().nearest(Vec3<Meter>{}), std::out_of_range);
+    EXPECT_TRUE(KdTree<Meter>().radius_search(Vec3<Meter>{}, Meter(1.0)).empty());
+}
@@ -0,0 +1,130 @@
+#include "fixtures.hpp"
+#include "qtty/math.hpp"
+
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+TEST_F(MathFunctionsTest, PowersTrackUnitExponent) {
+    Meter side(3.0);
+    auto area = square(side);
+    static_assert(std::is_same<decltype(area), Quantity<PowTag<MeterTag, 2>>>::value, "m^2");
+    EXPECT_EQ(area.value(), 9.0);
+
+    auto volume = pow<3>(side);
+    static_assert(std::is_same<decltype(volume), Cubed<Meter>>::value, "m^3");
+    EXPECT_NEAR(volume.value(), 27.0, 1e-12);
+
+    Meter back = sqrt(area);
+    EXPECT_EQ(back.value(), 3.0);
+    Meter back3 = cbrt(volume);
+    EXPECT_NEAR(back3.value(), 3.0, 1e-12);
+
+    auto m6 = pow<2>(volume);
+    static_assert(std::is_same<decltype(m6), Quantity<PowTag<MeterTag, 6>>>::value, "m^6");
+    Cubed<Meter> m3 = sqrt(m6);
+    EXPECT_NEAR(m3.value(), 27.0, 1e-9);
+}
+
+TEST_F(MathFunctionsTest, HypotAndFma) {
+    Meter d = hypot(Meter(3.0), Meter(4.0), Meter(12.0));
+    EXPECT_EQ(d.value(), 13.0);
+    EXPECT_EQ(hypot(Meter(3.0), Meter(4.0)).value(), 5.0);
+
+    // velocity * time + start position
+    auto v = Meter(10.0) / Second(1.0);
+    Meter x = fma(v, Second(3.0), Meter(2.0));
+    EXPECT_EQ(x.value(), 32.0);
+
+    EXPECT_EQ(fma(Meter(2.0), 3.0, Meter(1.0)).value(), 7.0);
+    EXPECT_EQ(fma(Meter(2.0), Meter(3.0), Squared<Meter>(1.0)).value(), 7.0);
+}
+
+TEST_F(MathFunctionsTest, SelectionAndLerp) {
+    EXPECT_EQ(min(Meter(1.0), Meter(2.0)).value(), 1.0);
+    EXPECT_EQ(max(Meter(1.0), Meter(2.0)).value(), 2.0);
+    EXPECT_EQ(clamp(Meter(5.0), Meter(0.0), Meter(2.0)).value(), 2.0);
+    EXPECT_EQ(clamp(Meter(-5.0), Meter(0.0), Meter(2.0)).value(), 0.0);
+    EXPECT_EQ(lerp(Meter(1.0), Meter(3.0), 0.5).value(), 2.0);
+    EXPECT_EQ(lerp(Meter(0.1), Meter(0.7), 1.0).value(), 0.7);
+}
+
+TEST_F(MathFunctionsTest, RoundToUnit) {
+    EXPECT_EQ(floor_to(Second(125.0), Second(60.0)).value(), 120.0);
+    EXPECT_EQ(floor_to<Minute>(Second(125.0)).value(), 120.0);
+    EXPECT_EQ(ceil_to<Minute>(Second(125.0)).value(), 180.0);
+    EXPECT_EQ(round_to<Hour>(Minute(100.0)).value(), 120.0);
+    EXPECT_EQ(floor(Meter(2.7)).value(), 2.0);
+    EXPECT_EQ(round(Meter(-2.5)).value(), -3.0);
+}
+
+TEST_F(MathFunctionsTest, BatchMatchesScalar) {
+    const std::size_t n = 1003;
+    std::vector<Meter> x(n), y(n), z(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        x[i] = Meter(0.5 * static_cast<double>(i) - 200.0);
+        y[i] = Meter(1e150 * std::sin(static_cast<double>(i)));
+        z[i] = Meter(3.0);
+    }
+
+    std::vector<Meter> out(n);
+    batch::hypot(x.data(), y.data(), out.data(), n);
+    for (std::size_t i = 0; i < n; ++i) {
+        EXPECT_NEAR(out[i].value(), hypot(x[i], y[i]).value(),
+                    4e-16 * hypot(x[i], y[i]).value());
+    }
+
+    batch::hypot(x.data(), z.data(), z.data(), out.data(), n);
+    for (std::size_t i = 0; i < n; ++i) {
+        EXPECT_NEAR(out[i].value(), hypot(x[i], z[i], z[i]).value(),
+                    1e-15 * hypot(x[i], z[i], z[i]).value());
+    }
+
+    std::vector<Squared<Meter>> sq(n);
+    batch::square(x.data(), sq.data(), n);
+    batch::sqrt(sq.data(), out.data(), n);
+    for (std::size_t i = 0; i < n; ++i) {
+        EXPECT_EQ(out[i].value(), x[i].abs().value());
+    }
+
+    batch::clamp(x.data(), Meter(-10.0), Meter(10.0), out.data(), n);
+    for (std::size_t i = 0; i < n; ++i) {
+        EXPECT_EQ(out[i], clamp(x[i], Meter(-10.0), Meter(10.0)));
+    }
+
+    batch::fma(x.data(), 2.0, z.data(), out.data(), n);
+    batch::min(x.data(), z.data(), x.data(), n);  // in-place
+    for (std::size_t i = 0; i < n; ++i) {
+        EXPECT_EQ(out[i].value(), 2.0 * (0.5 * static_cast<double>(i) - 200.0) + 3.0);
+        EXPECT_LE(x[i].value(), 3.0);
+    }
+
+    std::vector<Second> t = {Second(59.0), Second(61.0), Second(-1.0)};
+    std::vector<Second> rounded(t.size());
+    batch::floor_to<Minute>(t.data(), rounded.data(), t.size());
+    EXPECT_EQ(rounded[0].value(), 0.0);
+    EXPECT_EQ(rounded[1].value(), 60.0);
+    EXPECT_EQ(rounded[2].value(), -60.0);
+}
+
+TEST_F(MathFunctionsTest, BatchHypotInfinity) {
+    // IEEE 754 hypot: any infinite argument gives +inf, even alongside NaN
+    const double inf = std::numeric_limits<double>::infinity();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const std::vector<Meter> x = {Meter(inf), Meter(inf), Meter(nan), Meter(-inf), Meter(nan)};
+    const std::vector<Meter> y = {Meter(inf), Meter(nan), Meter(-inf), Meter(1.0), Meter(1.0)};
+    std::vector<Meter> out(x.size());
+
+    batch::hypot(x.data(), y.data(), out.data(), x.size());
+    for (std::size_t i = 0; i + 1 < x.size(); ++i) {
+        EXPECT_EQ(out[i].value(), inf) << i;
+    }
+    EXPECT_TRUE(std::isnan(out.back().value()));
+
+    batch::hypot(x.data(), y.data(), y.data(), out.data(), x.size());
+    for (std::size_t i = 0; i + 1 < x.size(); ++i) {
+        EXPECT_EQ(out[i].value(), inf) << i;
+    }
+    EXPECT_TRUE(std::isnan(out.back().value()));
+}
@@ -0,0 +1,150 @@
+#include "fixtures.hpp"
+#include "qtty/pipeline.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::vector<std::vector<Meter>> meter_batches(std::size_t batches, std::size_t size) {
+    std::vector<std::vector<Meter>> out(batches);
+    for (std::size_t b = 0; b < batches; ++b) {
+        for (std::size_t i = 0; i < size; ++i) {
+            out[b].push_back(Meter(static_cast<double>(b * size + i)));
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+TEST_F(PipelineTest, ConvertsInSourceOrderAcrossThreads) {
+    auto p = Pipeline<std::vector<Meter>>()
+                 .then("convert", stages::convert<KilometerTag>())
+                 .then("double", [](std::vector<Kilometer>&& v) {
+                     for (auto& k : v) {
+                         k = k * 2.0;
+                     }
+                     return std::move(v);
+                 });
+    EXPECT_EQ(p.stage_count(), 2u);
+
+    std::vector<Kilometer> out;
+    PipelineOptions opts;
+    opts.threads = 4;
+    opts.queue_capacity = 4;  // smaller than the batch count: exercises backpressure
+    PipelineStats stats = p.run(meter_batches(200, 50), stages::append_to(out), opts);
+
+    ASSERT_EQ(out.size(), 200u * 50u);
+    for (std::size_t i = 0; i < out.size(); ++i) {
+        ASSERT_DOUBLE_EQ(out[i].value(), 2.0 * static_cast<double>(i) / 1000.0);
+    }
+    EXPECT_EQ(stats.batches, 200u);
+    ASSERT_EQ(stats.stages.size(), 2u);
+    EXPECT_EQ(stats.stages[0].name, "convert");
+    EXPECT_EQ(stats.stages[0].batches, 200u);
+    EXPECT_EQ(stats.stages[1].items, 200u * 50u);
+    EXPECT_GE(stats.stages[0].items_per_second(), 0.0);
+}
+
+TEST_F(PipelineTest, ParseValidateConvertAggregate) {
+    std::vector<std::vector<std::string>> lines = {{"1000", "2000"}, {"3000", "-5"}, {"4000"}};
+    auto p = Pipeline<std::vector<std::string>>()
+                 .then("parse", stages::parse<Meter>())
+                 .then("validate", stages::keep_between(Meter(0.0), Kilometer(10.0)))
+                 .then("convert", stages::convert<Kilometer>());
+
+    RunningStats<Kilometer> stats;
+    p.run(std::move(lines), stages::accumulate(stats));
+    EXPECT_EQ(stats.count(), 4u);
+    EXPECT_DOUBLE_EQ(stats.mean().value(), 2.5);
+}
+
+TEST_F(PipelineTest, KeepFiniteAndSerialize) {
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    std::vector<std::vector<Second>> in = {{Second(1.5), Second(nan), Second(2.0)}};
+    auto p = Pipeline<std::vector<Second>>().then("validate", stages::keep_finite()).then("serialize", stages::to_json());
+
+    std::vector<std::string> json;
+    p.run(std::move(in), stages::append_to(json));
+    ASSERT_EQ(json.size(), 2u);
+    EXPECT_DOUBLE_EQ(std::stod(json[0]), 1.5);
+    EXPECT_DOUBLE_EQ(std::stod(json[1]), 2.0);
+}
+
+TEST_F(PipelineTest, CallableSource) {
+    int produced = 0;
+    auto source = [&](std::vector<Meter>& out) {
+        if (produced == 10) {
+            return false;
+        }
+        out.assign(3, Meter(static_cast<double>(produced++)));
+        return true;
+    };
+    std::vector<Meter> out;
+    Pipeline<std::vector<Meter>>().run(source, stages::append_to(out));
+    ASSERT_EQ(out.size(), 30u);
+    EXPECT_EQ(out[29].value(), 9.0);
+}
+
+TEST_F(PipelineTest, StageErrorsPropagate) {
+    auto p = Pipeline<std::vector<Meter>>().then("boom", [](std::vector<Meter>&& v) {
+        if (!v.empty() && v[0].value() >= 500.0) {
+            throw std::runtime_error("bad batch");
+        }
+        return std::move(v);
+    });
+    std::vector<Meter> out;
+    PipelineOptions opts;
+    opts.threads = 2;
+    EXPECT_THROW(p.run(meter_batches(100, 10), stages::append_to(out), opts), std::runtime_error);
+    // Batches before the failing one are delivered in order; none after it
+    EXPECT_LE(out.size(), 500u);
+    for (std::size_t i = 0; i < out.size(); ++i) {
+        ASSERT_EQ(out[i].value(), static_cast<double>(i));
+    }
+}
+
+TEST_F(PipelineTest, SlowBatchBoundsReadAhead) {
+    // Batch 10 stalls on a worker, so later batches finish first and wait in
+    // the reorder buffer; the source must stop being read at the in-flight cap
+    const std::thread::id caller = std::this_thread::get_id();
+    auto p = Pipeline<std::vector<Meter>>().then("stall", [caller](std::vector<Meter>&& v) {
+        if (v[0].value() == 10.0 && std::this_thread::get_id() != caller) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        return std::move(v);
+    });
+    PipelineOptions opts;
+    opts.threads = 3;
+    opts.queue_capacity = 4;
+    const std::uint64_t limit = opts.queue_capacity * p.stage_count();
+
+    std::atomic<std::uint64_t> delivered{0};
+    std::uint64_t read = 0;
+    std::uint64_t max_ahead = 0;
+    auto source = [&](std::vector<Meter>& out) {
+        if (read == 200) {
+            return false;
+        }
+        max_ahead = std::max(max_ahead, read - delivered.load());
+        out.assign(1, Meter(static_cast<double>(read++)));
+        return true;
+    };
+    double expected = 0.0;
+    bool in_order = true;
+    p.run(source, [&](std::vector<Meter>&& v) {
+        in_order &= v[0].value() == expected;
+        expected += 1.0;
+        delivered.fetch_add(1);
+    }, opts);
+    EXPECT_TRUE(in_order);
+    EXPECT_EQ(delivered.load(), 200u);
+    EXPECT_LT(max_ahead, limit);
+}
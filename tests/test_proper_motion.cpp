@@ -0,0 +1,95 @@
+#include "fixtures.hpp"
+#include "qtty/proper_motion.hpp"
+#include "qtty/separation.hpp"
+
+#include <vector>
+
+TEST_F(ProperMotionTest, CompileTimeScales) {
+    EXPECT_EQ(detail::seconds_per_unit<JulianYearTag>(), 31557600.0);
+    EXPECT_EQ(detail::seconds_per_unit<DayTag>(), 86400.0);
+    EXPECT_DOUBLE_EQ(detail::seconds_per_unit<JulianCenturyTag>(),
+                     (conversion_factor<JulianCenturyTag, SecondTag>()));
+    // 1 mas/yr over 1 yr
+    EXPECT_DOUBLE_EQ((detail::rate_to_radians<CompoundTag<MilliArcsecondTag, JulianYearTag>,
+                                              JulianYearTag>(1.0)),
+                     M_PI / 180.0 / 3.6e6);
+}
+
+TEST_F(ProperMotionTest, MotionAlongAxes) {
+    // 1000 mas/yr for 3600 yr is one degree
+    SkyCoord<DegreeTag> north = propagate(Degree(30.0), Degree(0.0), MasPerYear(0.0),
+                                          MasPerYear(1000.0), JulianYear(0.0), JulianYear(3600.0));
+    EXPECT_NEAR(north.lon.value(), 30.0, 1e-12);
+    EXPECT_NEAR(north.lat.value(), 1.0, 1e-12);
+
+    SkyCoord<DegreeTag> east = propagate(Degree(359.5), Degree(0.0), MasPerYear(1000.0),
+                                         MasPerYear(0.0), JulianYear(2000.0), JulianYear(5600.0));
+    EXPECT_NEAR(east.lon.value(), 0.5, 1e-12);
+    EXPECT_NEAR(east.lat.value(), 0.0, 1e-12);
+
+    // Crossing the pole flips the longitude by half a turn
+    SkyCoord<DegreeTag> over = propagate(Degree(10.0), Degree(89.5), MasPerYear(0.0),
+                                         MasPerYear(1000.0), JulianYear(0.0), JulianYear(3600.0));
+    EXPECT_NEAR(over.lon.value(), 190.0, 1e-9);
+    EXPECT_NEAR(over.lat.value(), 89.5, 1e-9);
+
+    SkyCoord<DegreeTag> rest = propagate(Degree(12.0), Degree(-45.0), MasPerYear(0.0),
+                                         MasPerYear(0.0), JulianYear(0.0), JulianYear(100.0));
+    EXPECT_NEAR(rest.lon.value(), 12.0, 1e-13);
+    EXPECT_NEAR(rest.lat.value(), -45.0, 1e-13);
+}
+
+TEST_F(ProperMotionTest, DistanceMatchesRateTimesInterval) {
+    // Barnard's star: large motion, displacement equals |mu| * dt
+    const Degree ra(269.452), dec(4.6933);
+    const MasPerYear pmra(-801.551), pmdec(10362.394);
+    SkyCoord<DegreeTag> p = propagate(ra, dec, pmra, pmdec, JulianYear(2016.0), JulianYear(2116.0));
+    const double expected_mas = std::hypot(pmra.value(), pmdec.value()) * 100.0;
+    const double got_mas = separation(ra, dec, p.lon, p.lat).value() * 180.0 / M_PI * 3.6e6;
+    EXPECT_NEAR(got_mas, expected_mas, 1e-6);
+}
+
+TEST_F(ProperMotionTest, UnitsCombineConsistently) {
+    using ArcsecPerCentury = ProperMotion<ArcsecondTag, JulianCenturyTag>;
+    SkyCoord<DegreeTag> a = propagate(Degree(80.0), Degree(20.0), MasPerYear(50.0),
+                                      MasPerYear(-30.0), JulianYear(2000.0), JulianYear(2050.0));
+    SkyCoord<DegreeTag> b = propagate(Degree(80.0), Degree(20.0), ArcsecPerCentury(5.0),
+                                      ArcsecPerCentury(-3.0), Day(0.0), Day(50.0 * 365.25));
+    EXPECT_NEAR(a.lon.value(), b.lon.value(), 1e-12);
+    EXPECT_NEAR(a.lat.value(), b.lat.value(), 1e-12);
+}
+
+TEST_F(ProperMotionTest, BatchMatchesScalar) {
+    const std::size_t n = 50000;
+    std::vector<Degree> ra(n), dec(n);
+    std::vector<MasPerYear> pmra(n), pmdec(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const double t = static_cast<double>(i);
+        ra[i] = Degree(std::fmod(t * 0.731, 360.0));
+        dec[i] = Degree(std::fmod(t * 0.377, 179.0) - 89.5);
+        pmra[i] = MasPerYear(std::fmod(t * 3.1, 400.0) - 200.0);
+        pmdec[i] = MasPerYear(std::fmod(t * 1.7, 300.0) - 150.0);
+    }
+    std::vector<Radian> ra_out(n), dec_out(n);
+    ProperMotionOptions opts;
+    opts.threads = 4;
+    batch::propagate(ra.data(), dec.data(), pmra.data(), pmdec.data(), JulianYear(2016.0),
+                     JulianYear(2000.0), ra_out.data(), dec_out.data(), n, opts);
+    for (std::size_t i = 0; i < n; i += 997) {
+        SkyCoord<DegreeTag> s = propagate(ra[i], dec[i], pmra[i], pmdec[i], JulianYear(2016.0),
+                                          JulianYear(2000.0));
+        EXPECT_NEAR(ra_out[i].value(), s.lon.value() * M_PI / 180.0, 1e-13);
+        EXPECT_NEAR(dec_out[i].value(), s.lat.value() * M_PI / 180.0, 1e-13);
+    }
+
+    // In place, fast mode stays within a micro-arcsecond
+    std::vector<Degree> ra_fast = ra, dec_fast = dec;
+    opts.accuracy = Accuracy::Fast;
+    batch::propagate(ra_fast.data(), dec_fast.data(), pmra.data(), pmdec.data(),
+                     JulianYear(2016.0), JulianYear(2000.0), ra_fast.data(), dec_fast.data(), n,
+                     opts);
+    for (std::size_t i = 0; i < n; i += 997) {
+        const double d = separation(ra_fast[i], dec_fast[i], ra_out[i], dec_out[i]).value();
+        EXPECT_LT(d * 180.0 / M_PI * 3.6e9, 1.0);
+    }
+}
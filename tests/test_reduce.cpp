@@ -0,0 +1,124 @@
+#include "fixtures.hpp"
+#include "qtty/reduce.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+// Values spanning many magnitudes with alternating signs, which defeats
+// naive summation
+std::vector<Meter> ill_conditioned(std::size_t n, unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> mant(1.0, 2.0);
+    std::uniform_int_distribution<int> expo(-20, 20);
+    std::vector<Meter> v(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const double x = std::ldexp(mant(rng), expo(rng));
+        v[i] = Meter(i % 2 == 0 ? x : -x);
+    }
+    return v;
+}
+
+long double reference_sum(const std::vector<Meter>& v) {
+    long double s = 0.0L;
+    for (const auto& x : v) {
+        s += x.value();
+    }
+    return s;
+}
+
+bool same_bits(double a, double b) {
+    return std::memcmp(&a, &b, sizeof a) == 0;
+}
+
+} // namespace
+
+TEST_F(ReduceTest, EmptyAndSmall) {
+    EXPECT_EQ(batch::sum(static_cast<const Meter*>(nullptr), 0).value(), 0.0);
+    EXPECT_TRUE(std::isnan(batch::mean(static_cast<const Meter*>(nullptr), 0).value()));
+
+    std::vector<Second> t = {Second(1.0), Second(2.0), Second(3.5)};
+    for (SumMethod m : {SumMethod::Naive, SumMethod::Neumaier, SumMethod::Pairwise,
+                        SumMethod::Reproducible}) {
+        ReduceOptions opts;
+        opts.method = m;
+        EXPECT_DOUBLE_EQ(batch::sum(t.data(), t.size(), opts).value(), 6.5);
+        EXPECT_DOUBLE_EQ(batch::mean(t.data(), t.size(), opts).value(), 6.5 / 3.0);
+    }
+}
+
+TEST_F(ReduceTest, TypedResults) {
+    std::vector<Meter> a = {Meter(1.0), Meter(2.0), Meter(3.0)};
+    std::vector<Meter> b = {Meter(4.0), Meter(5.0), Meter(6.0)};
+    std::vector<double> w = {0.5, 0.25, 0.25};
+
+    auto dd = batch::dot(a.data(), b.data(), a.size());
+    static_assert(std::is_same<decltype(dd), Squared<Meter>>::value, "dot squares the unit");
+    EXPECT_DOUBLE_EQ(dd.value(), 32.0);
+
+    auto wd = batch::dot(a.data(), w.data(), a.size());
+    static_assert(std::is_same<decltype(wd), Meter>::value, "weights are dimensionless");
+    EXPECT_DOUBLE_EQ(wd.value(), 1.75);
+}
+
+TEST_F(ReduceTest, CompensatedBeatsNaive) {
+    const auto v = ill_conditioned(200000, 7);
+    const long double ref = reference_sum(v);
+    const double scale = std::ldexp(1.0, 20);
+
+    ReduceOptions opts;
+    opts.threads = 1;
+    opts.method = SumMethod::Neumaier;
+    const double kahan = batch::sum(v.data(), v.size(), opts).value();
+    opts.method = SumMethod::Reproducible;
+    const double repro = batch::sum(v.data(), v.size(), opts).value();
+    opts.method = SumMethod::Pairwise;
+    const double pairwise = batch::sum(v.data(), v.size(), opts).value();
+
+    EXPECT_LE(std::fabs(kahan - static_cast<double>(ref)), 1e-15 * scale);
+    EXPECT_LE(std::fabs(repro - static_cast<double>(ref)), 1e-15 * scale);
+    EXPECT_LE(std::fabs(pairwise - static_cast<double>(ref)), 1e-12 * scale);
+}
+
+TEST_F(ReduceTest, ReproducibleAcrossThreadCounts) {
+    const auto v = ill_conditioned(300001, 11);
+    ReduceOptions opts;
+    opts.method = SumMethod::Reproducible;
+    opts.threads = 1;
+    const double s1 = batch::sum(v.data(), v.size(), opts).value();
+    const double d1 = batch::dot(v.data(), v.data(), v.size(), opts).value();
+    for (unsigned threads : {2u, 3u, 7u, 16u}) {
+        opts.threads = threads;
+        EXPECT_TRUE(same_bits(batch::sum(v.data(), v.size(), opts).value(), s1)) << threads;
+        EXPECT_TRUE(same_bits(batch::dot(v.data(), v.data(), v.size(), opts).value(), d1))
+            << threads;
+    }
+}
+
+TEST_F(ReduceTest, ParallelMatchesSerial) {
+    const auto v = ill_conditioned(250000, 3);
+    const long double ref = reference_sum(v);
+    const double scale = std::ldexp(1.0, 20);
+    for (SumMethod m : {SumMethod::Neumaier, SumMethod::Pairwise}) {
+        ReduceOptions opts;
+        opts.method = m;
+        opts.threads = 4;
+        EXPECT_NEAR(batch::sum(v.data(), v.size(), opts).value(), static_cast<double>(ref),
+                    1e-12 * scale);
+    }
+
+    std::vector<double> raw(v.size());
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        raw[i] = v[i].value();
+    }
+    ReduceOptions naive;
+    naive.method = SumMethod::Naive;
+    naive.threads = 4;
+    const double acc = std::accumulate(raw.begin(), raw.end(), 0.0);
+    EXPECT_NEAR(batch::sum(v.data(), v.size(), naive).value(), acc, 1e-9 * scale);
+}
@@ -0,0 +1,152 @@
+#include "fixtures.hpp"
+#include "qtty/ring_buffer.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST_F(RingBufferTest, SpscSingleAndBulkWithWrapAround) {
+    SpscRing<Meter> ring(6);
+    EXPECT_EQ(ring.capacity(), 8u);
+    EXPECT_THROW(SpscRing<Meter>(0), std::invalid_argument);
+
+    Meter m;
+    EXPECT_FALSE(ring.try_pop(m));
+    EXPECT_TRUE(ring.try_push(Meter(1.0)));
+    EXPECT_TRUE(ring.try_pop(m));
+    EXPECT_EQ(m.value(), 1.0);
+
+    // Offsets now start at 1, so a 6-element push wraps on the next round
+    std::vector<Meter> in = {Meter(1), Meter(2), Meter(3), Meter(4), Meter(5), Meter(6)};
+    std::vector<Meter> out(10);
+    for (int round = 0; round < 3; ++round) {
+        ASSERT_EQ(ring.push(span<const Meter>(in)), 6u);
+        EXPECT_EQ(ring.push(span<const Meter>(in)), 2u);  // only two slots left
+        EXPECT_EQ(ring.size_approx(), 8u);
+        ASSERT_EQ(ring.pop(span<Meter>(out)), 8u);
+        EXPECT_EQ(out[5].value(), 6.0);
+        EXPECT_EQ(out[7].value(), 2.0);
+    }
+    EXPECT_EQ(ring.pop(span<Meter>(out)), 0u);
+}
+
+TEST_F(RingBufferTest, SpscPreservesOrderAcrossThreads) {
+    constexpr std::size_t kTotal = 200000;
+    SpscRing<Second> ring(1024);
+    std::thread producer([&] {
+        std::vector<Second> chunk(37);
+        std::size_t next = 0;
+        while (next < kTotal) {
+            const std::size_t n = std::min(chunk.size(), kTotal - next);
+            for (std::size_t i = 0; i < n; ++i) {
+                chunk[i] = Second(static_cast<double>(next + i));
+            }
+            std::size_t sent = 0;
+            while (sent < n) {
+                const std::size_t k = ring.push(span<const Second>(chunk.data() + sent, n - sent));
+                if (k == 0) {
+                    std::this_thread::yield();
+                }
+                sent += k;
+            }
+            next += n;
+        }
+    });
+
+    std::vector<Second> buf(64);
+    std::size_t expected = 0;
+    bool in_order = true;
+    while (expected < kTotal) {
+        const std::size_t n = ring.pop(span<Second>(buf));
+        if (n == 0) {
+            std::this_thread::yield();
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            in_order &= buf[i].value() == static_cast<double>(expected++);
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(in_order);
+}
+
+TEST_F(RingBufferTest, MpmcBulkClaimsOnlyReadySlots) {
+    MpmcRing<Meter> ring(8);
+    std::vector<Meter> in = {Meter(1), Meter(2), Meter(3), Meter(4), Meter(5), Meter(6)};
+    std::vector<Meter> out(10);
+    Meter m;
+    EXPECT_FALSE(ring.try_pop(m));
+    EXPECT_EQ(ring.pop(span<Meter>(out)), 0u);
+
+    ASSERT_EQ(ring.push(span<const Meter>(in)), 6u);
+    ASSERT_EQ(ring.pop(span<Meter>(out.data(), 4)), 4u);
+    for (int round = 0; round < 3; ++round) {
+        // Two elements left plus a push that wraps past the end
+        EXPECT_EQ(ring.push(span<const Meter>(in)), 6u);
+        EXPECT_EQ(ring.push(span<const Meter>(in)), 0u);  // full
+        EXPECT_FALSE(ring.try_push(Meter(0.0)));
+        EXPECT_EQ(ring.size_approx(), 8u);
+        ASSERT_EQ(ring.pop(span<Meter>(out)), 8u);
+        EXPECT_EQ(out[0].value(), round == 0 ? 5.0 : 1.0);
+        EXPECT_EQ(out[7].value(), 6.0);
+        ASSERT_EQ(ring.push(span<const Meter>(in.data(), 2)), 2u);
+    }
+    EXPECT_EQ(ring.pop(span<Meter>(out)), 2u);
+    EXPECT_FALSE(ring.try_pop(m));
+}
+
+TEST_F(RingBufferTest, MpmcDeliversEveryElementOnce) {
+    constexpr unsigned kProducers = 3;
+    constexpr unsigned kConsumers = 2;
+    constexpr std::size_t kPerProducer = 50000;
+    MpmcRing<Meter> ring(256);
+
+    std::atomic<std::size_t> received{0};
+    std::atomic<double> sums[kConsumers];
+    std::vector<std::thread> threads;
+    for (unsigned p = 0; p < kProducers; ++p) {
+        threads.emplace_back([&, p] {
+            std::vector<Meter> chunk(16);
+            for (std::size_t i = 0; i < kPerProducer; i += chunk.size()) {
+                for (std::size_t j = 0; j < chunk.size(); ++j) {
+                    chunk[j] = Meter(static_cast<double>(p * kPerProducer + i + j));
+                }
+                std::size_t sent = 0;
+                while (sent < chunk.size()) {
+                    const std::size_t k = ring.push(span<const Meter>(chunk.data() + sent, chunk.size() - sent));
+                    if (k == 0) {
+                        std::this_thread::yield();
+                    }
+                    sent += k;
+                }
+            }
+        });
+    }
+    for (unsigned c = 0; c < kConsumers; ++c) {
+        sums[c].store(0.0);
+        threads.emplace_back([&, c] {
+            std::vector<Meter> buf(24);
+            double sum = 0.0;
+            while (received.load() < kProducers * kPerProducer) {
+                const std::size_t n = ring.pop(span<Meter>(buf));
+                if (n == 0) {
+                    std::this_thread::yield();
+                }
+                for (std::size_t i = 0; i < n; ++i) {
+                    sum += buf[i].value();
+                }
+                received += n;
+            }
+            sums[c].store(sum);
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    const double n = static_cast<double>(kProducers * kPerProducer);
+    EXPECT_EQ(received.load(), kProducers * kPerProducer);
+    EXPECT_EQ(sums[0].load() + sums[1].load(), n * (n - 1) / 2);
+    Meter m;
+    EXPECT_FALSE(ring.try_pop(m));
+}
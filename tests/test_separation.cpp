@@ -0,0 +1,94 @@
+#include "fixtures.hpp"
+#include "qtty/separation.hpp"
+
+#include <vector>
+
+namespace {
+
+// Extended-precision Vincenty reference in degrees
+long double reference_separation_deg(double ra1, double dec1, double ra2, double dec2) {
+    const long double d2r = 3.141592653589793238462643383279502884L / 180.0L;
+    const long double p1 = dec1 * d2r, p2 = dec2 * d2r, dl = (static_cast<long double>(ra2) - ra1) * d2r;
+    const long double x = std::cos(p2) * std::sin(dl);
+    const long double y = std::cos(p1) * std::sin(p2) - std::sin(p1) * std::cos(p2) * std::cos(dl);
+    const long double z = std::sin(p1) * std::sin(p2) + std::cos(p1) * std::cos(p2) * std::cos(dl);
+    return std::atan2(std::sqrt(x * x + y * y), z) / d2r;
+}
+
+} // namespace
+
+TEST_F(SeparationTest, KnownSeparations) {
+    EXPECT_NEAR(separation(Degree(0.0), Degree(0.0), Degree(90.0), Degree(0.0)).value(),
+                M_PI / 2.0, 1e-15);
+    EXPECT_NEAR(separation(Degree(10.0), Degree(0.0), Degree(10.0), Degree(90.0)).value(),
+                M_PI / 2.0, 1e-15);
+    EXPECT_NEAR(separation(Degree(0.0), Degree(30.0), Degree(180.0), Degree(-30.0)).value(),
+                M_PI, 1e-15);
+    EXPECT_EQ(separation(Degree(12.5), Degree(-7.25), Degree(12.5), Degree(-7.25)).value(), 0.0);
+
+    // Mixed input units: 1 hour of RA on the equator is 15 degrees
+    EXPECT_NEAR(separation(HourAngle(0.0), HourAngle(0.0), Degree(15.0), Degree(0.0)).value(),
+                15.0 * M_PI / 180.0, 1e-15);
+}
+
+TEST_F(SeparationTest, MilliArcsecondPrecision) {
+    const double dec = 45.0;
+    const double ra = 120.0;
+    const double step_deg = 1.0 / 3.6e6;  // 1 mas
+    for (SeparationMethod method : {SeparationMethod::Vincenty, SeparationMethod::Haversine}) {
+        for (int k = 1; k <= 5; ++k) {
+            const double dra = k * step_deg;
+            const long double ref_mas =
+                reference_separation_deg(ra, dec, ra + dra, dec - dra) * 3.6e6L;
+            std::vector<Degree> ra2 = {Degree(ra + dra)};
+            std::vector<Degree> dec2 = {Degree(dec - dra)};
+            std::vector<MilliArcsecond> out(1);
+            SeparationOptions opts;
+            opts.method = method;
+            opts.accuracy = Accuracy::Fast;
+            batch::separation(Degree(ra), Degree(dec), ra2.data(), dec2.data(), out.data(), 1, opts);
+            EXPECT_NEAR(out[0].value(), static_cast<double>(ref_mas), 1e-6);
+        }
+    }
+}
+
+TEST_F(SeparationTest, BatchModesAgree) {
+    const std::size_t n = 70000;
+    std::vector<Degree> ra1(n), dec1(n), ra2(n), dec2(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const double t = static_cast<double>(i);
+        ra1[i] = Degree(std::fmod(t * 0.37, 360.0));
+        dec1[i] = Degree(80.0 * std::sin(t * 0.01));
+        ra2[i] = Degree(std::fmod(t * 1.91 + 3.0, 360.0));
+        dec2[i] = Degree(-85.0 * std::cos(t * 0.013));
+    }
+
+    std::vector<Radian> single_thread(n), multi_thread(n);
+    SeparationOptions opts;
+    opts.threads = 1;
+    batch::separation(ra1.data(), dec1.data(), ra2.data(), dec2.data(), single_thread.data(), n, opts);
+    opts.threads = 4;
+    batch::separation(ra1.data(), dec1.data(), ra2.data(), dec2.data(), multi_thread.data(), n, opts);
+
+    std::vector<Arcsecond> fast(n);
+    opts.accuracy = Accuracy::Fast;
+    batch::separation(ra1.data(), dec1.data(), ra2.data(), dec2.data(), fast.data(), n, opts);
+
+    for (std::size_t i = 0; i < n; i += 97) {
+        const double ref = static_cast<double>(reference_separation_deg(
+            ra1[i].value(), dec1[i].value(), ra2[i].value(), dec2[i].value()));
+        EXPECT_EQ(single_thread[i], multi_thread[i]);
+        EXPECT_NEAR(single_thread[i].value(), ref * M_PI / 180.0, 1e-15);
+        EXPECT_NEAR(fast[i].value(), ref * 3600.0, 1e-9);
+    }
+
+    // One-to-many equals pairwise with a repeated first point
+    std::vector<Degree> ra0(n, ra1[0]), dec0(n, dec1[0]);
+    std::vector<Radian> pairwise(n), one_to_many(n);
+    opts = SeparationOptions();
+    batch::separation(ra0.data(), dec0.data(), ra2.data(), dec2.data(), pairwise.data(), n, opts);
+    batch::separation(ra1[0], dec1[0], ra2.data(), dec2.data(), one_to_many.data(), n, opts);
+    for (std::size_t i = 0; i < n; i += 101) {
+        EXPECT_EQ(pairwise[i], one_to_many[i]);
+    }
+}
@@ -0,0 +1,138 @@
+#include "fixtures.hpp"
+#include "qtty/shm_channel.hpp"
+
+#if QTTY_HAS_SHM
+
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+std::string channel_name(const char* what) {
+    return "/qtty_test_" + std::string(what) + "_" + std::to_string(::getpid());
+}
+
+} // namespace
+
+TEST_F(ShmChannelTest, CreateAttachAndValidate) {
+    const std::string name = channel_name("validate");
+    auto tx = ShmChannel<Meter>::create(name, 100);
+    EXPECT_EQ(tx.capacity(), 128u);
+    EXPECT_THROW(ShmChannel<Meter>::create(name, 8), std::system_error);  // name taken
+
+    auto rx = ShmChannel<Meter>::attach(name);
+    EXPECT_EQ(rx.capacity(), 128u);
+    EXPECT_THROW(ShmChannel<Kilometer>::attach(name), InvalidUnitError);  // same dimension, other unit
+    EXPECT_THROW(ShmChannel<Second>::attach(name), InvalidUnitError);
+    EXPECT_THROW(ShmChannel<Meter>::attach(channel_name("missing")), std::system_error);
+
+    // In-place write and read within one process
+    span<Meter> slot = tx.prepare(3);
+    ASSERT_EQ(slot.size(), 3u);
+    slot[0] = Meter(1.0);
+    slot[1] = Meter(2.0);
+    slot[2] = Meter(3.0);
+    tx.commit(3);
+    span<const Meter> got = rx.peek(10);
+    ASSERT_EQ(got.size(), 3u);
+    EXPECT_EQ(got[2].value(), 3.0);
+    rx.release(3);
+    EXPECT_EQ(rx.size_approx(), 0u);
+}
+
+TEST_F(ShmChannelTest, WrapsAndReportsFull) {
+    const std::string name = channel_name("wrap");
+    auto tx = ShmChannel<Second>::create(name, 8);
+    auto rx = ShmChannel<Second>::attach(name);
+    std::vector<Second> in(6, Second(1.0)), out(8);
+    for (int round = 0; round < 4; ++round) {
+        ASSERT_EQ(tx.write(span<const Second>(in)), 6u);
+        EXPECT_EQ(tx.write(span<const Second>(in)), 2u);  // full after 8
+        ASSERT_EQ(rx.read(span<Second>(out)), 8u);
+    }
+    EXPECT_EQ(rx.read(span<Second>(out)), 0u);
+}
+
+TEST_F(ShmChannelTest, TransfersBetweenProcesses) {
+    const std::string name = channel_name("fork");
+    constexpr std::size_t kTotal = 100000;
+    auto rx = ShmChannel<Meter>::create(name, 1024);
+
+    const pid_t pid = ::fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        // Child: attach by name and produce; report through the exit status
+        int status = 0;
+        try {
+            auto tx = ShmChannel<Meter>::attach(name);
+            std::size_t next = 0;
+            while (next < kTotal) {
+                span<Meter> slot = tx.prepare(kTotal - next);
+                for (std::size_t i = 0; i < slot.size(); ++i) {
+                    slot[i] = Meter(static_cast<double>(next + i));
+                }
+                tx.commit(slot.size());
+                next += slot.size();
+                if (slot.empty()) {
+                    std::this_thread::yield();
+                }
+            }
+        } catch (...) {
+            status = 1;
+        }
+        ::_exit(status);
+    }
+
+    std::size_t expected = 0;
+    bool in_order = true;
+    bool exited = false;
+    int status = 0;
+    while (expected < kTotal) {
+        span<const Meter> got = rx.peek(4096);
+        for (const Meter& m : got) {
+            in_order &= m.value() == static_cast<double>(expected++);
+        }
+        rx.release(got.size());
+        if (got.empty()) {
+            // A child that died early would otherwise leave us spinning
+            if (exited) {
+                break;
+            }
+            exited = ::waitpid(pid, &status, WNOHANG) == pid;
+            std::this_thread::yield();
+        }
+    }
+    if (!exited) {
+        ASSERT_EQ(::waitpid(pid, &status, 0), pid);
+    }
+    EXPECT_EQ(expected, kTotal);
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+    EXPECT_TRUE(in_order);
+}
+
+TEST_F(ShmChannelTest, RejectsOverflowingCapacity) {
+    const std::string name = channel_name("overflow");
+    auto tx = ShmChannel<Meter>::create(name, 8);
+
+    // Corrupt the header so that capacity * sizeof(Meter) wraps to zero
+    const std::string object = detail::shm_object_name(name);
+    const int fd = ::shm_open(object.c_str(), O_RDWR, 0);
+    ASSERT_GE(fd, 0);
+    void* p = ::mmap(nullptr, sizeof(detail::ShmHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    ASSERT_NE(p, MAP_FAILED);
+    static_cast<detail::ShmHeader*>(p)->capacity = std::uint64_t{1} << 61;
+    EXPECT_THROW(ShmChannel<Meter>::attach(name), std::invalid_argument);
+    ::munmap(p, sizeof(detail::ShmHeader));
+}
+
+#endif // QTTY_HAS_SHM
@@ -0,0 +1,120 @@
+#include "fixtures.hpp"
+#include "qtty/sketch.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+
+std::vector<Millisecond> latencies(std::size_t n, unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::lognormal_distribution<double> d(3.0, 0.8);
+    std::vector<Millisecond> v(n);
+    for (auto& x : v) {
+        x = Millisecond(d(rng));
+    }
+    return v;
+}
+
+// Normalized rank of the sketch's answer in the exact sorted data
+double true_rank(const std::vector<double>& sorted, double value) {
+    return static_cast<double>(std::upper_bound(sorted.begin(), sorted.end(), value) -
+                               sorted.begin()) / static_cast<double>(sorted.size());
+}
+
+} // namespace
+
+TEST_F(KllSketchTest, QuantilesWithinRankError) {
+    const std::vector<Millisecond> v = latencies(200000, 1);
+    KllSketch<Millisecond> sketch;
+    sketch.push(v.data(), v.size());
+    EXPECT_EQ(sketch.count(), v.size());
+    EXPECT_LT(sketch.retained(), 1000u);
+
+    std::vector<double> sorted;
+    for (const auto& x : v) {
+        sorted.push_back(x.value());
+    }
+    std::sort(sorted.begin(), sorted.end());
+    EXPECT_EQ(sketch.min().value(), sorted.front());
+    EXPECT_EQ(sketch.max().value(), sorted.back());
+    EXPECT_EQ(sketch.quantile(0.0).value(), sorted.front());
+    EXPECT_EQ(sketch.quantile(1.0).value(), sorted.back());
+
+    for (double q : {0.01, 0.1, 0.25, 0.5, 0.9, 0.99}) {
+        EXPECT_NEAR(true_rank(sorted, sketch.quantile(q).value()), q, 0.02) << q;
+    }
+    EXPECT_NEAR(sketch.rank(Millisecond(sorted[sorted.size() / 2])), 0.5, 0.02);
+    EXPECT_NEAR(sketch.rank(Second(sorted[sorted.size() / 2] / 1000.0)), 0.5, 0.02);
+}
+
+TEST_F(KllSketchTest, MergeAndUnitRescale) {
+    const std::vector<Millisecond> v = latencies(120000, 2);
+    KllSketch<Millisecond> whole, parts;
+    whole.push(v.data(), v.size());
+    for (std::size_t off = 0; off < v.size(); off += 30000) {
+        KllSketch<Millisecond> part;
+        part.push(v.data() + off, 30000);
+        parts.merge(part);
+    }
+    EXPECT_EQ(parts.count(), v.size());
+    EXPECT_EQ(parts.min(), whole.min());
+    EXPECT_EQ(parts.max(), whole.max());
+    const double qs[] = {0.1, 0.5, 0.9};
+    Millisecond a[3], b[3];
+    whole.quantiles(qs, a, 3);
+    parts.quantiles(qs, b, 3);
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_NEAR(whole.rank(b[i]), qs[i], 0.02);
+    }
+
+    EXPECT_DOUBLE_EQ(whole.quantile_in<SecondTag>(0.5).value(), whole.quantile(0.5).value() / 1000.0);
+    EXPECT_THROW(whole.merge(KllSketch<Millisecond>(100)), std::invalid_argument);
+}
+
+TEST_F(KllSketchTest, SerializationRoundTrip) {
+    const std::vector<Millisecond> v = latencies(50000, 3);
+    KllSketch<Millisecond> sketch(128);
+    sketch.push(v.data(), v.size());
+    const std::vector<std::uint8_t> bytes = sketch.serialize();
+    EXPECT_EQ(bytes[0], 'Q');
+    EXPECT_LT(bytes.size(), 40 + 12 * sketch.retained());
+
+    const KllSketch<Millisecond> back = KllSketch<Millisecond>::deserialize(bytes.data(), bytes.size());
+    EXPECT_EQ(back.k(), 128);
+    EXPECT_EQ(back.count(), sketch.count());
+    EXPECT_EQ(back.retained(), sketch.retained());
+    EXPECT_EQ(back.quantile(0.37), sketch.quantile(0.37));
+
+    // Loading into another unit of the same dimension rescales
+    const KllSketch<Second> secs = KllSketch<Second>::deserialize(bytes.data(), bytes.size());
+    EXPECT_DOUBLE_EQ(secs.quantile(0.37).value(), sketch.quantile(0.37).value() / 1000.0);
+    EXPECT_THROW(KllSketch<Meter>::deserialize(bytes.data(), bytes.size()),
+                 IncompatibleDimensionsError);
+
+    std::vector<std::uint8_t> bad = bytes;
+    bad[0] = 'X';
+    EXPECT_THROW(KllSketch<Millisecond>::deserialize(bad.data(), bad.size()), std::invalid_argument);
+    EXPECT_THROW(KllSketch<Millisecond>::deserialize(bytes.data(), bytes.size() - 3),
+                 std::invalid_argument);
+
+    KllSketch<Millisecond> empty;
+    const auto eb = empty.serialize();
+    EXPECT_TRUE(KllSketch<Millisecond>::deserialize(eb.data(), eb.size()).empty());
+
+    // Two items at level 63 weigh 2^64, which wraps to the claimed n = 0
+    std::vector<std::uint8_t> wrap(eb.begin(), eb.begin() + 11);  // magic, version, unit, k
+    detail::put_u8(wrap, 64);
+    detail::put_u64(wrap, 0);
+    detail::put_f64(wrap, 1.0);
+    detail::put_f64(wrap, 2.0);
+    for (int h = 0; h < 63; ++h) {
+        detail::put_u32(wrap, 0);
+    }
+    detail::put_u32(wrap, 2);
+    detail::put_f64(wrap, 1.0);
+    detail::put_f64(wrap, 2.0);
+    EXPECT_THROW(KllSketch<Millisecond>::deserialize(wrap.data(), wrap.size()), std::invalid_argument);
+    EXPECT_TRUE(std::isnan(empty.quantile(0.5).value()));
+}
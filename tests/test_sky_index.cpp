@@ -0,0 +1,154 @@
+#include "fixtures.hpp"
+#include "qtty/sky_index.hpp"
+#include "qtty/separation.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+struct Catalog {
+    std::vector<Degree> ra;
+    std::vector<Degree> dec;
+};
+
+// Uniform on the sphere, plus a dense clump and points at both poles
+Catalog make_catalog(std::size_t n, unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    Catalog c;
+    for (std::size_t i = 0; i < n; ++i) {
+        c.ra.push_back(Degree(360.0 * u(rng)));
+        c.dec.push_back(Degree(std::asin(2.0 * u(rng) - 1.0) * 180.0 / M_PI));
+    }
+    for (int i = 0; i < 200; ++i) {
+        c.ra.push_back(Degree(150.0 + 1e-4 * u(rng)));
+        c.dec.push_back(Degree(2.0 + 1e-4 * u(rng)));
+    }
+    c.ra.push_back(Degree(0.0));
+    c.dec.push_back(Degree(90.0));
+    c.ra.push_back(Degree(359.999999));
+    c.dec.push_back(Degree(-90.0));
+    return c;
+}
+
+std::vector<std::uint32_t> brute_cone(const Catalog& c, Degree ra0, Degree dec0, Radian r) {
+    std::vector<Radian> d(c.ra.size());
+    batch::separation(ra0, dec0, c.ra.data(), c.dec.data(), d.data(), d.size());
+    std::vector<std::uint32_t> rows;
+    for (std::size_t i = 0; i < d.size(); ++i) {
+        if (d[i].value() <= r.value()) {
+            rows.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+    return rows;
+}
+
+} // namespace
+
+TEST_F(SkyIndexTest, HealpixRoundTrip) {
+    for (int order : {0, 1, 3, 8}) {
+        const std::uint64_t npix = 12ull << (2 * order);
+        const std::uint64_t step = std::max<std::uint64_t>(1, npix / 5000);
+        for (std::uint64_t pix = 0; pix < npix; pix += step) {
+            double v[3];
+            detail::healpix::pix2vec_nest(order, pix, v);
+            const double sth = std::sqrt(v[0] * v[0] + v[1] * v[1]);
+            double phi = std::atan2(v[1], v[0]);
+            phi = phi < 0.0 ? phi + 2.0 * M_PI : phi;
+            EXPECT_EQ(detail::healpix::ang2pix_nest(order, v[2], sth, phi), pix);
+        }
+    }
+}
+
+TEST_F(SkyIndexTest, PixelRadiusBoundsMembers) {
+    std::mt19937_64 rng(3);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    for (int order : {0, 2, 6}) {
+        const double bound = detail::healpix::max_pixrad(order);
+        for (int i = 0; i < 20000; ++i) {
+            const double z = 2.0 * u(rng) - 1.0;
+            const double phi = 2.0 * M_PI * u(rng);
+            const double sth = std::sqrt((1.0 - z) * (1.0 + z));
+            const double p[3] = {sth * std::cos(phi), sth * std::sin(phi), z};
+            double c[3];
+            detail::healpix::pix2vec_nest(order, detail::healpix::ang2pix_nest(order, z, sth, phi), c);
+            const double dot = p[0] * c[0] + p[1] * c[1] + p[2] * c[2];
+            EXPECT_LE(std::acos(std::min(1.0, dot)), bound);
+        }
+    }
+}
+
+TEST_F(SkyIndexTest, ConeSearchMatchesBruteForce) {
+    const Catalog c = make_catalog(60000, 11);
+    SkyIndexOptions opts;
+    opts.threads = 4;
+    const SkyIndex index = SkyIndex::build(c.ra.data(), c.dec.data(), c.ra.size(), opts);
+    EXPECT_EQ(index.size(), c.ra.size());
+
+    const double centers[][2] = {{150.0, 2.0}, {10.0, 89.9}, {200.0, -89.5}, {359.9, 0.0}, {45.0, -30.0}};
+    const double radii_deg[] = {1e-5, 0.05, 1.0, 12.0, 117.0};
+    for (const auto& ctr : centers) {
+        for (double r : radii_deg) {
+            std::vector<std::uint32_t> got =
+                index.cone_search(Degree(ctr[0]), Degree(ctr[1]), Degree(r));
+            std::sort(got.begin(), got.end());
+            EXPECT_EQ(got, brute_cone(c, Degree(ctr[0]), Degree(ctr[1]),
+                                      Radian(r * M_PI / 180.0)))
+                << ctr[0] << "," << ctr[1] << " r=" << r;
+        }
+    }
+}
+
+TEST_F(SkyIndexTest, RadiusInAnyAngularUnit) {
+    const Catalog c = make_catalog(5000, 5);
+    const SkyIndex index = SkyIndex::build(c.ra.data(), c.dec.data(), c.ra.size());
+    auto a = index.cone_search(Degree(150.0), Degree(2.0), Arcsecond(0.5));
+    auto b = index.cone_search(Degree(150.0), Degree(2.0), Degree(0.5 / 3600.0));
+    std::sort(a.begin(), a.end());
+    std::sort(b.begin(), b.end());
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(a, brute_cone(c, Degree(150.0), Degree(2.0), Radian(0.5 / 3600.0 * M_PI / 180.0)));
+}
+
+TEST_F(SkyIndexTest, NearestMatchesBruteForce) {
+    const Catalog c = make_catalog(20000, 7);
+    const SkyIndex index = SkyIndex::build(c.ra.data(), c.dec.data(), c.ra.size());
+    std::mt19937_64 rng(9);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    std::vector<Radian> d(c.ra.size());
+    for (int q = 0; q < 50; ++q) {
+        const Degree ra0(360.0 * u(rng));
+        const Degree dec0(std::asin(2.0 * u(rng) - 1.0) * 180.0 / M_PI);
+        const SkyIndex::Match m = index.nearest(ra0, dec0);
+        batch::separation(ra0, dec0, c.ra.data(), c.dec.data(), d.data(), d.size());
+        const auto best = std::min_element(d.begin(), d.end(),
+                                           [](Radian x, Radian y) { return x.value() < y.value(); });
+        EXPECT_NEAR(m.separation.value(), best->value(), 1e-12);
+        EXPECT_NEAR(d[m.index].value(), best->value(), 1e-12);
+    }
+
+    const SkyIndex single = SkyIndex::build(c.ra.data(), c.dec.data(), 1);
+    EXPECT_EQ(single.nearest(Degree(180.0), Degree(0.0)).index, 0u);
+    EXPECT_THROW(SkyIndex().nearest(Degree(0.0), Degree(0.0)), std::out_of_range);
+}
+
+TEST_F(SkyIndexTest, NonFinitePositions) {
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double inf = std::numeric_limits<double>::infinity();
+    std::vector<Degree> ra = {Degree(10.0), Degree(nan), Degree(30.0)};
+    std::vector<Degree> dec = {Degree(0.0), Degree(5.0), Degree(inf)};
+    EXPECT_THROW(SkyIndex::build(ra.data(), dec.data(), 2), std::invalid_argument);
+    ra[1] = Degree(20.0);
+    EXPECT_THROW(SkyIndex::build(ra.data(), dec.data(), 3), std::invalid_argument);
+
+    const SkyIndex index = SkyIndex::build(ra.data(), dec.data(), 2);
+    EXPECT_EQ(index.cone_search(Degree(10.0), Degree(0.0), Degree(1.0)).size(), 1u);
+    EXPECT_TRUE(index.cone_search(Degree(nan), Degree(0.0), Degree(180.0)).empty());
+    EXPECT_TRUE(index.cone_search(Degree(10.0), Degree(-inf), Degree(180.0)).empty());
+    EXPECT_TRUE(index.cone_search(Degree(10.0), Degree(0.0), Degree(nan)).empty());
+    EXPECT_THROW(index.nearest(Degree(inf), Degree(0.0)), std::invalid_argument);
+}
@@ -0,0 +1,139 @@
+#include "fixtures.hpp"
+#include "qtty/sort.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+
+std::vector<Meter> random_meters(std::size_t n, unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> mant(-1.0, 1.0);
+    std::uniform_int_distribution<int> expo(-300, 300);
+    std::vector<Meter> v(n);
+    for (auto& x : v) {
+        x = Meter(std::ldexp(mant(rng), expo(rng)));
+    }
+    return v;
+}
+
+std::vector<double> sorted_reference(const std::vector<Meter>& v) {
+    std::vector<double> r(v.size());
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        r[i] = v[i].value();
+    }
+    std::sort(r.begin(), r.end());
+    return r;
+}
+
+void expect_sorted_as(const std::vector<Meter>& v, const std::vector<double>& ref) {
+    ASSERT_EQ(v.size(), ref.size());
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        ASSERT_EQ(v[i].value(), ref[i]) << i;
+    }
+}
+
+} // namespace
+
+TEST_F(SortTest, SmallAndSpecialValues) {
+    std::vector<Meter> v = {Meter(3.0), Meter(-0.0), Meter(-2.5), Meter(0.0),
+                            Meter(std::numeric_limits<double>::infinity()),
+                            Meter(-std::numeric_limits<double>::infinity()), Meter(1e-310)};
+    radix_sort(v.data(), v.size());
+    EXPECT_EQ(v[0].value(), -std::numeric_limits<double>::infinity());
+    EXPECT_EQ(v[1].value(), -2.5);
+    EXPECT_TRUE(std::signbit(v[2].value()));  // -0 before +0
+    EXPECT_FALSE(std::signbit(v[3].value()));
+    EXPECT_EQ(v[4].value(), 1e-310);
+    EXPECT_EQ(v[5].value(), 3.0);
+    EXPECT_EQ(v[6].value(), std::numeric_limits<double>::infinity());
+
+    radix_sort(v.data(), 0);
+}
+
+TEST_F(SortTest, MatchesStdSort) {
+    for (std::size_t n : {257u, 5000u, 100003u}) {
+        auto v = random_meters(n, static_cast<unsigned>(n));
+        const auto ref = sorted_reference(v);
+        radix_sort(v.data(), v.size());
+        expect_sorted_as(v, ref);
+    }
+}
+
+TEST_F(SortTest, NarrowRangeSkipsPasses) {
+    // Small integers share the high digits; the skipped passes must not
+    // disturb the result
+    std::mt19937_64 rng(1);
+    std::uniform_int_distribution<int> d(0, 1000);
+    std::vector<Second> v(20000);
+    for (auto& x : v) {
+        x = Second(d(rng));
+    }
+    std::vector<double> ref(v.size());
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        ref[i] = v[i].value();
+    }
+    std::sort(ref.begin(), ref.end());
+    radix_sort(v.data(), v.size());
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        ASSERT_EQ(v[i].value(), ref[i]);
+    }
+}
+
+TEST_F(SortTest, ParallelMatchesSerial) {
+    auto a = random_meters(300000, 17);
+    auto b = a;
+    radix_sort(a.data(), a.size());
+    for (unsigned threads : {2u, 3u, 8u}) {
+        auto c = b;
+        parallel_radix_sort(c.data(), c.size(), threads);
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            ASSERT_EQ(std::memcmp(&a[i], &c[i], sizeof(double)), 0) << i;
+        }
+    }
+}
+
+TEST_F(SortTest, SearchWithProbeInOtherUnit) {
+    std::vector<Meter> v;
+    for (int i = 0; i < 100; ++i) {
+        v.push_back(Meter(10.0 * i));
+        if (i == 50) {
+            v.push_back(Meter(500.0));
+            v.push_back(Meter(500.0));
+        }
+    }
+    EXPECT_EQ(lower_bound(v.data(), v.size(), Meter(-1.0)), 0u);
+    EXPECT_EQ(lower_bound(v.data(), v.size(), Meter(5.0)), 1u);
+    EXPECT_EQ(lower_bound(v.data(), v.size(), Kilometer(0.5)), 50u);
+    EXPECT_EQ(upper_bound(v.data(), v.size(), Kilometer(0.5)), 53u);
+    EXPECT_EQ(lower_bound(v.data(), v.size(), Kilometer(5.0)), v.size());
+
+    auto r = equal_range(v.data(), v.size(), Kilometer(0.5));
+    EXPECT_EQ(r.first, 50u);
+    EXPECT_EQ(r.second, 53u);
+    r = equal_range(v.data(), v.size(), Meter(505.0));
+    EXPECT_EQ(r.first, r.second);
+
+    EXPECT_EQ(lower_bound(v.data(), 0, Meter(1.0)), 0u);
+}
+
+TEST_F(SortTest, SearchMatchesStd) {
+    auto v = random_meters(10000, 23);
+    radix_sort(v.data(), v.size());
+    const auto ref = sorted_reference(v);
+    auto probes = random_meters(500, 29);
+    std::vector<std::size_t> idx(probes.size());
+    batch::lower_bound(v.data(), v.size(), probes.data(), idx.data(), probes.size());
+    for (std::size_t j = 0; j < probes.size(); ++j) {
+        const double p = probes[j].value();
+        const auto expected = static_cast<std::size_t>(
+            std::lower_bound(ref.begin(), ref.end(), p) - ref.begin());
+        EXPECT_EQ(idx[j], expected);
+        EXPECT_EQ(upper_bound(v.data(), v.size(), probes[j]),
+                  static_cast<std::size_t>(std::upper_bound(ref.begin(), ref.end(), p) - ref.begin()));
+    }
+}
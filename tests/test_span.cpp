@@ -0,0 +1,107 @@
+#include "fixtures.hpp"
+#include "qtty/span.hpp"
+
+#include <array>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+static_assert(std::is_standard_layout<Meter>::value, "Quantity is standard-layout");
+static_assert(std::is_trivially_copyable<Meter>::value, "Quantity is trivially copyable");
+static_assert(sizeof(Meter) == sizeof(double), "Quantity is one double");
+
+namespace {
+
+template<typename Buffer, typename = void>
+struct viewable : std::false_type {};
+
+template<typename Buffer>
+struct viewable<Buffer, decltype(void(as_quantities<MeterTag>(std::declval<Buffer>())))>
+    : std::true_type {};
+
+template<typename Buffer, typename = void>
+struct viewable_raw : std::false_type {};
+
+template<typename Buffer>
+struct viewable_raw<Buffer, decltype(void(as_doubles(std::declval<Buffer>())))> : std::true_type {};
+
+} // namespace
+
+// Views of temporaries would dangle, so only lvalue buffers are accepted
+static_assert(viewable<std::vector<double>&>::value, "");
+static_assert(viewable<const std::vector<double>&>::value, "");
+static_assert(!viewable<std::vector<double>>::value, "");
+static_assert(!viewable<const std::vector<double>>::value, "");
+static_assert(viewable_raw<std::vector<Meter>&>::value, "");
+static_assert(!viewable_raw<std::vector<Meter>>::value, "");
+// Spans borrow, so temporary spans are accepted
+static_assert(viewable<span<double>>::value, "");
+static_assert(viewable<span<const double>>::value, "");
+static_assert(viewable_raw<span<Meter>>::value, "");
+static_assert(viewable_raw<span<const Meter>>::value, "");
+
+TEST_F(SpanTest, DoublesAsQuantitiesWithoutCopy) {
+    std::vector<double> buf = {1.0, 2.5, -4.0};
+    span<Meter> m = as_quantities<MeterTag>(buf);
+    ASSERT_EQ(m.size(), 3u);
+    EXPECT_EQ(static_cast<const void*>(m.data()), static_cast<const void*>(buf.data()));
+    EXPECT_EQ(m[1].value(), 2.5);
+
+    // Writes go straight through to the buffer
+    m[2] = Meter(7.0);
+    EXPECT_EQ(buf[2], 7.0);
+
+    double total = 0.0;
+    for (const Meter& x : m) {
+        total += x.value();
+    }
+    EXPECT_EQ(total, 10.5);
+}
+
+TEST_F(SpanTest, ConstnessIsPreserved) {
+    const std::vector<double> buf = {3.0, 4.0};
+    auto q = as_quantities<SecondTag>(buf);
+    static_assert(std::is_same<decltype(q), span<const Second>>::value, "const in, const out");
+    EXPECT_EQ(q.back().value(), 4.0);
+
+    const double raw[] = {1.0, 2.0, 3.0, 4.0};
+    auto p = as_quantities<SecondTag>(raw + 1, 2);
+    static_assert(std::is_same<decltype(p), span<const Second>>::value, "pointer overload");
+    EXPECT_EQ(p.front().value(), 2.0);
+}
+
+TEST_F(SpanTest, QuantitiesAsDoubles) {
+    std::vector<Watt> w = {Watt(1.0), Watt(2.0), Watt(3.0)};
+    span<double> d = as_doubles(w);
+    ASSERT_EQ(d.size(), 3u);
+    d[0] = 10.0;
+    EXPECT_EQ(w[0].value(), 10.0);
+
+    const std::array<Watt, 2> cw = {Watt(5.0), Watt(6.0)};
+    auto cd = as_doubles(cw);
+    static_assert(std::is_same<decltype(cd), span<const double>>::value, "const in, const out");
+    EXPECT_EQ(cd[1], 6.0);
+
+    // Round trip through both views
+    auto back = as_quantities<WattTag>(d);
+    EXPECT_EQ(back.subspan(1)[0].value(), 2.0);
+    EXPECT_EQ(back.first(1).size(), 1u);
+    EXPECT_EQ(back.last(2)[1].value(), 3.0);
+    EXPECT_EQ(back.size_bytes(), 3 * sizeof(double));
+}
+
+TEST_F(SpanTest, TemporarySpansAndChaining) {
+    std::vector<double> v = {1.0, 2.0, 3.0};
+    span<Meter> m = as_quantities<MeterTag>(span<double>(v));
+    EXPECT_EQ(m[2].value(), 3.0);
+
+    span<double> raw = as_doubles(as_quantities<MeterTag>(v));
+    EXPECT_EQ(raw.data(), v.data());
+    EXPECT_EQ(raw.size(), 3u);
+
+    const std::vector<double>& cv = v;
+    span<const Meter> cm = as_quantities<MeterTag>(span<const double>(cv));
+    span<const double> craw = as_doubles(as_quantities<MeterTag>(cv));
+    EXPECT_EQ(cm.data()[1].value(), 2.0);
+    EXPECT_EQ(craw[0], 1.0);
+}
@@ -0,0 +1,137 @@
+#include "fixtures.hpp"
+#include "qtty/stats.hpp"
+
+#include <random>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+std::vector<Millisecond> samples(std::size_t n, unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<double> d(250.0, 40.0);
+    std::vector<Millisecond> v(n);
+    for (auto& x : v) {
+        x = Millisecond(d(rng));
+    }
+    return v;
+}
+
+// Two-pass reference in long double
+void reference(const std::vector<Millisecond>& v, long double& mean, long double& var) {
+    long double s = 0.0L;
+    for (const auto& x : v) {
+        s += x.value();
+    }
+    mean = s / v.size();
+    long double m2 = 0.0L;
+    for (const auto& x : v) {
+        m2 += (x.value() - mean) * (x.value() - mean);
+    }
+    var = m2 / v.size();
+}
+
+} // namespace
+
+TEST_F(RunningStatsTest, TypedResults) {
+    RunningStats<Meter> s;
+    static_assert(std::is_same<decltype(s.mean()), Meter>::value, "mean keeps the unit");
+    static_assert(std::is_same<decltype(s.variance()), Squared<Meter>>::value,
+                  "variance is squared");
+    EXPECT_EQ(s.count(), 0u);
+    EXPECT_TRUE(std::isnan(s.mean().value()));
+    EXPECT_TRUE(std::isnan(s.min().value()));
+
+    for (double x : {2.0, 4.0, 4.0, 4.0, 5.0, 5.0, 7.0, 9.0}) {
+        s.push(Meter(x));
+    }
+    EXPECT_EQ(s.count(), 8u);
+    EXPECT_DOUBLE_EQ(s.mean().value(), 5.0);
+    EXPECT_DOUBLE_EQ(s.variance().value(), 4.0);
+    EXPECT_DOUBLE_EQ(s.stddev().value(), 2.0);
+    EXPECT_DOUBLE_EQ(s.sample_variance().value(), 32.0 / 7.0);
+    EXPECT_EQ(s.min().value(), 2.0);
+    EXPECT_EQ(s.max().value(), 9.0);
+    EXPECT_EQ(s.sum().value(), 40.0);
+}
+
+TEST_F(RunningStatsTest, ArrayPushMatchesScalarPush) {
+    const std::vector<Millisecond> v = samples(10007, 1);
+    RunningStats<Millisecond> one, bulk;
+    for (const auto& x : v) {
+        one.push(x);
+    }
+    bulk.push(v.data(), v.size());
+    long double mean, var;
+    reference(v, mean, var);
+    EXPECT_EQ(bulk.count(), one.count());
+    EXPECT_NEAR(bulk.mean().value(), static_cast<double>(mean), 1e-12);
+    EXPECT_NEAR(one.mean().value(), static_cast<double>(mean), 1e-12);
+    EXPECT_NEAR(bulk.variance().value() / static_cast<double>(var), 1.0, 1e-13);
+    EXPECT_NEAR(one.variance().value() / static_cast<double>(var), 1.0, 1e-13);
+    EXPECT_EQ(bulk.min(), one.min());
+    EXPECT_EQ(bulk.max(), one.max());
+}
+
+TEST_F(RunningStatsTest, MergeAcrossThreads) {
+    const std::vector<Millisecond> v = samples(200000, 2);
+    long double mean, var;
+    reference(v, mean, var);
+    for (unsigned threads : {1u, 3u, 8u}) {
+        const RunningStats<Millisecond> s = batch::stats(v.data(), v.size(), threads);
+        EXPECT_EQ(s.count(), v.size());
+        EXPECT_NEAR(s.mean().value(), static_cast<double>(mean), 1e-11);
+        EXPECT_NEAR(s.variance().value() / static_cast<double>(var), 1.0, 1e-12);
+    }
+
+    RunningStats<Millisecond> a, b, empty;
+    a.push(v.data(), 1000);
+    b.push(v.data() + 1000, 500);
+    a.merge(empty);
+    empty.merge(b);
+    a.merge(empty);
+    RunningStats<Millisecond> ref;
+    ref.push(v.data(), 1500);
+    EXPECT_EQ(a.count(), 1500u);
+    EXPECT_NEAR(a.mean().value(), ref.mean().value(), 1e-12);
+    EXPECT_NEAR(a.variance().value(), ref.variance().value(), 1e-9);
+}
+
+TEST_F(RunningStatsTest, CompensatedSumAndLargeOffset) {
+    // 1e8 offset with unit spread: naive sum-of-squares variance collapses
+    std::vector<Meter> v;
+    for (int i = 0; i < 100000; ++i) {
+        v.push_back(Meter(1e8 + (i % 2 == 0 ? 1.0 : -1.0)));
+    }
+    v.push_back(Meter(1e-3));
+    RunningStats<Meter> s;
+    s.push(v.data(), v.size());
+    EXPECT_EQ(s.sum().value(), 1e13 + 1e-3);
+    RunningStats<Meter> t;
+    t.push(v.data(), v.size() - 1);
+    EXPECT_NEAR(t.variance().value(), 1.0, 1e-9);
+
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    t.push(Meter(nan));
+    EXPECT_TRUE(std::isnan(t.max().value()));
+
+    // +inf and -inf in one block make the mean NaN, but no input was NaN
+    const double inf = std::numeric_limits<double>::infinity();
+    std::vector<Meter> w(100, Meter(1.0));
+    w[3] = Meter(inf);
+    w[70] = Meter(-inf);
+    RunningStats<Meter> block, scalar;
+    block.push(w.data(), w.size());
+    for (const Meter& m : w) {
+        scalar.push(m);
+    }
+    for (const RunningStats<Meter>* r : {&block, &scalar}) {
+        EXPECT_EQ(r->min().value(), -inf);
+        EXPECT_EQ(r->max().value(), inf);
+    }
+
+    w[50] = Meter(nan);
+    RunningStats<Meter> with_nan;
+    with_nan.push(w.data(), w.size());
+    EXPECT_TRUE(std::isnan(with_nan.min().value()));
+}
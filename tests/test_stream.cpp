@@ -0,0 +1,132 @@
+#include "fixtures.hpp"
+#include "qtty/stream.hpp"
+
+// Coroutine streams need C++20; the CMake build compiles this file into a
+// separate C++20 test binary when the compiler supports it.
+#if QTTY_HAS_COROUTINES
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::vector<Meter> ramp(std::size_t n) {
+    std::vector<Meter> v(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        v[i] = Meter(static_cast<double>(i));
+    }
+    return v;
+}
+
+stream::Generator<stream::Batch<Meter>> counting(std::size_t batches, std::size_t size,
+                                                 std::atomic<std::size_t>* produced) {
+    std::vector<Meter> buf(size);
+    for (std::size_t b = 0; b < batches; ++b) {
+        for (std::size_t i = 0; i < size; ++i) {
+            buf[i] = Meter(static_cast<double>(b * size + i));
+        }
+        ++*produced;
+        co_yield stream::Batch<Meter>(buf.data(), buf.size());
+    }
+}
+
+stream::Generator<stream::Batch<Meter>> failing() {
+    std::vector<Meter> buf = {Meter(1.0)};
+    co_yield stream::Batch<Meter>(buf.data(), buf.size());
+    throw std::runtime_error("source failed");
+}
+
+} // namespace
+
+TEST_F(StreamTest, FromSpanSlicesIntoBatches) {
+    const auto data = ramp(10);
+    std::vector<std::size_t> sizes;
+    double sum = 0.0;
+    for (auto batch : stream::from_span(span<const Meter>(data), 4)) {
+        sizes.push_back(batch.size());
+        for (const Meter& m : batch) {
+            sum += m.value();
+        }
+    }
+    EXPECT_EQ(sizes, (std::vector<std::size_t>{4, 4, 2}));
+    EXPECT_EQ(sum, 45.0);
+    EXPECT_THROW(stream::from_span(span<const Meter>(data), 0).next(), std::invalid_argument);
+}
+
+TEST_F(StreamTest, ConvertAndAggregate) {
+    const auto data = ramp(1000);
+    auto task = stream::aggregate(
+        stream::convert<KilometerTag>(stream::from_span(span<const Meter>(data), 64)));
+    RunningStats<Kilometer> stats = stream::sync_wait(std::move(task));
+    EXPECT_EQ(stats.count(), 1000u);
+    EXPECT_NEAR(stats.mean().value(), 0.4995, 1e-12);
+    EXPECT_NEAR(stats.max().value(), 0.999, 1e-12);
+}
+
+TEST_F(StreamTest, TasksCompose) {
+    const auto data = ramp(100);
+    auto outer = [&]() -> stream::Task<double> {
+        auto stats = co_await stream::aggregate(stream::from_span(span<const Meter>(data), 7));
+        co_return stats.mean().value() * 2.0;
+    };
+    EXPECT_DOUBLE_EQ(stream::sync_wait(outer()), 99.0);
+}
+
+TEST_F(StreamTest, ParseJsonLines) {
+    const std::vector<std::string> lines = {"1.5", "2.5", "3.0"};
+    auto src = stream::from_span(span<const std::string>(lines), 2);
+    std::vector<double> got;
+    for (auto batch : stream::parse<Meter>(std::move(src))) {
+        for (const Meter& m : batch) {
+            got.push_back(m.value());
+        }
+    }
+    EXPECT_EQ(got, (std::vector<double>{1.5, 2.5, 3.0}));
+}
+
+TEST_F(StreamTest, PrefetchPreservesOrderAndBoundsLookahead) {
+    std::atomic<std::size_t> produced{0};
+    auto gen = stream::prefetch(counting(50, 32, &produced), 2);
+    double expected = 0.0;
+    std::size_t consumed = 0;
+    for (auto batch : gen) {
+        ++consumed;
+        for (const Meter& m : batch) {
+            ASSERT_EQ(m.value(), expected);
+            expected += 1.0;
+        }
+        if (consumed == 3) {
+            // Give the producer time to run ahead; the queue stops it
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            // Three consumed, two queued, at most one blocked in push
+            EXPECT_LE(produced.load(), 3u + 2u + 1u);
+        }
+    }
+    EXPECT_EQ(consumed, 50u);
+    EXPECT_EQ(expected, 50.0 * 32.0);
+}
+
+TEST_F(StreamTest, EarlyStopCancelsProducer) {
+    std::atomic<std::size_t> produced{0};
+    {
+        auto gen = stream::prefetch(counting(1000, 8, &produced), 1);
+        ASSERT_TRUE(gen.next());
+        EXPECT_EQ(gen.value().size(), 8u);
+    } // destroying the generator must join the producer thread
+    EXPECT_LT(produced.load(), 1000u);
+}
+
+TEST_F(StreamTest, ExceptionsPropagate) {
+    auto direct = failing();
+    ASSERT_TRUE(direct.next());
+    EXPECT_THROW(direct.next(), std::runtime_error);
+
+    auto task = stream::aggregate(stream::prefetch(failing(), 2));
+    EXPECT_THROW(stream::sync_wait(std::move(task)), std::runtime_error);
+}
+
+#endif // QTTY_HAS_COROUTINES
@@ -0,0 +1,86 @@
+#include "fixtures.hpp"
+#include "qtty/vec3.hpp"
+
+#include <type_traits>
+#include <vector>
+
+TEST_F(Vec3Test, DimensionedProducts) {
+    const Vec3<Meter> a{Meter(1.0), Meter(2.0), Meter(2.0)};
+    const Vec3<Meter> b{Meter(0.0), Meter(1.0), Meter(0.0)};
+
+    static_assert(std::is_same<decltype(dot(a, b)), Squared<Meter>>::value, "dot is m^2");
+    static_assert(std::is_same<decltype(cross(a, b)), Vec3<Squared<Meter>>>::value,
+                  "cross is a vector of m^2");
+    static_assert(std::is_same<decltype(norm(a)), Meter>::value, "norm keeps the unit");
+
+    EXPECT_EQ(dot(a, b).value(), 2.0);
+    EXPECT_EQ(norm(a).value(), 3.0);
+    EXPECT_EQ(norm2(a).value(), 9.0);
+    EXPECT_DOUBLE_EQ(distance(a, b).value(), std::sqrt(6.0));
+
+    const Vec3<Squared<Meter>> c = cross(a, b);
+    EXPECT_EQ(c.x.value(), -2.0);
+    EXPECT_EQ(c.y.value(), 0.0);
+    EXPECT_EQ(c.z.value(), 1.0);
+}
+
+TEST_F(Vec3Test, ArithmeticAndConversion) {
+    Vec3<Meter> a{Meter(1.0), Meter(-2.0), Meter(3.0)};
+    const Vec3<Meter> b{Meter(0.5), Meter(0.5), Meter(0.5)};
+    EXPECT_EQ((a + b).y.value(), -1.5);
+    EXPECT_EQ((a - b).z.value(), 2.5);
+    EXPECT_EQ((2.0 * a).x.value(), 2.0);
+    EXPECT_EQ((-a).y.value(), 2.0);
+    a += b;
+    a *= 2.0;
+    EXPECT_EQ(a, (Vec3<Meter>{Meter(3.0), Meter(-3.0), Meter(7.0)}));
+
+    const Vec3<Kilometer> k = a.to<KilometerTag>();
+    EXPECT_DOUBLE_EQ(k.z.value(), 0.007);
+}
+
+TEST_F(Vec3Test, ArrayKernelsMatchScalar) {
+    const std::size_t n = 2049;
+    Vec3Array<Meter> a, b;
+    a.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const double t = static_cast<double>(i);
+        a.push_back({Meter(t), Meter(1.0 - t), Meter(0.5 * t)});
+        b.push_back({Meter(std::sin(t)), Meter(std::cos(t)), Meter(t * 1e-3)});
+    }
+    EXPECT_EQ(a.size(), n);
+
+    std::vector<Squared<Meter>> d(n);
+    batch::dot(a, b, d.data());
+    Vec3Array<Squared<Meter>> c;
+    batch::cross(a, b, c);
+    std::vector<Meter> len(n);
+    batch::norm(a, len.data());
+    Vec3Array<Meter> moved;
+    batch::axpy(a, b, 2.0, moved);
+
+    for (std::size_t i = 0; i < n; i += 31) {
+        EXPECT_DOUBLE_EQ(d[i].value(), dot(a[i], b[i]).value());
+        EXPECT_DOUBLE_EQ(c[i].x.value(), cross(a[i], b[i]).x.value());
+        EXPECT_DOUBLE_EQ(c[i].z.value(), cross(a[i], b[i]).z.value());
+        EXPECT_DOUBLE_EQ(len[i].value(), norm(a[i]).value());
+        EXPECT_DOUBLE_EQ(moved[i].y.value(), (a[i] + 2.0 * b[i]).y.value());
+    }
+
+    Vec3Array<Meter> short_array(3);
+    EXPECT_THROW(batch::dot(a, short_array, d.data()), std::invalid_argument);
+}
+
+TEST_F(Vec3Test, BulkConversionUsesOneFactor) {
+    Vec3Array<Kilometer> km(100);
+    for (std::size_t i = 0; i < km.size(); ++i) {
+        km.set(i, {Kilometer(i * 1.0), Kilometer(i * 2.0), Kilometer(i * 3.0)});
+    }
+    const Vec3Array<Meter> m = km.to<MeterTag>();
+    Vec3Array<Meter> m2;
+    batch::convert(km, m2);
+    for (std::size_t i = 0; i < km.size(); ++i) {
+        EXPECT_DOUBLE_EQ(m[i].y.value(), i * 2000.0);
+        EXPECT_EQ(m2[i], m[i]);
+    }
+}
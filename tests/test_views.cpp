@@ -0,0 +1,78 @@
+#include "fixtures.hpp"
+#include "qtty/views.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <list>
+#include <type_traits>
+#include <vector>
+
+TEST_F(ViewsTest, ConvertToIsLazyAndTyped) {
+    std::vector<Meter> d = {Meter(500.0), Meter(1500.0), Meter(2500.0)};
+    auto km = d | views::convert_to<KilometerTag>;
+    static_assert(std::is_same<decltype(*km.begin()), Kilometer>::value, "typed elements");
+    ASSERT_EQ(km.size(), 3u);
+
+    std::vector<double> got;
+    for (Kilometer k : km) {
+        got.push_back(k.value());
+    }
+    EXPECT_EQ(got, (std::vector<double>{0.5, 1.5, 2.5}));
+
+    // The view references the source, so later edits show through
+    d[0] = Meter(4000.0);
+    EXPECT_DOUBLE_EQ((*km.begin()).value(), 4.0);
+
+    // Quantity types are accepted as well as tags, and direct calls work
+    auto mi = views::convert_to<Mile>(d);
+    EXPECT_NEAR(mi.begin()[1].value(), 1500.0 / 1609.344, 1e-12);
+}
+
+TEST_F(ViewsTest, ValuesAndAsQuantity) {
+    std::vector<Second> t = {Second(1.0), Second(2.0)};
+    auto raw = t | views::values;
+    static_assert(std::is_same<decltype(*raw.begin()), double>::value, "raw doubles");
+    EXPECT_EQ(std::vector<double>(raw.begin(), raw.end()), (std::vector<double>{1.0, 2.0}));
+
+    const std::vector<double> buf = {3.0, 4.0, 5.0};
+    auto q = buf | views::as_quantity<SecondTag>;
+    static_assert(std::is_same<decltype(*q.begin()), Second>::value, "wrapped doubles");
+    EXPECT_EQ((*(q.begin() + 2)).value(), 5.0);
+    EXPECT_EQ(q.end() - q.begin(), 3);
+}
+
+TEST_F(ViewsTest, Composition) {
+    std::vector<double> buf = {1000.0, 2000.0, 3000.0};
+    // double -> Meter -> Kilometer -> double, all lazy
+    auto chain = buf | views::as_quantity<MeterTag> | views::convert_to<KilometerTag> | views::values;
+    EXPECT_EQ(std::vector<double>(chain.begin(), chain.end()), (std::vector<double>{1.0, 2.0, 3.0}));
+
+    // Non-random-access bases keep working
+    std::list<Meter> l = {Meter(10.0), Meter(20.0)};
+    auto lk = l | views::convert_to<KilometerTag>;
+    auto it = lk.begin();
+    ++it;
+    EXPECT_DOUBLE_EQ((*it).value(), 0.02);
+    EXPECT_EQ(std::distance(lk.begin(), lk.end()), 2);
+
+    // Rvalue ranges are moved into the view
+    auto owned = std::vector<Meter>{Meter(1.0)} | views::convert_to<KilometerTag>;
+    EXPECT_DOUBLE_EQ((*owned.begin()).value(), 0.001);
+}
+
+#if QTTY_HAS_STD_RANGES
+TEST_F(ViewsTest, ComposesWithStdViews) {
+    std::vector<Meter> d = {Meter(500.0), Meter(1500.0), Meter(2500.0)};
+    auto far_km = d | std::views::filter([](Meter m) { return m > Meter(1000.0); }) |
+                  views::convert_to<KilometerTag>;
+    std::vector<double> got;
+    for (Kilometer k : far_km) {
+        got.push_back(k.value());
+    }
+    EXPECT_EQ(got, (std::vector<double>{1.5, 2.5}));
+
+    auto firsts = d | views::values | std::views::take(2);
+    EXPECT_EQ(std::ranges::distance(firsts), 2);
+    static_assert(std::ranges::random_access_range<decltype(d | views::values)>);
+}
+#endif
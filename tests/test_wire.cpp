@@ -0,0 +1,178 @@
+#include "fixtures.hpp"
+#include "qtty/wire.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if QTTY_HAS_WIRE_IO
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+TEST_F(WireTest, HeaderLayout) {
+    const std::vector<Meter> m = {Meter(1.5), Meter(-2.0)};
+    const std::vector<std::uint8_t> frame = wire::encode(m.data(), m.size());
+    ASSERT_EQ(frame.size(), wire::encoded_size(2));
+    ASSERT_EQ(frame.size(), 32u);
+    EXPECT_EQ(std::string(frame.begin(), frame.begin() + 4), "QTTY");
+    EXPECT_EQ(frame[4], wire::kVersion);
+    EXPECT_EQ(frame[5], 0);  // float64
+    EXPECT_EQ(frame[12], 2);  // count, little-endian
+    EXPECT_EQ(frame[13], 0);
+    EXPECT_EQ(frame[23], 0x3F);  // 1.5 = 0x3FF8000000000000, high byte last
+
+    const wire::FrameHeader h = wire::decode_header(frame.data(), frame.size());
+    EXPECT_EQ(h.unit, UnitTraits<MeterTag>::unit_id());
+    EXPECT_EQ(h.repr, wire::Repr::Float64);
+    EXPECT_EQ(h.count, 2u);
+    EXPECT_EQ(h.frame_size(), frame.size());
+}
+
+TEST_F(WireTest, DecodeConvertsToReceiverUnit) {
+    const std::vector<Meter> m = {Meter(1500.0), Meter(250.0)};
+    const auto frame = wire::encode(m.data(), m.size());
+
+    std::vector<Kilometer> km(2);
+    ASSERT_EQ(wire::decode<Kilometer>(frame.data(), frame.size(), km.data()), 2u);
+    EXPECT_DOUBLE_EQ(km[0].value(), 1.5);
+    EXPECT_DOUBLE_EQ(km[1].value(), 0.25);
+
+    std::vector<Second> s(2);
+    EXPECT_THROW(wire::decode<Second>(frame.data(), frame.size(), s.data()), IncompatibleDimensionsError);
+    EXPECT_THROW(wire::decode<Kilometer>(frame.data(), frame.size() - 1, km.data()),
+                 std::invalid_argument);
+
+    auto bad = frame;
+    bad[0] = 'X';
+    EXPECT_THROW(wire::decode_header(bad.data(), bad.size()), std::invalid_argument);
+    bad = frame;
+    bad[5] = 7;
+    EXPECT_THROW(wire::decode_header(bad.data(), bad.size()), std::invalid_argument);
+}
+
+TEST_F(WireTest, Float32AndInPlace) {
+    const std::vector<Second> s = {Second(0.5), Second(120.0)};
+    const auto f32 = wire::encode(s.data(), s.size(), wire::Repr::Float32);
+    EXPECT_EQ(f32.size(), 16u + 8u);
+    std::vector<Minute> mins(2);
+    wire::decode<Minute>(f32.data(), f32.size(), mins.data());
+    EXPECT_DOUBLE_EQ(mins[1].value(), 2.0);
+    std::vector<std::uint8_t> f32_copy = f32;
+    EXPECT_THROW(wire::decode_in_place<Minute>(f32_copy.data(), f32_copy.size()), std::invalid_argument);
+
+    auto frame = wire::encode(s.data(), s.size());
+    span<Millisecond> ms = wire::decode_in_place<Millisecond>(frame.data(), frame.size());
+    ASSERT_EQ(ms.size(), 2u);
+    EXPECT_EQ(static_cast<void*>(ms.data()), static_cast<void*>(frame.data() + wire::kHeaderSize));
+    EXPECT_DOUBLE_EQ(ms[0].value(), 500.0);
+    EXPECT_DOUBLE_EQ(ms[1].value(), 120000.0);
+}
+
+#if QTTY_HAS_WIRE_IO
+
+TEST_F(WireTest, NonblockingSocketPair) {
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    for (int fd : fds) {
+        ASSERT_EQ(::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK), 0);
+    }
+
+    // Enough frames to overflow the socket buffer and force partial writes
+    constexpr std::size_t kFrames = 200;
+    constexpr std::size_t kPerFrame = 1000;
+    wire::FrameWriter tx(fds[0]);
+    std::vector<Meter> batch(kPerFrame);
+    for (std::size_t f = 0; f < kFrames; ++f) {
+        for (std::size_t i = 0; i < kPerFrame; ++i) {
+            batch[i] = Meter(static_cast<double>(f * kPerFrame + i));
+        }
+        tx.enqueue(batch.data(), batch.size());
+    }
+    EXPECT_EQ(tx.pending_bytes(), kFrames * wire::encoded_size(kPerFrame));
+
+    wire::FrameReader rx(fds[1]);
+    std::vector<Kilometer> got;
+    std::size_t frames = 0;
+    double expected = 0.0;
+    bool in_order = true;
+    bool sent = false;
+    while (frames < kFrames) {
+        if (!sent) {
+            sent = tx.flush();
+            if (sent) {
+                ::close(fds[0]);  // reader sees EOF after the last frame
+            }
+        }
+        rx.fill();
+        while (rx.next<Kilometer>(got)) {
+            in_order &= got.size() == kPerFrame;
+            for (const Kilometer& k : got) {
+                in_order &= std::abs(k.value() - expected / 1000.0) <= 1e-12 * expected;
+                expected += 1.0;
+            }
+            ++frames;
+        }
+    }
+    EXPECT_TRUE(in_order);
+    EXPECT_EQ(tx.pending_bytes(), 0u);
+    rx.fill();
+    EXPECT_TRUE(rx.eof());
+    EXPECT_EQ(rx.buffered_bytes(), 0u);
+    ::close(fds[1]);
+}
+
+TEST_F(WireTest, ReaderRejectsOversizedFrames) {
+    int fds[2];
+    ASSERT_EQ(::pipe(fds), 0);
+    ASSERT_EQ(::fcntl(fds[0], F_SETFL, ::fcntl(fds[0], F_GETFL) | O_NONBLOCK), 0);
+    std::vector<Meter> m(100, Meter(1.0));
+    const auto frame = wire::encode(m.data(), m.size());
+    ASSERT_EQ(::write(fds[1], frame.data(), frame.size()), static_cast<ssize_t>(frame.size()));
+
+    wire::FrameReader rx(fds[0], 256);
+    EXPECT_EQ(rx.fill(), frame.size());
+    std::vector<Meter> out;
+    EXPECT_THROW(rx.next<Meter>(out), std::invalid_argument);
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+TEST_F(WireTest, FillStopsAtFrameLimit) {
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    for (int fd : fds) {
+        ASSERT_EQ(::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK), 0);
+    }
+    // 1 KiB frames, far more than one fill() may buffer
+    wire::FrameWriter tx(fds[0]);
+    std::vector<Meter> batch(126, Meter(1.0));
+    constexpr std::size_t kFrames = 1000;
+    for (std::size_t f = 0; f < kFrames; ++f) {
+        tx.enqueue(batch.data(), batch.size());
+    }
+    ASSERT_EQ(wire::encoded_size(batch.size()), 1024u);
+
+    constexpr std::size_t kMaxFrame = 4096;
+    wire::FrameReader rx(fds[1], kMaxFrame);
+    std::vector<Meter> got;
+    std::size_t frames = 0;
+    std::size_t peak = 0;
+    while (frames < kFrames) {
+        tx.flush();
+        rx.fill();
+        peak = std::max(peak, rx.buffered_bytes());
+        while (rx.next<Meter>(got)) {
+            ++frames;
+        }
+    }
+    EXPECT_LE(peak, kMaxFrame + detail::kWireReadSpill);
+    EXPECT_GE(peak, kMaxFrame);
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+#endif // QTTY_HAS_WIRE_IO